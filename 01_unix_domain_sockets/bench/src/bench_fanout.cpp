@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server fan-out benchmark.
+ *
+ * Usage: rtm_bench_fanout [-c clients] [-n routes] [-f flaps] [-b epoll|io_uring]
+ *			   [-t socket|ring|pipeline] [-j threads]
+ *
+ * Forks the clients, loads the routes into the server and flaps them
+ * (delete + create) under churn. The clients receive the notifications on
+ * their sockets, follow the shared memory ring of the server (-t ring) or
+ * receive on their sockets through the client pipeline (-t pipeline).
+ * With -j the server splits the clients across a pool of I/O threads.
+ * Each transport backend is measured from the start of the churn until all
+ * clients received the last notification:
+ *	- wall time
+ *	- server CPU time (user + system)
+ *	- server heap allocations (operator new) per operation
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <server.hpp>
+#include <client.hpp>
+
+
+using namespace RTM;
+
+static constexpr const char *BENCH_SOCKET_PATH = "/tmp/rtm_bench_fanout.sock";
+static constexpr size_t OPS_PER_FLUSH = 64;
+
+// Heap allocations of this process, counted by the operator new below
+static std::atomic<size_t> num_allocations = 0;
+
+void* operator new(size_t size)
+{
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	std::free(p);
+}
+
+// Used by the std::pmr resources
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	const auto align = static_cast<size_t>(alignment);
+
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) &
+						~(align - 1))) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+static routing_table_entry make_entry(uint32_t i)
+{
+	routing_table_entry entry;
+
+	// 10.0.0.0/24, 10.0.1.0/24, ...
+	entry.destination_ip[0] = 10 + static_cast<uint8_t>(i >> 16);
+	entry.destination_ip[1] = static_cast<uint8_t>(i >> 8);
+	entry.destination_ip[2] = static_cast<uint8_t>(i);
+	entry.destination_ip[3] = 0;
+	entry.gateway_ip[0] = 192;
+	entry.gateway_ip[1] = 168;
+	entry.gateway_ip[2] = 0;
+	entry.gateway_ip[3] = 1 + static_cast<uint8_t>(i % 254);
+	entry.destination_mask = 24;
+	entry.oif = "eth" + std::to_string(i % 4);
+
+	return entry;
+}
+
+static routing_table_entry make_sentinel()
+{
+	routing_table_entry entry = make_entry(0);
+
+	entry.destination_ip_u32 = ~uint32_t(0);
+	entry.destination_mask = 32;
+
+	return entry;
+}
+
+/**
+ * @brief Client process: receive until the sentinel route arrives
+ */
+static int run_client(bool ring, bool pipeline)
+{
+	const auto sentinel = make_sentinel();
+	Client client(BENCH_SOCKET_PATH);
+
+	client.use_ring(ring);
+	client.use_pipeline(pipeline);
+	for (int retry = 0; !client.connected(); ++retry) {
+		try {
+			client.connect();
+		} catch (const std::exception&) {
+			if (retry > 1000) {
+				return 1;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	while (client.receive(10'000)) {
+		if (client.get_table().find(sentinel.destination_ip_u32)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static double cpu_seconds()
+{
+	struct rusage usage = {};
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+	       (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static bool run(io_backend_type type, bool ring, bool pipeline, unsigned num_threads,
+		size_t num_clients, size_t num_routes, size_t num_flaps)
+{
+	std::vector<pid_t> children;
+
+	unlink(BENCH_SOCKET_PATH);
+	// Fork before the server starts, so clients do not inherit its sockets
+	for (size_t i = 0; i < num_clients; ++i) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			_exit(run_client(ring, pipeline));
+		}
+		children.push_back(pid);
+	}
+
+	Server server(BENCH_SOCKET_PATH, type, num_threads);
+	server.start();
+	const auto backend_name = server.get_backend_type() == io_backend_type::io_uring ?
+				  "io_uring" : "epoll";
+
+	while (server.num_clients() < num_clients) {
+		server.poll(100);
+	}
+	// Let the clients subscribe
+	for (int i = 0; i < 10; ++i) {
+		server.poll(10);
+	}
+
+	const auto cpu_start = cpu_seconds();
+	const auto allocations_start = num_allocations.load();
+	const auto start = std::chrono::steady_clock::now();
+	size_t num_ops = 0;
+
+	auto flush_window = [&]() {
+		if (++num_ops % OPS_PER_FLUSH == 0) {
+			server.poll(0);
+		}
+	};
+	for (uint32_t i = 0; i < num_routes; ++i) {
+		server.create_entry(make_entry(i));
+		flush_window();
+	}
+	for (uint32_t i = 0; i < num_flaps; ++i) {
+		const auto entry = make_entry(i % num_routes);
+		server.delete_entry(entry);
+		flush_window();
+		server.create_entry(entry);
+		flush_window();
+	}
+	server.create_entry(make_sentinel());
+
+	size_t num_done = 0;
+	size_t num_failed = 0;
+	while (num_done < children.size()) {
+		server.poll(1);
+		int status = 0;
+		while (waitpid(-1, &status, WNOHANG) > 0) {
+			num_done++;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				num_failed++;
+			}
+		}
+	}
+
+	const std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	const auto cpu = cpu_seconds() - cpu_start;
+	const auto allocations = num_allocations.load() - allocations_start;
+	const auto msgs = static_cast<double>(num_ops + 1) * num_clients;
+
+	std::printf("%-8s %-8s threads %2u  clients %5zu  ops %8zu  time %8.3f s"
+		    "  server cpu %8.3f s  %10.0f msgs/s  %7.1f allocs/op  failed %zu\n",
+		    backend_name, ring ? "ring" : pipeline ? "pipeline" : "socket",
+		    num_threads, num_clients, num_ops + 1,
+		    elapsed.count(), cpu,
+		    msgs / elapsed.count(),
+		    static_cast<double>(allocations) / (num_ops + 1), num_failed);
+
+	return num_failed == 0;
+}
+
+int main(int argc, char *argv[]) {
+	size_t num_clients = 200;
+	size_t num_routes = 2000;
+	size_t num_flaps = 2000;
+	bool ring = false;
+	bool pipeline = false;
+	unsigned num_threads = 0;
+	std::vector<io_backend_type> backends = {io_backend_type::epoll,
+						 io_backend_type::io_uring};
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:n:f:b:t:j:")) != -1) {
+		switch (opt) {
+		case 'c':
+			num_clients = std::stoul(optarg);
+			break;
+		case 'n':
+			num_routes = std::max<size_t>(1, std::stoul(optarg));
+			break;
+		case 'f':
+			num_flaps = std::stoul(optarg);
+			break;
+		case 'b':
+			backends = {std::string(optarg) == "io_uring" ?
+				    io_backend_type::io_uring : io_backend_type::epoll};
+			break;
+		case 't':
+			ring = std::string(optarg) == "ring";
+			pipeline = std::string(optarg) == "pipeline";
+			break;
+		case 'j':
+			num_threads = std::stoul(optarg);
+			break;
+		default:
+			std::cerr << "Usage: " << argv[0]
+				  << " [-c clients] [-n routes] [-f flaps]"
+				     " [-b epoll|io_uring] [-t socket|ring|pipeline] [-j threads]"
+				  << std::endl;
+			return 1;
+		}
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	bool ok = true;
+	for (const auto type : backends) {
+		ok = run(type, ring, pipeline, num_threads, num_clients, num_routes, num_flaps) &&
+		     ok;
+	}
+
+	return ok ? 0 : 1;
+}
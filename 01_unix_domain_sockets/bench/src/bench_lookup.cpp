@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server lookup benchmark.
+ *
+ * Usage: rtm_bench_lookup [-c clients] [-n routes] [-q lookups] [-w window]
+ *			   [-s batch_size]...
+ *
+ * Loads the routes into the server and forks the clients, each resolves
+ * random addresses of the routes by the server (see resolver.hpp) and checks
+ * the gateways. Each batch size (default 1, 16, 256 and 1024 addresses per
+ * RTM_LOOKUP) is measured from the first to the last reply of all clients:
+ *	- lookups per second of all clients
+ *	- server CPU time (user + system) per lookup
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <server.hpp>
+#include <resolver.hpp>
+
+
+using namespace RTM;
+
+static constexpr const char *BENCH_SOCKET_PATH = "/tmp/rtm_bench_lookup.sock";
+
+static routing_table_entry make_entry(uint32_t i)
+{
+	routing_table_entry entry;
+
+	// 10.0.0.0/24, 10.0.1.0/24, ...
+	entry.destination_ip[0] = 10 + static_cast<uint8_t>(i >> 16);
+	entry.destination_ip[1] = static_cast<uint8_t>(i >> 8);
+	entry.destination_ip[2] = static_cast<uint8_t>(i);
+	entry.destination_ip[3] = 0;
+	entry.gateway_ip[0] = 192;
+	entry.gateway_ip[1] = 168;
+	entry.gateway_ip[2] = 0;
+	entry.gateway_ip[3] = 1 + static_cast<uint8_t>(i % 254);
+	entry.destination_mask = 24;
+	entry.oif = "eth" + std::to_string(i % 4);
+
+	return entry;
+}
+
+/**
+ * @brief Client process: resolve the addresses, report the elapsed time
+ */
+static int run_client(unsigned seed, size_t num_routes, size_t num_lookups,
+		      size_t batch_size, size_t window, double &seconds)
+{
+	std::mt19937 rng(seed);
+	std::vector<uint32_t> routes(num_lookups);
+	std::vector<uint32_t> addrs(num_lookups);
+	std::vector<Resolver::result> results(num_lookups);
+
+	for (size_t i = 0; i < num_lookups; ++i) {
+		routes[i] = rng() % num_routes;
+		addrs[i] = routing_table_entry::ip2host(make_entry(routes[i]).destination_ip) |
+			   (rng() & 0xff);
+	}
+
+	Resolver resolver(BENCH_SOCKET_PATH, batch_size, window);
+	for (int retry = 0; !resolver.connected(); ++retry) {
+		try {
+			resolver.connect();
+		} catch (const std::exception&) {
+			if (retry > 1000) {
+				return 1;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		resolver.resolve(addrs, results);
+	} catch (const std::exception&) {
+		return 1;
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+						start).count();
+
+	for (size_t i = 0; i < num_lookups; ++i) {
+		const auto *nh = results[i].next_hop;
+		if (nh == nullptr ||
+		    nh->gateway_ip_u32 != make_entry(routes[i]).gateway_ip_u32) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static double cpu_seconds()
+{
+	struct rusage usage = {};
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+	       (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static bool run(Server &server, size_t num_clients, size_t num_routes,
+		size_t num_lookups, size_t batch_size, size_t window, bool report = true)
+{
+	auto *seconds = static_cast<double*>(mmap(nullptr, num_clients * sizeof(double),
+						  PROT_READ | PROT_WRITE,
+						  MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+	if (seconds == MAP_FAILED) {
+		return false;
+	}
+
+	std::vector<pid_t> children;
+	for (size_t i = 0; i < num_clients; ++i) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			_exit(run_client(static_cast<unsigned>(i + 1), num_routes, num_lookups,
+					 batch_size, window, seconds[i]));
+		}
+		children.push_back(pid);
+	}
+
+	const auto cpu_start = cpu_seconds();
+	size_t num_done = 0;
+	size_t num_failed = 0;
+	while (num_done < children.size()) {
+		server.poll(1);
+		int status = 0;
+		while (waitpid(-1, &status, WNOHANG) > 0) {
+			num_done++;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				num_failed++;
+			}
+		}
+	}
+	const auto cpu = cpu_seconds() - cpu_start;
+
+	// The clients run concurrently, the slowest one bounds the rate
+	const double elapsed = *std::max_element(seconds, seconds + num_clients);
+	const double lookups = static_cast<double>(num_lookups) * num_clients;
+	munmap(seconds, num_clients * sizeof(double));
+	if (!report) {
+		return num_failed == 0;
+	}
+
+	std::printf("batch %5zu  window %3zu  clients %3zu  lookups %9.0f  time %7.3f s"
+		    "  %11.0f lookups/s  server cpu %7.1f ns/lookup  failed %zu\n",
+		    batch_size, window, num_clients, lookups, elapsed,
+		    lookups / elapsed, cpu * 1e9 / lookups, num_failed);
+
+	return num_failed == 0;
+}
+
+int main(int argc, char *argv[]) {
+	size_t num_clients = 4;
+	size_t num_routes = 100000;
+	size_t num_lookups = 200000;
+	size_t window = Resolver::DEFAULT_WINDOW;
+	std::vector<size_t> batch_sizes;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:n:q:w:s:")) != -1) {
+		switch (opt) {
+		case 'c':
+			num_clients = std::max<size_t>(1, std::stoul(optarg));
+			break;
+		case 'n':
+			num_routes = std::clamp<size_t>(std::stoul(optarg), 1, 1 << 24);
+			break;
+		case 'q':
+			num_lookups = std::stoul(optarg);
+			break;
+		case 'w':
+			window = std::stoul(optarg);
+			break;
+		case 's':
+			batch_sizes.push_back(std::stoul(optarg));
+			break;
+		default:
+			std::cerr << "Usage: " << argv[0]
+				  << " [-c clients] [-n routes] [-q lookups] [-w window]"
+				     " [-s batch_size]..."
+				  << std::endl;
+			return 1;
+		}
+	}
+	if (batch_sizes.empty()) {
+		batch_sizes = {1, 16, 256, RTM_MAX_LOOKUP_BATCH};
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	unlink(BENCH_SOCKET_PATH);
+	Server server(BENCH_SOCKET_PATH);
+	for (uint32_t i = 0; i < num_routes; ++i) {
+		server.create_entry(make_entry(i));
+	}
+	server.start();
+
+	// The first lookup builds the aggregated FIB of the server
+	bool ok = run(server, 1, num_routes, 1, 1, 1, false);
+	for (const auto batch_size : batch_sizes) {
+		ok = run(server, num_clients, num_routes, num_lookups, batch_size, window) &&
+		     ok;
+	}
+
+	return ok ? 0 : 1;
+}
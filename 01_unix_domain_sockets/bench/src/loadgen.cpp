@@ -0,0 +1,605 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) churn and soak load generator.
+ *
+ * Usage: rtm_loadgen [-c clients] [-n routes] [-r rate] [-d seconds]
+ *		      [-w withdraw%] [-p unstable%] [-s seed]
+ *		      [-b epoll|io_uring] [-t socket|ring] [-j threads] [-a]
+ *
+ * Runs the RTM server in this process and forks the clients, then drives a
+ * BGP-like churn profile:
+ *	- bulk load of all routes
+ *	- churn at a fixed rate of operations per second for a duration: each
+ *	operation picks one of the unstable routes (a share of all routes) and
+ *	withdraws it, re-announces a withdrawn route or changes its gateway
+ *	(a gateway-only update)
+ *
+ * Reported are the convergence time of both phases (until all clients
+ * applied the last operation), the delivery latency percentiles of all
+ * announcements from the server API call to the client applying it and the
+ * server CPU time. Finally each client table is compared to the server
+ * table, the exit status is non-zero if any client diverged.
+ *
+ * With -a all clients run as coroutines on a single reactor in one process
+ * (see async_client.hpp) instead of one process per client.
+ *
+ * The gateway of each announced route is its operation sequence number, the
+ * clients look up the send time of the operation in memory shared with the
+ * server process. The same random seed reproduces the same operations.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <server.hpp>
+#include <client.hpp>
+#include <async_client.hpp>
+
+
+using namespace RTM;
+
+static constexpr const char *LOADGEN_SOCKET_PATH = "/tmp/rtm_loadgen.sock";
+static constexpr uint32_t MARKER_KEY = ~uint32_t(0);  // 255.255.255.255/32
+static constexpr size_t NUM_PHASES = 2;                // bulk load, churn
+static constexpr size_t BULK_OPS_PER_FLUSH = 256;
+static constexpr int CLIENT_TIMEOUT_MS = 30'000;
+
+/**
+ * @brief Log-linear latency histogram (16 buckets per power of two, ~6%
+ * relative error), mergeable across processes
+ */
+struct latency_histogram {
+	static constexpr unsigned SUB_BITS = 4;
+	static constexpr unsigned NUM_BUCKETS = 64 << SUB_BITS;
+
+	uint64_t counts[NUM_BUCKETS];
+
+	static unsigned index(uint64_t value)
+	{
+		if (value < (1u << SUB_BITS)) {
+			return static_cast<unsigned>(value);
+		}
+		const unsigned shift = std::bit_width(value) - 1 - SUB_BITS;
+		return ((shift + 1) << SUB_BITS) +
+		       static_cast<unsigned>((value >> shift) & ((1u << SUB_BITS) - 1));
+	}
+
+	static uint64_t value(unsigned index)
+	{
+		if (index < (1u << SUB_BITS)) {
+			return index;
+		}
+		const unsigned shift = (index >> SUB_BITS) - 1;
+		return (uint64_t((1u << SUB_BITS) + (index & ((1u << SUB_BITS) - 1))))
+		       << shift;
+	}
+
+	void add(uint64_t value)
+	{
+		this->counts[index(value)]++;
+	}
+
+	void merge(const latency_histogram &other)
+	{
+		for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+			this->counts[i] += other.counts[i];
+		}
+	}
+
+	uint64_t total() const
+	{
+		uint64_t sum = 0;
+		for (const auto count : this->counts) {
+			sum += count;
+		}
+		return sum;
+	}
+
+	uint64_t percentile(double p) const
+	{
+		const auto rank = static_cast<uint64_t>(p * this->total());
+		uint64_t sum = 0;
+		for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+			sum += this->counts[i];
+			if (sum > rank) {
+				return value(i);
+			}
+		}
+		return 0;
+	}
+};
+
+/**
+ * @brief Results of a client process
+ */
+struct client_report {
+	latency_histogram latency;
+	uint64_t marker_ns[NUM_PHASES];  // when the phase marker was applied
+	uint64_t digest;                 // of the final table
+	uint64_t num_entries;
+	uint64_t num_overruns;
+	uint64_t num_wakeups;            // of an asynchronous client
+	uint64_t num_updates;
+	std::atomic<uint32_t> synchronized;
+};
+
+/**
+ * @brief Memory shared by the server process and the clients
+ */
+struct shared_state {
+	std::atomic<uint32_t> marker_seq[NUM_PHASES];
+	client_report *clients;
+	std::atomic<uint64_t> *sent_ns;  // send time by operation sequence number
+	size_t max_ops;
+};
+
+static uint64_t now_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return uint64_t(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+static double cpu_seconds()
+{
+	struct rusage usage = {};
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+	       (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static routing_table_entry make_route(uint32_t i, uint32_t seq)
+{
+	routing_table_entry entry;
+
+	// 10.0.0.0/24, 10.0.1.0/24, ...
+	entry.destination_ip[0] = 10 + static_cast<uint8_t>(i >> 16);
+	entry.destination_ip[1] = static_cast<uint8_t>(i >> 8);
+	entry.destination_ip[2] = static_cast<uint8_t>(i);
+	entry.destination_ip[3] = 0;
+	entry.gateway_ip_u32 = seq;
+	entry.destination_mask = 24;
+	entry.oif = "eth" + std::to_string(i % 4);
+
+	return entry;
+}
+
+static routing_table_entry make_marker(uint32_t seq)
+{
+	routing_table_entry entry = make_route(0, seq);
+
+	entry.destination_ip_u32 = MARKER_KEY;
+	entry.destination_mask = 32;
+
+	return entry;
+}
+
+/**
+ * @brief Compute the FNV-1a digest of a table in key order
+ */
+static uint64_t table_digest(const routing_table &table)
+{
+	std::vector<uint8_t> buffer;
+	uint64_t hash = 14695981039346656037ull;
+
+	table.for_each([&](const routing_table_entry &entry) {
+		routing_table_entry::serialize(entry, buffer);
+		for (const uint8_t byte : buffer) {
+			hash = (hash ^ byte) * 1099511628211ull;
+		}
+	});
+
+	return hash;
+}
+
+/**
+ * @brief Record the delivery of an announcement to a client
+ *
+ * @return true if it was the marker of the last phase
+ */
+static bool record(shared_state &shared, client_report &report,
+		   const routing_table_entry &entry)
+{
+	const auto now = now_ns();
+
+	if (entry.destination_ip_u32 == MARKER_KEY) {
+		for (size_t phase = 0; phase < NUM_PHASES; ++phase) {
+			if (entry.gateway_ip_u32 == shared.marker_seq[phase].load()) {
+				report.marker_ns[phase] = now;
+				return phase == NUM_PHASES - 1;
+			}
+		}
+		return false;
+	}
+	if (entry.gateway_ip_u32 < shared.max_ops) {
+		const auto sent = shared.sent_ns[entry.gateway_ip_u32].load(
+			std::memory_order_acquire);
+		report.latency.add(now > sent ? now - sent : 0);
+	}
+	return false;
+}
+
+static void finish(client_report &report, const Client &client)
+{
+	report.digest = table_digest(client.get_table());
+	report.num_entries = client.get_table().size();
+	report.num_overruns = client.num_overruns();
+}
+
+/**
+ * @brief Client process: apply the operations until the last phase marker
+ */
+static int run_client(shared_state &shared, size_t index, bool ring)
+{
+	auto &report = shared.clients[index];
+	Client client(LOADGEN_SOCKET_PATH);
+	bool done = false;
+
+	client.use_ring(ring);
+	client.set_change_handler([&](cud_opcode_t opcode, const routing_table_entry &entry) {
+		// Withdrawals carry no sequence number, a table state after a
+		// resynchronization no delivery latency
+		if (opcode != RTM_DELETE && client.synchronized() &&
+		    record(shared, report, entry)) {
+			done = true;
+		}
+	});
+
+	for (int retry = 0; !client.connected(); ++retry) {
+		try {
+			client.connect();
+		} catch (const std::exception&) {
+			if (retry > 1000) {
+				return 1;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	while (!done && client.receive(CLIENT_TIMEOUT_MS)) {
+		if (client.synchronized() && report.synchronized.load() == 0) {
+			report.synchronized.store(1);
+		}
+	}
+	if (!done) {
+		return 1;
+	}
+	finish(report, client);
+
+	return 0;
+}
+
+/**
+ * @brief Coroutine of an asynchronous client, see run_client()
+ */
+static task<void> follow(shared_state &shared, size_t index, AsyncClient &client)
+{
+	auto &report = shared.clients[index];
+
+	for (int retry = 0; !client.get_client().connected(); ++retry) {
+		try {
+			co_await client.connect();
+		} catch (const std::exception&) {
+			if (retry > 1000) {
+				throw;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	co_await client.synchronized();
+	report.synchronized.store(1);
+
+	while (true) {
+		const auto update = co_await client.next_update();
+		report.num_updates++;
+		if (update.opcode != RTM_DELETE && update.opcode != RTM_SYNC_DONE &&
+		    record(shared, report, update.entry)) {
+			break;
+		}
+	}
+	finish(report, client.get_client());
+	report.num_wakeups = client.num_wakeups();
+}
+
+/**
+ * @brief Client process running all clients on a single reactor
+ */
+static int run_async_clients(shared_state &shared, size_t num_clients, bool ring)
+{
+	reactor r;
+	std::vector<std::unique_ptr<AsyncClient>> clients;
+
+	try {
+		for (size_t i = 0; i < num_clients; ++i) {
+			clients.push_back(std::make_unique<AsyncClient>(r, LOADGEN_SOCKET_PATH));
+			clients.back()->get_client().use_ring(ring);
+			r.spawn(follow(shared, i, *clients.back()));
+		}
+		while (r.num_tasks() > 0) {
+			if (r.poll(CLIENT_TIMEOUT_MS) == 0) {
+				return 1;
+			}
+		}
+	} catch (const std::exception&) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static void print_usage(const char *name)
+{
+	std::cerr << "Usage: " << name
+		  << " [-c clients] [-n routes] [-r rate] [-d seconds]"
+		     " [-w withdraw%] [-p unstable%] [-s seed]"
+		     " [-b epoll|io_uring] [-t socket|ring] [-j threads] [-a]"
+		  << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	size_t num_clients = 50;
+	size_t num_routes = 10'000;
+	size_t rate = 5'000;
+	double duration = 5;
+	unsigned withdraw_pct = 30;
+	unsigned unstable_pct = 10;
+	unsigned seed = 1;
+	io_backend_type type = io_backend_type::epoll;
+	bool ring = false;
+	unsigned num_threads = 0;
+	bool async = false;
+	int opt;
+
+	try {
+		while ((opt = getopt(argc, argv, "c:n:r:d:w:p:s:b:t:j:a")) != -1) {
+			switch (opt) {
+			case 'c':
+				num_clients = std::max<size_t>(1, std::stoul(optarg));
+				break;
+			case 'n':
+				num_routes = std::clamp<size_t>(std::stoul(optarg), 1, 1 << 24);
+				break;
+			case 'r':
+				rate = std::max<size_t>(1, std::stoul(optarg));
+				break;
+			case 'd':
+				duration = std::stod(optarg);
+				break;
+			case 'w':
+				withdraw_pct = std::min<unsigned>(100, std::stoul(optarg));
+				break;
+			case 'p':
+				unstable_pct = std::clamp<unsigned>(std::stoul(optarg), 1, 100);
+				break;
+			case 's':
+				seed = std::stoul(optarg);
+				break;
+			case 'b':
+				type = std::string(optarg) == "io_uring" ?
+				       io_backend_type::io_uring : io_backend_type::epoll;
+				break;
+			case 't':
+				ring = std::string(optarg) == "ring";
+				break;
+			case 'j':
+				num_threads = std::stoul(optarg);
+				break;
+			case 'a':
+				async = true;
+				break;
+			default:
+				print_usage(argv[0]);
+				return 1;
+			}
+		}
+	} catch (const std::exception&) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	// Shared with the clients: phase markers, client reports, send times
+	const size_t num_churn_ops = static_cast<size_t>(rate * duration);
+	const size_t max_ops = num_routes + num_churn_ops + NUM_PHASES + 1;
+	const size_t shared_size = sizeof(shared_state) +
+				   num_clients * sizeof(client_report) +
+				   max_ops * sizeof(std::atomic<uint64_t>);
+	void *mem = mmap(nullptr, shared_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		std::perror("mmap");
+		return 1;
+	}
+	auto &shared = *new (mem) shared_state();
+	shared.clients = reinterpret_cast<client_report*>(&shared + 1);
+	shared.sent_ns = reinterpret_cast<std::atomic<uint64_t>*>(shared.clients + num_clients);
+	shared.max_ops = max_ops;
+	for (auto &marker_seq : shared.marker_seq) {
+		marker_seq = ~uint32_t(0);
+	}
+
+	unlink(LOADGEN_SOCKET_PATH);
+	// Fork before the server starts, so clients do not inherit its sockets
+	std::vector<pid_t> children;
+	for (size_t i = 0; i < (async ? 1 : num_clients); ++i) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			_exit(async ? run_async_clients(shared, num_clients, ring) :
+				      run_client(shared, i, ring));
+		}
+		children.push_back(pid);
+	}
+
+	Server server(LOADGEN_SOCKET_PATH, type, num_threads);
+	server.start();
+
+	// Wait for all clients to receive the (empty) table state
+	auto num_synchronized = [&]() {
+		size_t n = 0;
+		for (size_t i = 0; i < num_clients; ++i) {
+			n += shared.clients[i].synchronized.load();
+		}
+		return n;
+	};
+	const auto connect_deadline = std::chrono::steady_clock::now() +
+				      std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+	while (num_synchronized() < num_clients &&
+	       std::chrono::steady_clock::now() < connect_deadline) {
+		server.poll(10);
+	}
+
+	std::mt19937 rng(seed);
+	uint32_t seq = 0;
+	auto announce = [&](uint32_t route) {
+		shared.sent_ns[seq].store(now_ns(), std::memory_order_release);
+		server.create_entry(make_route(route, seq++));
+	};
+	auto change_path = [&](uint32_t route) {
+		shared.sent_ns[seq].store(now_ns(), std::memory_order_release);
+		server.update_entry(make_route(route, seq++), RTM_FIELD_GATEWAY);
+	};
+	auto mark = [&](size_t phase) {
+		shared.marker_seq[phase].store(seq);
+		shared.sent_ns[seq].store(now_ns(), std::memory_order_release);
+		server.create_entry(make_marker(seq++));
+		server.flush();
+	};
+
+	// Bulk load
+	const auto bulk_cpu_start = cpu_seconds();
+	const auto bulk_start = now_ns();
+	for (uint32_t i = 0; i < num_routes; ++i) {
+		announce(i);
+		if ((i + 1) % BULK_OPS_PER_FLUSH == 0) {
+			server.poll(0);
+		}
+	}
+	mark(0);
+	const auto bulk_cpu = cpu_seconds() - bulk_cpu_start;
+
+	// Churn at a fixed rate
+	const size_t num_unstable = std::max<size_t>(1, num_routes * unstable_pct / 100);
+	std::vector<bool> withdrawn(num_unstable, false);
+	std::uniform_int_distribution<uint32_t> pick_route(0, num_unstable - 1);
+	std::uniform_int_distribution<unsigned> pick_pct(0, 99);
+	size_t num_withdrawals = 0;
+	size_t num_announcements = 0;
+	size_t num_path_changes = 0;
+
+	const auto churn_cpu_start = cpu_seconds();
+	const auto churn_start = now_ns();
+	size_t num_ops = 0;
+	while (num_ops < num_churn_ops) {
+		const auto elapsed = now_ns() - churn_start;
+		const auto due = std::min<size_t>(num_churn_ops, elapsed * rate / 1'000'000'000);
+		for (; num_ops < due; ++num_ops) {
+			const uint32_t route = pick_route(rng);
+			if (withdrawn[route]) {
+				withdrawn[route] = false;
+				announce(route);
+				num_announcements++;
+			} else if (pick_pct(rng) < withdraw_pct) {
+				withdrawn[route] = true;
+				server.delete_entry(make_route(route, 0));
+				num_withdrawals++;
+			} else {
+				change_path(route);
+				num_path_changes++;
+			}
+		}
+		server.poll(1);
+	}
+	const auto churn_end = now_ns();
+	mark(1);
+
+	size_t num_failed = 0;
+	size_t num_done = 0;
+	while (num_done < children.size()) {
+		server.poll(1);
+		int status = 0;
+		pid_t pid;
+		while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+			num_done++;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				num_failed++;
+			}
+		}
+	}
+	const auto churn_cpu = cpu_seconds() - churn_cpu_start;
+
+	// Convergence: until the last client applied the phase marker
+	uint64_t bulk_converged = 0;
+	uint64_t churn_converged = 0;
+	latency_histogram latency = {};
+	size_t num_equal = 0;
+	size_t num_overruns = 0;
+	uint64_t num_wakeups = 0;
+	uint64_t num_updates = 0;
+	const auto server_digest = table_digest(server.get_table());
+	for (size_t i = 0; i < num_clients; ++i) {
+		const auto &report = shared.clients[i];
+		bulk_converged = std::max(bulk_converged, report.marker_ns[0] - bulk_start);
+		churn_converged = std::max(churn_converged, report.marker_ns[1] - churn_end);
+		latency.merge(report.latency);
+		num_overruns += report.num_overruns;
+		num_wakeups += report.num_wakeups;
+		num_updates += report.num_updates;
+		if (report.digest == server_digest &&
+		    report.num_entries == server.get_table().size()) {
+			num_equal++;
+		}
+	}
+
+	const double churn_seconds = (churn_end - churn_start) / 1e9;
+	std::printf("rtm_loadgen: %s %s threads %u  clients %zu%s  routes %zu  churn %zu ops/s"
+		    " x %.1f s  seed %u\n",
+		    server.get_backend_type() == io_backend_type::io_uring ? "io_uring" : "epoll",
+		    ring ? "ring" : "socket", num_threads, num_clients,
+		    async ? " (async, 1 process)" : "", num_routes, rate, duration, seed);
+	std::printf("bulk load  %8zu ops  converged in %8.3f s  server cpu %7.3f s\n",
+		    num_routes, bulk_converged / 1e9, bulk_cpu);
+	std::printf("churn      %8zu ops  (%zu withdrawals, %zu announcements, %zu path changes,"
+		    " %.0f ops/s)  converged %.3f ms after the last op  server cpu %7.3f s\n",
+		    num_ops, num_withdrawals, num_announcements, num_path_changes,
+		    num_ops / churn_seconds,
+		    churn_converged / 1e6, churn_cpu);
+	std::printf("latency    p50 %8.3f ms  p99 %8.3f ms  p999 %8.3f ms  (%llu samples,"
+		    " %zu ring overruns)\n",
+		    latency.percentile(0.5) / 1e6, latency.percentile(0.99) / 1e6,
+		    latency.percentile(0.999) / 1e6,
+		    static_cast<unsigned long long>(latency.total()), num_overruns);
+	if (async) {
+		std::printf("async      %llu updates in %llu wakeups (%.3f wakeups/update)\n",
+			    static_cast<unsigned long long>(num_updates),
+			    static_cast<unsigned long long>(num_wakeups),
+			    num_updates ? static_cast<double>(num_wakeups) / num_updates : 0.0);
+	}
+	std::printf("verify     %zu/%zu clients equal to the server table (%zu routes),"
+		    " %zu failed\n",
+		    num_equal, num_clients, server.get_table().size(), num_failed);
+
+	munmap(mem, shared_size);
+
+	return num_equal == num_clients && num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) asynchronous client, a Client driven by
+ * coroutines on a single-threaded reactor (see reactor.hpp).
+ *
+ *	task<void> follow(AsyncClient &client)
+ *	{
+ *		co_await client.connect();
+ *		co_await client.synchronized();	// the table state was received
+ *		while (true) {
+ *			const auto update = co_await client.next_update();
+ *			...
+ *		}
+ *	}
+ *
+ * - Any number of clients may run on one reactor, each awaiting coroutine is
+ * resumed only when its connection (or ring) has new data.
+ * - A wakeup applies all messages available on the connection at once and
+ * queues their changes for next_update(), so a burst of updates costs a
+ * single wakeup.
+ * - The entries of the table state are not queued, read them from the table
+ * after synchronized(). If the table state is received again (a ring client
+ * overrun by the ring), next_update() returns RTM_SYNC_DONE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include <client.hpp>
+#include <reactor.hpp>
+#include <task.hpp>
+
+namespace RTM {
+
+class AsyncClient {
+public:
+	/**
+	 * @brief A change of the local routing table
+	 */
+	struct update {
+		cud_opcode_t opcode;  // RTM_CREATE, RTM_UPDATE, RTM_DELETE or RTM_SYNC_DONE
+		routing_table_entry entry;  // the entry after the change
+	};
+
+	/**
+	 * @brief Construct a new AsyncClient object
+	 *
+	 * @param r - the reactor to wait on, must outlive the client
+	 * @param socket_path - the path of the RTM server socket
+	 * @param cache_slots - the number of route cache slots
+	 */
+	explicit AsyncClient(reactor &r, const std::string &socket_path = RTM_SOCKET_PATH,
+			     size_t cache_slots = route_cache::DEFAULT_SLOTS);
+	~AsyncClient();
+
+	AsyncClient(const AsyncClient&) = delete;
+	AsyncClient& operator=(const AsyncClient&) = delete;
+
+	/**
+	 * @brief Get the underlying client, e.g. to add filters before connect()
+	 * or to look up routes
+	 *
+	 * @return Client& - the client
+	 * @note Do not call receive() of the client, the reactor drives it.
+	 */
+	Client& get_client()
+	{
+		return this->client;
+	}
+
+	/**
+	 * @brief Connect to the RTM server and subscribe
+	 *
+	 * @return task<void> - completes once the subscription was sent
+	 * @note The connection of a Unix domain socket does not wait for the
+	 * server. Throws std::system_error if the connection could not be made.
+	 */
+	task<void> connect();
+
+	/**
+	 * @brief Close the connection to the RTM server
+	 *
+	 */
+	void disconnect();
+
+	/**
+	 * @brief Wait for the table state
+	 *
+	 * @return task<void> - completes once the table state was received, see
+	 * Client::synchronized()
+	 * @note Throws std::system_error if the connection was closed.
+	 */
+	task<void> synchronized();
+
+	/**
+	 * @brief Wait for the next change of the local routing table
+	 *
+	 * @return task<update> - completes with the next change
+	 * @note Throws std::system_error if the connection was closed.
+	 */
+	task<update> next_update();
+
+	/**
+	 * @brief Get the number of wakeups by the reactor
+	 *
+	 * @return size_t - the number of times the client waited for data
+	 */
+	size_t num_wakeups() const
+	{
+		return this->wakeups;
+	}
+
+private:
+	bool receive_all();
+	task<void> wait();
+	void unwatch();
+
+	reactor &r;
+	Client client;
+	reactor::source source;
+	int watched_fd = -1;       // watched descriptors of the client
+	int watched_ring_fd = -1;
+	bool was_synchronized = false;
+	bool loaded = false;       // the table state was received once
+	std::deque<update> updates;
+	size_t wakeups = 0;
+};
+
+}  // namespace RTM
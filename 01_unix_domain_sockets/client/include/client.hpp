@@ -4,15 +4,301 @@
  * @brief Routig Table Manager (RTM) client is a client that conects to the RTM server
  * and receives updates about the routing table.
  *
+ * - On connect the client subscribes with its filters (see rtm_subscription.hpp),
+ * the server answers with the matching table state followed by RTM_SYNC_DONE.
+ * - Afterwards the client receives the matching CUD notifications and applies
+ * them to its local copy of the routing table.
+ * - With use_ring() the client follows the shared memory ring of the server
+ * (see rtm_ring.hpp) instead and filters the notifications itself. A client
+ * overrun by the ring resubscribes and receives the table state again.
+ * - lookup() resolves addresses through a route cache (see route_cache.hpp),
+ * each applied notification invalidates the cached addresses of its prefixes.
+ * A Client is used by one thread, so its cache is a per-thread cache.
+ * - With use_pipeline() a receive and a decode thread take the notifications
+ * off the socket ahead of receive() (see client_pipeline.hpp), receive()
+ * applies them a batch at a time. table_version() counts the applied batches.
+ *
  */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <client_pipeline.hpp>
+#include <routing_table.hpp>
+#include <rtm_message.hpp>
+#include <rtm_subscription.hpp>
+#include <rtm_ring.hpp>
+#include <route_cache.hpp>
+
 namespace RTM {
 
 class Client {
-	public:
-	private:
+public:
+	using change_handler_t = std::function<void(cud_opcode_t opcode,
+						    const routing_table_entry &entry)>;
+
+	/**
+	 * @brief Construct a new Client object
+	 *
+	 * @param socket_path - the path of the RTM server socket
+	 * @param cache_slots - the number of route cache slots
+	 */
+	explicit Client(const std::string &socket_path = RTM_SOCKET_PATH,
+			size_t cache_slots = route_cache::DEFAULT_SLOTS);
+	~Client();
+
+	Client(const Client&) = delete;
+	Client& operator=(const Client&) = delete;
+
+	/**
+	 * @brief Add a subscription filter
+	 *
+	 * @param filter - the filter to add
+	 * @note Filters are sent to the server on connect(). A client without
+	 * filters receives the whole routing table.
+	 */
+	void add_filter(const subscription_filter &filter);
+
+	/**
+	 * @brief Get the subscription filters
+	 *
+	 * @return const std::vector<subscription_filter>& - the filters
+	 */
+	const std::vector<subscription_filter>& get_filters() const
+	{
+		return this->filters;
+	}
+
+	/**
+	 * @brief Follow the shared memory ring of the server
+	 *
+	 * @param enable - true to receive the notifications through the ring
+	 * @note Takes effect on connect(). The client stays on its socket if the
+	 * server has no ring available, see ring_attached().
+	 */
+	void use_ring(bool enable)
+	{
+		this->ring_requested = enable;
+	}
+
+	/**
+	 * @brief Receive and decode the notifications in separate threads
+	 *
+	 * @param enable - true to start the pipeline on connect()
+	 * @note Takes effect on connect(). A client following the ring (see
+	 * use_ring()) stays without pipeline.
+	 */
+	void use_pipeline(bool enable)
+	{
+		this->pipeline_requested = enable;
+	}
+
+	/**
+	 * @brief Check if the client runs the receive pipeline
+	 *
+	 * @return true if the notifications are received by the pipeline
+	 */
+	bool pipelined() const
+	{
+		return this->pipeline != nullptr;
+	}
+
+	/**
+	 * @brief Get the version of the local table
+	 *
+	 * @return uint64_t - the number of messages applied (batches of messages
+	 * with the pipeline)
+	 * @note May be read from any thread, it is published after the changes.
+	 */
+	uint64_t table_version() const
+	{
+		return this->version.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Check if the client follows the shared memory ring
+	 *
+	 * @return true if the notifications are read from the ring
+	 */
+	bool ring_attached() const
+	{
+		return this->ring != nullptr;
+	}
+
+	/**
+	 * @brief Get the number of ring overruns
+	 *
+	 * @return size_t - the number of table resynchronizations
+	 */
+	size_t num_overruns() const
+	{
+		return this->overruns;
+	}
+
+	/**
+	 * @brief Set a function to call for each change of the local table
+	 *
+	 * @param handler - called with RTM_CREATE, RTM_UPDATE or RTM_DELETE and
+	 * the entry after it was applied (the deleted one for RTM_DELETE), also
+	 * for the entries of the table state (see synchronized())
+	 * @note Socket and ring clients report a change the same way: an entry
+	 * moving into the filters as RTM_CREATE, out of them as RTM_DELETE.
+	 * @note The handler is called from receive().
+	 */
+	void set_change_handler(change_handler_t handler)
+	{
+		this->change_handler = std::move(handler);
+	}
+
+	/**
+	 * @brief Connect to the RTM server and subscribe
+	 *
+	 * @note Throws std::system_error if the connection could not be made.
+	 */
+	void connect();
+
+	/**
+	 * @brief Close the connection to the RTM server
+	 *
+	 */
+	void disconnect();
+
+	/**
+	 * @brief Receive and apply a single message from the RTM server
+	 *
+	 * @param timeout_ms - the maximum time to wait, -1 waits forever
+	 * @return true if a message was applied, false on timeout or if the
+	 * connection was closed (see connected())
+	 * @note A ring client applies all messages available in the ring, a
+	 * pipelined client a batch of messages.
+	 */
+	bool receive(int timeout_ms = -1);
+
+	/**
+	 * @brief Receive and apply a single message without waiting
+	 *
+	 * @return true if a message was applied, false if none is available or
+	 * if the connection was closed (see connected())
+	 * @note A ring client applies all messages available in the ring and
+	 * requests a wakeup on ring_fd() before it returns false.
+	 * @note Call until it returns false before waiting for fd() and
+	 * ring_fd() edge-triggered.
+	 */
+	bool try_receive();
+
+	/**
+	 * @brief Check if the client is connected to the RTM server
+	 *
+	 * @return true if connected, false otherwise
+	 */
+	bool connected() const
+	{
+		return this->sock_fd >= 0;
+	}
+
+	/**
+	 * @brief Check if the full table state was received
+	 *
+	 * @return true if the local table is in sync with the server
+	 */
+	bool synchronized() const
+	{
+		return this->in_sync;
+	}
+
+	/**
+	 * @brief Get the file descriptor of the server connection
+	 *
+	 * @return int - the socket, readable when receive() has work to do
+	 * @note A ring client has work to do as well when ring_fd() is readable.
+	 * A pipelined client returns the eventfd of its decoded batches instead.
+	 */
+	int fd() const
+	{
+		return this->pipeline ? this->pipeline->fd() : this->sock_fd;
+	}
+
+	/**
+	 * @brief Get the wakeup file descriptor of a ring client
+	 *
+	 * @return int - the eventfd signaled by the server or -1
+	 */
+	int ring_fd() const
+	{
+		return this->event_fd;
+	}
+
+	/**
+	 * @brief Get the local copy of the routing table
+	 *
+	 * @return const routing_table& - the routing table
+	 */
+	const routing_table& get_table() const
+	{
+		return this->table;
+	}
+
+	/**
+	 * @brief Find the route to an address in the local routing table
+	 *
+	 * @param ip - the address
+	 * @return const routing_table_entry* - the entry with the longest prefix
+	 * covering the address or nullptr if there is no route
+	 * @note The entry is valid until the next receive().
+	 */
+	const routing_table_entry* lookup(const uint8_t (&ip)[4])
+	{
+		return this->cache.lookup(this->table, routing_table_entry::ip2host(ip));
+	}
+
+	/**
+	 * @brief Get the route cache, e.g. for its hit and miss counters
+	 *
+	 * @return const route_cache& - the route cache
+	 */
+	const route_cache& get_route_cache() const
+	{
+		return this->cache;
+	}
+
+private:
+	bool receive_packet(int flags = 0);
+	bool apply(std::span<const uint8_t> packet, std::span<int> fds);
+	bool apply_ring(std::span<const uint8_t> packet);
+	bool attach_ring(std::span<const uint8_t> payload, std::span<int> fds);
+	bool consume_ring();
+	bool apply_batch();
+	void publish_version();
+	bool subscribe();
+	void apply_entry(cud_opcode_t opcode, const routing_table_entry &entry);
+	void apply_delta(const routing_table_entry &delta, uint32_t fields);
+
+	std::string socket_path;
+	int sock_fd = -1;
+	bool in_sync = false;
+	bool ring_requested = false;
+	std::unique_ptr<rtm_ring> ring;
+	int event_fd = -1;
+	uint32_t ring_consumer = 0;
+	uint64_t ring_position = 0;
+	std::vector<uint8_t> ring_buffer;
+	size_t overruns = 0;
+	bool pipeline_requested = false;
+	std::unique_ptr<client_pipeline> pipeline;
+	std::atomic<uint64_t> version = 0;
+	std::vector<subscription_filter> filters;
+	change_handler_t change_handler;
+	std::vector<uint8_t> rx_buffer;
+	std::pmr::unsynchronized_pool_resource table_pool;  // entries of the table
+	routing_table table;
+	route_cache cache;
 };
 
 }  // namespace RTM
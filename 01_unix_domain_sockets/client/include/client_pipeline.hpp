@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) client receive pipeline.
+ *
+ * Splits the work of a Client on its server connection into stages, so that
+ * receiving, decoding and applying the notifications overlap:
+ *
+ *	socket -> receive thread -> decode thread -> Client::receive()
+ *
+ * - The receive thread reads up to RX_BATCH_PACKETS messages per recvmmsg()
+ * into a batch buffer.
+ * - The decode thread parses the messages of a batch into a batch of table
+ * changes.
+ * - The thread calling Client::receive() applies a batch of changes at once,
+ * so the table and the route cache stay owned by that thread.
+ * - Each stage hands its batches to the next one through a lock-free SPSC
+ * queue and gets them back through another one: the batch buffers form a ring
+ * of a fixed size. A stage out of buffers waits for the next stage, so a
+ * client too slow for the server backs up its socket as before.
+ * - A stage waits for work by its eventfd, fd() is the one of the apply stage.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <routing_table.hpp>
+#include <rtm_message.hpp>
+#include <spsc_queue.hpp>
+
+namespace RTM {
+
+class client_pipeline {
+public:
+	static constexpr size_t RX_BATCH_PACKETS = 16;  // messages per recvmmsg()
+	static constexpr size_t NUM_BATCHES = 4;        // batch buffers per stage
+
+	/**
+	 * @brief A change of the local table
+	 */
+	struct change {
+		cud_opcode_t opcode = RTM_CREATE;  // RTM_CREATE, RTM_UPDATE, RTM_DELETE
+						   // or RTM_SYNC_DONE
+		uint32_t fields = 0;               // changed fields of RTM_UPDATE
+		routing_table_entry entry;
+	};
+
+	/**
+	 * @brief The changes decoded from a batch of messages
+	 */
+	struct batch {
+		std::vector<change> changes;
+		bool closed = false;  // the connection ends after the changes
+	};
+
+	/**
+	 * @brief Start the receive and the decode thread
+	 *
+	 * @param sock_fd - the subscribed server connection, read only by the
+	 * pipeline from now on
+	 * @note Throws std::system_error if the pipeline could not be set up.
+	 */
+	explicit client_pipeline(int sock_fd);
+
+	/**
+	 * @brief Stop the threads, the server connection is shut down for
+	 * reading but stays open
+	 */
+	~client_pipeline();
+
+	client_pipeline(const client_pipeline&) = delete;
+	client_pipeline& operator=(const client_pipeline&) = delete;
+
+	/**
+	 * @brief Get the file descriptor of the apply stage
+	 *
+	 * @return int - the eventfd signaled for each decoded batch
+	 */
+	int fd() const
+	{
+		return this->ready_fd;
+	}
+
+	/**
+	 * @brief Take the next decoded batch (apply stage only)
+	 *
+	 * @return batch* - the batch or nullptr if none is decoded yet
+	 * @note Hand the batch back by recycle() once it was applied.
+	 */
+	batch* pop();
+
+	/**
+	 * @brief Hand an applied batch back to the decode stage
+	 *
+	 * @param b - the batch taken by pop()
+	 */
+	void recycle(batch *b);
+
+private:
+	// Received messages, packed at RTM_MAX_MSG_SIZE each
+	struct rx_batch {
+		std::vector<uint8_t> data;
+		std::vector<uint32_t> sizes;
+		bool closed = false;  // the connection ends after the messages
+	};
+
+	void receive_loop();
+	void decode_loop();
+	bool decode(const rx_batch &in, batch &out);
+	void stop();
+
+	int sock_fd;
+	int rx_fd = -1;      // wakes the receive thread: buffers returned, stop
+	int decode_fd = -1;  // wakes the decode thread: messages received,
+			     // batches returned, stop
+	int ready_fd = -1;   // signaled for each decoded batch
+	std::atomic<bool> stopping = false;
+
+	std::vector<std::unique_ptr<rx_batch>> rx_batches;
+	std::vector<std::unique_ptr<batch>> batches;
+	spsc_queue<rx_batch*> rx_free;     // decode -> receive
+	spsc_queue<rx_batch*> rx_full;     // receive -> decode
+	spsc_queue<batch*> decoded_free;   // apply -> decode
+	spsc_queue<batch*> decoded_full;   // decode -> apply
+
+	std::thread rx_thread;
+	std::thread decode_thread;
+};
+
+}  // namespace RTM
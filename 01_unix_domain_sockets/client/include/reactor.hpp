@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) single-threaded coroutine reactor.
+ *
+ * The reactor resumes coroutines (see task.hpp) waiting for file descriptors
+ * to become readable, so one thread serves any number of RTM connections:
+ *
+ *	reactor r;
+ *	reactor::source src;
+ *	r.add(fd, src);
+ *	r.spawn(reader(src));	// co_await src; then read fd until EAGAIN
+ *	r.run();
+ *
+ * The file descriptors are watched edge-triggered: a source is signaled once
+ * per arrival of new data, not while data is pending. Its coroutine reads all
+ * available data before it awaits the source again, so a burst of messages
+ * costs one wakeup. A source may watch several file descriptors.
+ *
+ * The reactor may be embedded into another event loop: wait for fd() to
+ * become readable and call poll(0).
+ *
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <utility>
+#include <vector>
+
+#include <task.hpp>
+
+namespace RTM {
+
+class reactor {
+public:
+	/**
+	 * @brief Readiness of file descriptors, awaited by one coroutine
+	 */
+	class source {
+	public:
+		source() = default;
+		~source() = default;
+
+		source(const source&) = delete;
+		source& operator=(const source&) = delete;
+
+		bool await_ready() noexcept
+		{
+			// Data arrived since the last wait
+			return std::exchange(this->ready, false);
+		}
+
+		void await_suspend(std::coroutine_handle<> h) noexcept
+		{
+			this->waiter = h;
+		}
+
+		void await_resume() noexcept
+		{
+		}
+
+	private:
+		friend class reactor;
+
+		std::coroutine_handle<> waiter;
+		bool ready = false;
+	};
+
+	reactor();
+	~reactor();
+
+	reactor(const reactor&) = delete;
+	reactor& operator=(const reactor&) = delete;
+
+	/**
+	 * @brief Watch a file descriptor for readability
+	 *
+	 * @param fd - the file descriptor
+	 * @param src - the source to signal, must outlive the watch
+	 * @note Throws std::system_error if the descriptor could not be watched.
+	 */
+	void add(int fd, source &src);
+
+	/**
+	 * @brief Stop watching a file descriptor
+	 *
+	 * @param fd - the file descriptor
+	 * @note Closing a descriptor stops watching it as well.
+	 */
+	void remove(int fd);
+
+	/**
+	 * @brief Start a top-level task
+	 *
+	 * @param t - the task, runs until its first suspension right away
+	 * @note The reactor owns the task until it completes, an exception of
+	 * the task is rethrown by spawn() or poll().
+	 */
+	void spawn(task<void> t);
+
+	/**
+	 * @brief Resume the coroutines of the readable file descriptors
+	 *
+	 * @param timeout_ms - the maximum time to wait, -1 waits forever
+	 * @return int - the number of signaled file descriptors
+	 * @note Throws std::system_error if waiting failed.
+	 */
+	int poll(int timeout_ms);
+
+	/**
+	 * @brief Poll until all spawned tasks completed
+	 *
+	 */
+	void run();
+
+	/**
+	 * @brief Poll until a task completed
+	 *
+	 * @param t - the task to run
+	 * @return T - the result of the task
+	 */
+	template <typename T>
+	T run(task<T> t)
+	{
+		t.start();
+		while (!t.done()) {
+			this->poll(-1);
+		}
+		return t.result();
+	}
+
+	/**
+	 * @brief Get the file descriptor to wait on for reactor events
+	 *
+	 * @return int - the file descriptor, readable when poll() has work to do
+	 */
+	int fd() const
+	{
+		return this->epoll_fd;
+	}
+
+	/**
+	 * @brief Get the number of spawned tasks not completed yet
+	 *
+	 * @return size_t - the number of tasks
+	 */
+	size_t num_tasks() const
+	{
+		return this->tasks.size();
+	}
+
+private:
+	void reap();
+
+	int epoll_fd = -1;
+	std::vector<task<void>> tasks;
+	std::vector<std::coroutine_handle<>> resumable;  // scratch buffer of poll()
+};
+
+}  // namespace RTM
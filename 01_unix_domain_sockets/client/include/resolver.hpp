@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) resolver looks up addresses by the RTM server
+ * without holding a copy of the routing table.
+ *
+ * - resolve() splits the addresses into RTM_LOOKUP batches and keeps up to
+ * a window of batches in flight, so the server resolves a batch while the
+ * next ones are on their way (see rtm_message.hpp).
+ * - The server answers with the next hop of the longest prefix covering each
+ * address, resolved by its aggregated FIB (see rtm_fib.hpp).
+ * - The next hops are kept once by the resolver, the results point to them.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <rtm_message.hpp>
+#include <rtm_fib.hpp>
+
+namespace RTM {
+
+class Resolver {
+public:
+	static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+	static constexpr size_t DEFAULT_WINDOW = 8;
+
+	/**
+	 * @brief Route of a resolved address
+	 */
+	struct result {
+		const rtm_fib::next_hop *next_hop;  // nullptr if there is no route
+		uint8_t prefix_len;  // of the longest aggregated prefix covering the address
+	};
+
+	/**
+	 * @brief Construct a new Resolver object
+	 *
+	 * @param socket_path - the path of the RTM server socket
+	 * @param batch_size - the number of addresses per RTM_LOOKUP, up to
+	 * RTM_MAX_LOOKUP_BATCH
+	 * @param window - the maximum number of batches in flight
+	 */
+	explicit Resolver(const std::string &socket_path = RTM_SOCKET_PATH,
+			  size_t batch_size = DEFAULT_BATCH_SIZE,
+			  size_t window = DEFAULT_WINDOW);
+	~Resolver();
+
+	Resolver(const Resolver&) = delete;
+	Resolver& operator=(const Resolver&) = delete;
+
+	/**
+	 * @brief Connect to the RTM server
+	 *
+	 * @note Throws std::system_error if the connection could not be made.
+	 */
+	void connect();
+
+	/**
+	 * @brief Close the connection to the RTM server
+	 *
+	 */
+	void disconnect();
+
+	/**
+	 * @brief Check if the resolver is connected to the RTM server
+	 *
+	 * @return true if connected, false otherwise
+	 */
+	bool connected() const
+	{
+		return this->sock_fd >= 0;
+	}
+
+	/**
+	 * @brief Resolve addresses by the RTM server
+	 *
+	 * @param addrs - the addresses in host order
+	 * @param results - the routes of the addresses, at least addrs.size()
+	 * @note Throws std::system_error if the connection failed and
+	 * std::runtime_error if the server sent a malformed reply, the resolver
+	 * is disconnected then.
+	 */
+	void resolve(std::span<const uint32_t> addrs, std::span<result> results);
+
+	/**
+	 * @brief Resolve a single address by the RTM server
+	 *
+	 * @param addr - the address in host order
+	 * @return result - the route of the address
+	 * @note Batch addresses with resolve() above for a higher rate.
+	 */
+	result resolve(uint32_t addr)
+	{
+		result res;
+
+		this->resolve(std::span(&addr, 1), std::span(&res, 1));
+		return res;
+	}
+
+	/**
+	 * @brief Get the number of batches sent
+	 *
+	 * @return size_t - the number of RTM_LOOKUP messages
+	 */
+	size_t num_batches() const
+	{
+		return this->batches;
+	}
+
+private:
+	void send_batch(std::span<const uint32_t> addrs);
+	void receive_reply(std::span<result> results);
+
+	std::string socket_path;
+	size_t batch_size;
+	size_t window;
+	int sock_fd = -1;
+	uint32_t next_id = 0;      // id of the next batch sent
+	uint32_t expected_id = 0;  // id of the next reply
+	size_t batches = 0;
+	std::set<rtm_fib::next_hop> next_hops;  // the next hops of the results
+	std::vector<uint8_t> tx_buffer;
+	std::vector<uint8_t> rx_buffer;
+	std::vector<rtm_fib::next_hop> reply_next_hops;  // scratch buffers of a reply
+	std::vector<rtm_lookup_result> reply_results;
+	std::vector<const rtm_fib::next_hop*> reply_index;
+};
+
+}  // namespace RTM
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) coroutine task.
+ *
+ * A task<T> is a lazily started coroutine returning T:
+ *
+ *	task<int> answer() { co_return 42; }
+ *	task<void> caller() { int value = co_await answer(); }
+ *
+ * Awaiting a task starts it and resumes the awaiting coroutine when it
+ * completes (symmetric transfer, no nesting of the stack in optimized builds,
+ * where the transfer is a tail call). An exception
+ * leaving the task is rethrown to the awaiting coroutine. Top-level tasks
+ * are started by a reactor (see reactor.hpp).
+ *
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace RTM {
+
+namespace detail {
+
+struct task_promise_base {
+	std::coroutine_handle<> continuation;  // the awaiting coroutine
+	std::exception_ptr exception;
+
+	struct final_awaiter {
+		bool await_ready() noexcept
+		{
+			return false;
+		}
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+		{
+			// A top-level task stays suspended until its owner destroys it
+			const auto continuation = h.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() noexcept
+		{
+		}
+	};
+
+	std::suspend_always initial_suspend() noexcept
+	{
+		return {};
+	}
+
+	final_awaiter final_suspend() noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception() noexcept
+	{
+		this->exception = std::current_exception();
+	}
+};
+
+template <typename T>
+struct task_promise : task_promise_base {
+	std::optional<T> value;
+
+	void return_value(T v)
+	{
+		this->value.emplace(std::move(v));
+	}
+
+	T result()
+	{
+		if (this->exception) {
+			std::rethrow_exception(this->exception);
+		}
+		return std::move(*this->value);
+	}
+};
+
+template <>
+struct task_promise<void> : task_promise_base {
+	void return_void() noexcept
+	{
+	}
+
+	void result()
+	{
+		if (this->exception) {
+			std::rethrow_exception(this->exception);
+		}
+	}
+};
+
+}  // namespace detail
+
+template <typename T = void>
+class task {
+public:
+	struct promise_type : detail::task_promise<T> {
+		task get_return_object() noexcept
+		{
+			return task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+	};
+
+	task(task &&other) noexcept : handle(std::exchange(other.handle, {}))
+	{
+	}
+
+	task& operator=(task &&other) noexcept
+	{
+		if (this != &other) {
+			this->reset();
+			this->handle = std::exchange(other.handle, {});
+		}
+		return *this;
+	}
+
+	~task()
+	{
+		this->reset();
+	}
+
+	task(const task&) = delete;
+	task& operator=(const task&) = delete;
+
+	bool await_ready() const noexcept
+	{
+		return this->handle.done();
+	}
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		this->handle.promise().continuation = awaiting;
+		return this->handle;
+	}
+
+	T await_resume()
+	{
+		return this->handle.promise().result();
+	}
+
+	/**
+	 * @brief Run a top-level task until its first suspension
+	 *
+	 */
+	void start()
+	{
+		this->handle.resume();
+	}
+
+	/**
+	 * @brief Check if the task completed
+	 *
+	 * @return true if the task returned or threw
+	 */
+	bool done() const noexcept
+	{
+		return this->handle.done();
+	}
+
+	/**
+	 * @brief Get the result of a completed task
+	 *
+	 * @return T - the returned value, rethrows the exception of the task
+	 */
+	T result()
+	{
+		return this->handle.promise().result();
+	}
+
+private:
+	explicit task(std::coroutine_handle<promise_type> h) noexcept : handle(h)
+	{
+	}
+
+	void reset() noexcept
+	{
+		if (this->handle) {
+			this->handle.destroy();
+			this->handle = {};
+		}
+	}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+}  // namespace RTM
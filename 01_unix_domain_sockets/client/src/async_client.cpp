@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) asynchronous client implementation
+ */
+
+#include <system_error>
+
+#include <cerrno>
+
+#include <async_client.hpp>
+
+
+using namespace RTM;
+
+AsyncClient::AsyncClient(reactor &r, const std::string &socket_path, size_t cache_slots) :
+	r(r), client(socket_path, cache_slots)
+{
+	this->client.set_change_handler([this](cud_opcode_t opcode,
+						const routing_table_entry &entry) {
+		// The table state is read from the table
+		if (this->client.synchronized()) {
+			this->updates.push_back({opcode, entry});
+		}
+	});
+}
+
+AsyncClient::~AsyncClient()
+{
+	this->disconnect();
+}
+
+task<void> AsyncClient::connect()
+{
+	this->disconnect();
+	this->client.connect();
+	this->r.add(this->client.fd(), this->source);
+	this->watched_fd = this->client.fd();
+	this->was_synchronized = false;
+	this->loaded = false;
+	co_return;
+}
+
+void AsyncClient::disconnect()
+{
+	this->unwatch();
+	this->client.disconnect();
+	this->updates.clear();
+}
+
+void AsyncClient::unwatch()
+{
+	if (this->watched_fd >= 0) {
+		this->r.remove(this->watched_fd);
+		this->watched_fd = -1;
+	}
+	if (this->watched_ring_fd >= 0) {
+		this->r.remove(this->watched_ring_fd);
+		this->watched_ring_fd = -1;
+	}
+}
+
+task<void> AsyncClient::synchronized()
+{
+	while (!this->client.synchronized()) {
+		co_await this->wait();
+	}
+}
+
+task<AsyncClient::update> AsyncClient::next_update()
+{
+	while (this->updates.empty()) {
+		co_await this->wait();
+	}
+
+	auto next = std::move(this->updates.front());
+	this->updates.pop_front();
+	co_return next;
+}
+
+task<void> AsyncClient::wait()
+{
+	// Everything available is applied before waiting for more
+	const bool applied = this->receive_all();
+	if (!this->client.connected()) {
+		this->unwatch();
+		throw std::system_error(ECONNRESET, std::generic_category(), "RTM server");
+	}
+	if (!applied) {
+		co_await this->source;
+		this->wakeups++;
+	}
+}
+
+bool AsyncClient::receive_all()
+{
+	bool applied = false;
+
+	while (this->client.try_receive()) {
+		applied = true;
+		// The ring is attached after the connection
+		if (this->client.ring_fd() >= 0 && this->watched_ring_fd < 0) {
+			this->r.add(this->client.ring_fd(), this->source);
+			this->watched_ring_fd = this->client.ring_fd();
+		}
+
+		const bool synchronized = this->client.synchronized();
+		if (synchronized && !this->was_synchronized) {
+			if (this->loaded) {
+				// The table state was received again
+				this->updates.push_back({RTM_SYNC_DONE, {}});
+			}
+			this->loaded = true;
+		}
+		this->was_synchronized = synchronized;
+	}
+
+	return applied;
+}
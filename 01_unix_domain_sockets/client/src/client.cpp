@@ -4,7 +4,498 @@
  * @brief Routig Table Manager (RTM) Client implementation
  */
 
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
 #include <client.hpp>
 
 
 using namespace RTM;
+
+Client::Client(const std::string &socket_path, size_t cache_slots) :
+	socket_path(socket_path), rx_buffer(RTM_MAX_MSG_SIZE), table(&this->table_pool),
+	cache(cache_slots)
+{
+}
+
+Client::~Client()
+{
+	this->disconnect();
+}
+
+void Client::add_filter(const subscription_filter &filter)
+{
+	this->filters.push_back(filter);
+}
+
+void Client::connect()
+{
+	struct sockaddr_un addr = {};
+
+	if (this->socket_path.size() >= sizeof(addr.sun_path)) {
+		throw std::invalid_argument("socket path is too long: " +
+					    this->socket_path);
+	}
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, this->socket_path.c_str(),
+		    this->socket_path.size());
+
+	this->disconnect();
+	this->sock_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (this->sock_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "socket");
+	}
+	if (::connect(this->sock_fd, reinterpret_cast<struct sockaddr*>(&addr),
+		      sizeof(addr)) < 0) {
+		const auto err = errno;
+		this->disconnect();
+		throw std::system_error(err, std::generic_category(), "connect");
+	}
+
+	// The ring is attached before the subscription, the server answers
+	// with RTM_RING ahead of the table state
+	bool sent = true;
+	if (this->ring_requested) {
+		std::vector<uint8_t> msg;
+		rtm_message::init(msg, RTM_RING_ATTACH);
+		sent = send(this->sock_fd, msg.data(), msg.size(), MSG_NOSIGNAL) >= 0;
+	}
+
+	// Subscribe, the server answers with the table state
+	if (!sent || !this->subscribe()) {
+		const auto err = errno;
+		this->disconnect();
+		throw std::system_error(err, std::generic_category(), "send");
+	}
+
+	// The pipeline reads the socket from now on
+	if (this->pipeline_requested && !this->ring_requested) {
+		try {
+			this->pipeline = std::make_unique<client_pipeline>(this->sock_fd);
+		} catch (...) {
+			this->disconnect();
+			throw;
+		}
+	}
+}
+
+bool Client::subscribe()
+{
+	std::vector<uint8_t> msg;
+
+	rtm_message::init(msg, RTM_SUBSCRIBE);
+	subscription_filter::serialize(this->filters, msg);
+	const rtm_msg_hdr hdr = {RTM_SUBSCRIBE,
+				 static_cast<uint32_t>(this->filters.size())};
+	rtm_msg_hdr_codec::encode(hdr, msg.data());
+
+	if (send(this->sock_fd, msg.data(), msg.size(), MSG_NOSIGNAL) < 0) {
+		return false;
+	}
+	this->table.clear();
+	this->cache.clear();
+	this->in_sync = false;
+
+	return true;
+}
+
+void Client::apply_entry(cud_opcode_t opcode, const routing_table_entry &entry)
+{
+	const auto *old_entry = this->table.find(entry.destination_ip_u32);
+
+	if (opcode == RTM_DELETE) {
+		if (old_entry == nullptr) {
+			return;
+		}
+		this->cache.invalidate(*old_entry);
+		if (this->change_handler) {
+			// The handler gets the entry as it was stored, a ring client
+			// deletes entries moved out of its filters by their new fields
+			const routing_table_entry deleted = *old_entry;
+			this->table.delete_entry(deleted);
+			this->change_handler(RTM_DELETE, deleted);
+			return;
+		}
+		this->table.delete_entry(entry);
+	} else {
+		// A replacement may change the prefix length of the entry
+		if (old_entry != nullptr) {
+			this->cache.invalidate(*old_entry);
+		}
+		this->table.create_entry(entry);
+		this->cache.invalidate(entry);
+	}
+	if (this->change_handler) {
+		this->change_handler(opcode, entry);
+	}
+}
+
+void Client::apply_delta(const routing_table_entry &delta, uint32_t fields)
+{
+	const auto *entry = this->table.find(delta.destination_ip_u32);
+
+	if (entry == nullptr) {
+		return;
+	}
+	if (fields & RTM_FIELD_MASK) {
+		// The lookups of the old and the new prefix change
+		this->cache.invalidate(*entry);
+		this->table.update_entry(delta, fields);
+		this->cache.invalidate(*entry);
+	} else {
+		// The cache holds the entry updated in place
+		this->table.update_entry(delta, fields);
+	}
+	if (this->change_handler) {
+		this->change_handler(RTM_UPDATE, *entry);
+	}
+}
+
+void Client::publish_version()
+{
+	// Only the thread applying the changes writes the version
+	this->version.store(this->version.load(std::memory_order_relaxed) + 1,
+			    std::memory_order_release);
+}
+
+void Client::disconnect()
+{
+	// Stops the threads reading the socket
+	this->pipeline.reset();
+	if (this->sock_fd >= 0) {
+		close(this->sock_fd);
+		this->sock_fd = -1;
+	}
+	if (this->event_fd >= 0) {
+		close(this->event_fd);
+		this->event_fd = -1;
+	}
+	this->ring.reset();
+	this->in_sync = false;
+}
+
+bool Client::receive(int timeout_ms)
+{
+	const auto deadline = std::chrono::steady_clock::now() +
+			      std::chrono::milliseconds(timeout_ms);
+
+	while (this->sock_fd >= 0) {
+		if (this->pipeline && (this->try_receive() || !this->connected())) {
+			return this->connected();
+		}
+
+		const bool follow_ring = this->ring && this->in_sync;
+		if (follow_ring) {
+			if (this->consume_ring() || !this->connected()) {
+				return this->connected();
+			}
+			// Sleep only if nothing was published meanwhile
+			if (!this->ring->arm_wakeup(this->ring_consumer,
+						    this->ring_position)) {
+				continue;
+			}
+		}
+
+		int wait_ms = timeout_ms;
+		if (timeout_ms >= 0) {
+			const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+				deadline - std::chrono::steady_clock::now());
+			wait_ms = std::max<int>(0, remaining.count());
+		}
+
+		struct pollfd pfds[2] = {
+			{this->fd(), POLLIN, 0},
+			{this->event_fd, POLLIN, 0},
+		};
+		const int ret = ::poll(pfds, follow_ring ? 2 : 1, wait_ms);
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+		if (ret <= 0) {
+			return false;
+		}
+		if (follow_ring && (pfds[1].revents & POLLIN)) {
+			eventfd_t value;
+			eventfd_read(this->event_fd, &value);
+		}
+		if (pfds[0].revents != 0 && !this->pipeline) {
+			return this->receive_packet();
+		}
+	}
+
+	return false;
+}
+
+bool Client::try_receive()
+{
+	if (this->pipeline) {
+		// Clear the last wakeup before looking for a batch
+		eventfd_t value;
+		eventfd_read(this->pipeline->fd(), &value);
+		return this->apply_batch();
+	}
+
+	while (this->sock_fd >= 0) {
+		if (this->ring && this->in_sync) {
+			if (this->consume_ring() || !this->connected()) {
+				return this->connected();
+			}
+			// Clear the last wakeup, then sleep only if nothing was
+			// published meanwhile
+			eventfd_t value;
+			eventfd_read(this->event_fd, &value);
+			if (!this->ring->arm_wakeup(this->ring_consumer,
+						    this->ring_position)) {
+				continue;
+			}
+		}
+		return this->receive_packet(MSG_DONTWAIT);
+	}
+
+	return false;
+}
+
+bool Client::receive_packet(int flags)
+{
+	int fds[2] = {-1, -1};
+	alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = {this->rx_buffer.data(), this->rx_buffer.size()};
+	struct msghdr mh = {};
+
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = control;
+	mh.msg_controllen = sizeof(control);
+
+	ssize_t len;
+	do {
+		len = recvmsg(this->sock_fd, &mh, MSG_CMSG_CLOEXEC | flags);
+	} while (len < 0 && errno == EINTR);
+
+	if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		return false;
+	}
+	if (len <= 0) {
+		// Server closed the connection
+		this->disconnect();
+		return false;
+	}
+
+	size_t num_fds = 0;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mh); cmsg != nullptr;
+	     cmsg = CMSG_NXTHDR(&mh, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+			num_fds = std::min<size_t>(2, (cmsg->cmsg_len - CMSG_LEN(0)) /
+							 sizeof(int));
+			std::memcpy(fds, CMSG_DATA(cmsg), num_fds * sizeof(int));
+		}
+	}
+
+	const bool ok = this->apply(std::span<const uint8_t>(this->rx_buffer.data(), len),
+				    std::span<int>(fds, num_fds));
+	// Descriptors not taken over by the message
+	for (const int fd : fds) {
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+	if (!ok) {
+		this->disconnect();
+		return false;
+	}
+	this->publish_version();
+
+	return true;
+}
+
+bool Client::apply_batch()
+{
+	auto *batch = this->pipeline->pop();
+	if (batch == nullptr) {
+		return false;
+	}
+
+	for (const auto &change : batch->changes) {
+		switch (change.opcode) {
+		case RTM_UPDATE:
+			this->apply_delta(change.entry, change.fields);
+			break;
+		case RTM_SYNC_DONE:
+			this->in_sync = true;
+			break;
+		default:
+			this->apply_entry(change.opcode, change.entry);
+			break;
+		}
+	}
+	const bool closed = batch->closed;
+	this->pipeline->recycle(batch);
+	this->publish_version();
+
+	if (closed) {
+		this->disconnect();
+		return false;
+	}
+
+	return true;
+}
+
+bool Client::apply(std::span<const uint8_t> packet, std::span<int> fds)
+{
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	if (!rtm_message::parse(packet, hdr, payload)) {
+		return false;
+	}
+
+	switch (hdr.opcode) {
+	case RTM_CREATE:
+		return rtm_message::for_each_entry(hdr, payload,
+			[this](const routing_table_entry &entry) {
+				this->apply_entry(RTM_CREATE, entry);
+			});
+	case RTM_UPDATE:
+		return rtm_message::for_each_delta(hdr, payload,
+			[this](const routing_table_entry &delta, uint32_t fields) {
+				this->apply_delta(delta, fields);
+			});
+	case RTM_DELETE:
+		return rtm_message::for_each_entry(hdr, payload,
+			[this](const routing_table_entry &entry) {
+				this->apply_entry(RTM_DELETE, entry);
+			});
+	case RTM_SYNC_DONE:
+		if (this->ring) {
+			// The ring notifications following the table state
+			rtm_sync_done sync_done;
+			if (!rtm_message::parse<rtm_sync_done_codec>(payload, sync_done)) {
+				return false;
+			}
+			this->ring_position = sync_done.ring_position;
+		}
+		this->in_sync = true;
+		return true;
+	case RTM_RING:
+		return this->attach_ring(payload, fds);
+	default:
+		return false;
+	}
+}
+
+bool Client::attach_ring(std::span<const uint8_t> payload, std::span<int> fds)
+{
+	if (fds.size() != 2) {
+		// The server has no ring available: stay on the socket
+		return fds.empty();
+	}
+	rtm_ring_info info;
+	if (!rtm_message::parse<rtm_ring_info_codec>(payload, info)) {
+		return false;
+	}
+	this->ring_consumer = info.consumer;
+
+	try {
+		const int mem_fd = std::exchange(fds[0], -1);
+		this->ring = rtm_ring::attach(mem_fd);
+	} catch (const std::exception&) {
+		return false;
+	}
+	if (this->ring_consumer >= this->ring->max_consumers()) {
+		this->ring.reset();
+		return false;
+	}
+	this->event_fd = std::exchange(fds[1], -1);
+
+	return true;
+}
+
+bool Client::consume_ring()
+{
+	bool applied = false;
+
+	while (true) {
+		switch (this->ring->read(this->ring_position, this->ring_buffer)) {
+		case rtm_ring::RING_OK:
+			if (!this->apply_ring(this->ring_buffer)) {
+				this->disconnect();
+				return false;
+			}
+			this->publish_version();
+			applied = true;
+			break;
+		case rtm_ring::RING_EMPTY:
+			return applied;
+		case rtm_ring::RING_OVERRUN:
+			// Missed notifications: receive the table state again
+			this->overruns++;
+			if (!this->subscribe()) {
+				this->disconnect();
+				return false;
+			}
+			return true;
+		}
+	}
+}
+
+bool Client::apply_ring(std::span<const uint8_t> packet)
+{
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	if (!rtm_message::parse(packet, hdr, payload)) {
+		return false;
+	}
+
+	switch (hdr.opcode) {
+	case RTM_CREATE:
+		// The ring holds all notifications: an entry moved out of the
+		// filters is deleted
+		return rtm_message::for_each_entry(hdr, payload,
+			[this](const routing_table_entry &entry) {
+				if (subscription_filter::matches(this->filters, entry)) {
+					this->apply_entry(RTM_CREATE, entry);
+				} else {
+					this->apply_entry(RTM_DELETE, entry);
+				}
+			});
+	case RTM_UPDATE:
+		// A delta changing the mask or OIF the filters match on holds the
+		// whole entry, it may move the entry into or out of the filters.
+		// Other deltas apply to the entries in the table only.
+		return rtm_message::for_each_delta(hdr, payload,
+			[this](const routing_table_entry &delta, uint32_t fields) {
+				if (!(fields & (RTM_FIELD_MASK | RTM_FIELD_OIF))) {
+					this->apply_delta(delta, fields);
+					return;
+				}
+				const bool has_entry =
+					this->table.find(delta.destination_ip_u32) != nullptr;
+				if (!subscription_filter::matches(this->filters, delta)) {
+					if (has_entry) {
+						this->apply_entry(RTM_DELETE, delta);
+					}
+				} else if (has_entry) {
+					this->apply_delta(delta, fields);
+				} else {
+					this->apply_entry(RTM_CREATE, delta);
+				}
+			});
+	case RTM_DELETE:
+		return rtm_message::for_each_entry(hdr, payload,
+			[this](const routing_table_entry &entry) {
+				this->apply_entry(RTM_DELETE, entry);
+			});
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) client receive pipeline implementation
+ */
+
+#include <system_error>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <client_pipeline.hpp>
+
+
+using namespace RTM;
+
+client_pipeline::client_pipeline(int sock_fd) :
+	sock_fd(sock_fd)
+{
+	// The receive and the decode thread sleep in eventfd_read()
+	this->rx_fd = eventfd(0, EFD_CLOEXEC);
+	this->decode_fd = eventfd(0, EFD_CLOEXEC);
+	this->ready_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->rx_fd < 0 || this->decode_fd < 0 || this->ready_fd < 0) {
+		const auto err = errno;
+		this->stop();
+		throw std::system_error(err, std::generic_category(), "eventfd");
+	}
+
+	for (size_t i = 0; i < NUM_BATCHES; ++i) {
+		auto rx = std::make_unique<rx_batch>();
+		rx->data.resize(RX_BATCH_PACKETS * RTM_MAX_MSG_SIZE);
+		rx->sizes.reserve(RX_BATCH_PACKETS);
+		this->rx_free.push(rx.get());
+		this->rx_batches.push_back(std::move(rx));
+
+		auto decoded = std::make_unique<batch>();
+		this->decoded_free.push(decoded.get());
+		this->batches.push_back(std::move(decoded));
+	}
+
+	try {
+		this->rx_thread = std::thread(&client_pipeline::receive_loop, this);
+		this->decode_thread = std::thread(&client_pipeline::decode_loop, this);
+	} catch (...) {
+		this->stop();
+		throw;
+	}
+}
+
+client_pipeline::~client_pipeline()
+{
+	this->stop();
+}
+
+void client_pipeline::stop()
+{
+	this->stopping.store(true, std::memory_order_release);
+	// Ends a recvmmsg() of the receive thread
+	shutdown(this->sock_fd, SHUT_RD);
+
+	for (const int fd : {this->rx_fd, this->decode_fd}) {
+		if (fd >= 0) {
+			eventfd_write(fd, 1);
+		}
+	}
+	if (this->rx_thread.joinable()) {
+		this->rx_thread.join();
+	}
+	if (this->decode_thread.joinable()) {
+		this->decode_thread.join();
+	}
+
+	for (int *fd : {&this->rx_fd, &this->decode_fd, &this->ready_fd}) {
+		if (*fd >= 0) {
+			close(*fd);
+			*fd = -1;
+		}
+	}
+}
+
+client_pipeline::batch* client_pipeline::pop()
+{
+	batch *b = nullptr;
+
+	return this->decoded_full.pop(b) ? b : nullptr;
+}
+
+void client_pipeline::recycle(batch *b)
+{
+	this->decoded_free.push(b);
+	eventfd_write(this->decode_fd, 1);
+}
+
+void client_pipeline::receive_loop()
+{
+	struct mmsghdr msgs[RX_BATCH_PACKETS];
+	struct iovec iovs[RX_BATCH_PACKETS];
+	rx_batch *b = nullptr;
+
+	while (!this->stopping.load(std::memory_order_acquire)) {
+		if (!this->rx_free.pop(b)) {
+			// All buffers are in the decode stage
+			eventfd_t value;
+			eventfd_read(this->rx_fd, &value);
+			continue;
+		}
+
+		for (size_t i = 0; i < RX_BATCH_PACKETS; ++i) {
+			iovs[i] = {b->data.data() + i * RTM_MAX_MSG_SIZE, RTM_MAX_MSG_SIZE};
+			msgs[i] = {};
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// Waits for the first message, takes the others already queued
+		int n;
+		do {
+			n = recvmmsg(this->sock_fd, msgs, RX_BATCH_PACKETS, MSG_WAITFORONE,
+				     nullptr);
+		} while (n < 0 && errno == EINTR);
+
+		b->sizes.clear();
+		bool truncated = false;
+		for (int i = 0; i < n && !truncated; ++i) {
+			// A message larger than RTM_MAX_MSG_SIZE is malformed, it ends
+			// the connection after the messages before it
+			truncated = msgs[i].msg_hdr.msg_flags & MSG_TRUNC;
+			if (!truncated) {
+				b->sizes.push_back(msgs[i].msg_len);
+			}
+		}
+		// Server closed the connection
+		b->closed = n <= 0 || truncated;
+
+		const bool closed = b->closed;
+		this->rx_full.push(b);
+		eventfd_write(this->decode_fd, 1);
+		if (closed) {
+			return;
+		}
+	}
+}
+
+void client_pipeline::decode_loop()
+{
+	rx_batch *in = nullptr;
+	batch *out = nullptr;
+
+	while (!this->stopping.load(std::memory_order_acquire)) {
+		if ((in == nullptr && !this->rx_full.pop(in)) ||
+		    (out == nullptr && !this->decoded_free.pop(out))) {
+			eventfd_t value;
+			eventfd_read(this->decode_fd, &value);
+			continue;
+		}
+
+		// A malformed message ends the connection like a closed one
+		out->closed = !this->decode(*in, *out) || in->closed;
+
+		const bool closed = out->closed;
+		this->rx_free.push(std::exchange(in, nullptr));
+		eventfd_write(this->rx_fd, 1);
+		this->decoded_full.push(std::exchange(out, nullptr));
+		eventfd_write(this->ready_fd, 1);
+		if (closed) {
+			return;
+		}
+	}
+}
+
+bool client_pipeline::decode(const rx_batch &in, batch &out)
+{
+	out.changes.clear();
+
+	for (size_t i = 0; i < in.sizes.size(); ++i) {
+		const std::span<const uint8_t> packet(in.data.data() + i * RTM_MAX_MSG_SIZE,
+						      in.sizes[i]);
+		rtm_msg_hdr hdr;
+		std::span<const uint8_t> payload;
+
+		if (!rtm_message::parse(packet, hdr, payload)) {
+			return false;
+		}
+
+		bool ok = false;
+		switch (hdr.opcode) {
+		case RTM_CREATE:
+		case RTM_DELETE: {
+			const auto opcode = static_cast<cud_opcode_t>(hdr.opcode);
+			ok = rtm_message::for_each_entry(hdr, payload,
+				[&out, opcode](const routing_table_entry &entry) {
+					out.changes.push_back({opcode, 0, entry});
+				});
+			break;
+		}
+		case RTM_UPDATE:
+			ok = rtm_message::for_each_delta(hdr, payload,
+				[&out](const routing_table_entry &delta, uint32_t fields) {
+					out.changes.push_back({RTM_UPDATE, fields, delta});
+				});
+			break;
+		case RTM_SYNC_DONE:
+			out.changes.push_back({RTM_SYNC_DONE, 0, {}});
+			ok = true;
+			break;
+		default:
+			break;
+		}
+		if (!ok) {
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -2,11 +2,126 @@
  * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
  * SPDX-License-Identifier: Apache-2.0
  * @brief Routig Table Manager (RTM) Client main entry point.
+ *
+ * Usage: rtm_client [-r] [-p] [-f <prefix>/<len>[,<oif>]]... [-q <address>]...
+ *		     [socket_path]
+ *	-r	follow the shared memory ring of the server
+ *	-p	receive and decode the notifications in separate threads
+ *
+ * Each -f option adds a subscription filter, e.g.:
+ *	rtm_client -f 10.0.0.0/8 -f ,eth1
+ * subscribes to the routes inside of 10.0.0.0/8 and to the routes out of eth1.
+ *
+ * With -q the client resolves the addresses by the server and exits instead
+ * of receiving the table, e.g.:
+ *	rtm_client -q 10.1.2.3 -q 192.168.0.1
  */
 
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
 #include <client.hpp>
+#include <resolver.hpp>
+
+
+using namespace RTM;
 
+static int resolve(const std::string &socket_path, const std::vector<uint32_t> &addrs)
+{
+	Resolver resolver(socket_path);
+	std::vector<Resolver::result> results(addrs.size());
+
+	try {
+		resolver.connect();
+		resolver.resolve(addrs, results);
+	} catch (const std::exception &e) {
+		std::cerr << "Failed to resolve by RTM server: " << e.what() << std::endl;
+		return 1;
+	}
+
+	for (size_t i = 0; i < addrs.size(); ++i) {
+		routing_table_entry entry;
+		entry.destination_ip_u32 = htonl(addrs[i]);
+		std::cout << routing_table_entry::destination_ip2str(entry);
+		if (results[i].next_hop == nullptr) {
+			std::cout << " unreachable" << std::endl;
+			continue;
+		}
+		entry.destination_ip_u32 = results[i].next_hop->gateway_ip_u32;
+		std::cout << " via " << routing_table_entry::destination_ip2str(entry)
+			  << " dev " << results[i].next_hop->oif
+			  << " (/" << static_cast<int>(results[i].prefix_len) << ")"
+			  << std::endl;
+	}
+
+	return 0;
+}
 
 int main(int argc, char *argv[]) {
+	std::vector<subscription_filter> filters;
+	std::vector<uint32_t> addrs;
+	bool ring = false;
+	bool pipeline = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "rpf:q:")) != -1) {
+		subscription_filter filter;
+		uint8_t ip[4];
+		switch (opt) {
+		case 'f':
+			if (!subscription_filter::from_string(optarg, filter)) {
+				std::cerr << "Invalid filter: " << optarg << std::endl;
+				return 1;
+			}
+			filters.push_back(filter);
+			break;
+		case 'q':
+			if (!routing_table_entry::str2ip(optarg, ip)) {
+				std::cerr << "Invalid address: " << optarg << std::endl;
+				return 1;
+			}
+			addrs.push_back(routing_table_entry::ip2host(ip));
+			break;
+		case 'r':
+			ring = true;
+			break;
+		case 'p':
+			pipeline = true;
+			break;
+		default:
+			std::cerr << "Usage: " << argv[0]
+				  << " [-r] [-p] [-f <prefix>/<len>[,<oif>]]... [-q <address>]..."
+				  << " [socket_path]" << std::endl;
+			return 1;
+		}
+	}
+
+	const std::string socket_path = optind < argc ? argv[optind] : RTM_SOCKET_PATH;
+	if (!addrs.empty()) {
+		return resolve(socket_path, addrs);
+	}
+
+	Client client(socket_path);
+	for (const auto &filter : filters) {
+		client.add_filter(filter);
+	}
+	client.use_ring(ring);
+	client.use_pipeline(pipeline);
+
+	try {
+		client.connect();
+	} catch (const std::exception &e) {
+		std::cerr << "Failed to connect to RTM server: " << e.what() << std::endl;
+		return 1;
+	}
+
+	while (client.receive()) {
+		if (client.synchronized()) {
+			std::cout << client.get_table().to_string() << std::endl;
+		}
+	}
+
 	return 0;
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) coroutine reactor implementation
+ */
+
+#include <algorithm>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <reactor.hpp>
+
+
+using namespace RTM;
+
+static constexpr int MAX_EVENTS = 64;
+
+reactor::reactor()
+{
+	this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (this->epoll_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_create1");
+	}
+}
+
+reactor::~reactor()
+{
+	// The tasks are destroyed before the descriptor they may still watch
+	this->tasks.clear();
+	close(this->epoll_fd);
+}
+
+void reactor::add(int fd, source &src)
+{
+	struct epoll_event ev = {};
+
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.ptr = &src;
+	if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+	}
+}
+
+void reactor::remove(int fd)
+{
+	// Fails for a closed descriptor, which is not watched anymore
+	epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void reactor::spawn(task<void> t)
+{
+	t.start();
+	this->tasks.push_back(std::move(t));
+	this->reap();
+}
+
+int reactor::poll(int timeout_ms)
+{
+	struct epoll_event events[MAX_EVENTS];
+
+	int num_events;
+	do {
+		num_events = epoll_wait(this->epoll_fd, events, MAX_EVENTS, timeout_ms);
+	} while (num_events < 0 && errno == EINTR);
+
+	if (num_events < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_wait");
+	}
+
+	// Signal all sources before resuming any coroutine, which may remove
+	// the sources of the following events
+	this->resumable.clear();
+	for (int i = 0; i < num_events; ++i) {
+		auto &src = *static_cast<source*>(events[i].data.ptr);
+		if (src.waiter) {
+			this->resumable.push_back(std::exchange(src.waiter, {}));
+		} else {
+			src.ready = true;
+		}
+	}
+	for (const auto h : this->resumable) {
+		h.resume();
+	}
+	this->reap();
+
+	return num_events;
+}
+
+void reactor::run()
+{
+	while (!this->tasks.empty()) {
+		this->poll(-1);
+	}
+}
+
+void reactor::reap()
+{
+	const auto done = std::ranges::partition(this->tasks, [](const task<void> &t) {
+		return !t.done();
+	});
+	if (done.empty()) {
+		return;
+	}
+
+	// Rethrow the first exception after the completed tasks are released
+	std::exception_ptr exception;
+	for (auto &t : done) {
+		try {
+			t.result();
+		} catch (...) {
+			if (!exception) {
+				exception = std::current_exception();
+			}
+		}
+	}
+	this->tasks.erase(done.begin(), done.end());
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Resolver implementation
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <resolver.hpp>
+
+
+using namespace RTM;
+
+Resolver::Resolver(const std::string &socket_path, size_t batch_size, size_t window) :
+	socket_path(socket_path),
+	batch_size(std::clamp<size_t>(batch_size, 1, RTM_MAX_LOOKUP_BATCH)),
+	window(std::max<size_t>(window, 1)), rx_buffer(RTM_MAX_MSG_SIZE)
+{
+}
+
+Resolver::~Resolver()
+{
+	this->disconnect();
+}
+
+void Resolver::connect()
+{
+	struct sockaddr_un addr = {};
+
+	if (this->socket_path.size() >= sizeof(addr.sun_path)) {
+		throw std::invalid_argument("socket path is too long: " +
+					    this->socket_path);
+	}
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, this->socket_path.c_str(),
+		    this->socket_path.size());
+
+	this->disconnect();
+	this->sock_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (this->sock_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "socket");
+	}
+	if (::connect(this->sock_fd, reinterpret_cast<struct sockaddr*>(&addr),
+		      sizeof(addr)) < 0) {
+		const auto err = errno;
+		this->disconnect();
+		throw std::system_error(err, std::generic_category(), "connect");
+	}
+	this->next_id = 0;
+	this->expected_id = 0;
+}
+
+void Resolver::disconnect()
+{
+	if (this->sock_fd >= 0) {
+		close(this->sock_fd);
+		this->sock_fd = -1;
+	}
+}
+
+void Resolver::resolve(std::span<const uint32_t> addrs, std::span<result> results)
+{
+	if (results.size() < addrs.size()) {
+		throw std::invalid_argument("fewer results than addresses");
+	}
+	if (this->sock_fd < 0) {
+		throw std::system_error(ENOTCONN, std::generic_category(), "resolve");
+	}
+
+	const size_t size = this->batch_size;
+	const size_t num_batches = (addrs.size() + size - 1) / size;
+	auto batch = [&](auto span, size_t i) {
+		return span.subspan(i * size, std::min(size, addrs.size() - i * size));
+	};
+
+	size_t sent = 0;
+	for (size_t done = 0; done < num_batches; ++done) {
+		// The server resolves a batch while the next ones are in flight
+		for (; sent < num_batches && sent - done < this->window; ++sent) {
+			this->send_batch(batch(addrs, sent));
+		}
+		this->receive_reply(batch(results, done));
+	}
+}
+
+void Resolver::send_batch(std::span<const uint32_t> addrs)
+{
+	rtm_message::make_lookup(this->tx_buffer, this->next_id, addrs);
+
+	ssize_t len;
+	do {
+		len = send(this->sock_fd, this->tx_buffer.data(), this->tx_buffer.size(),
+			   MSG_NOSIGNAL);
+	} while (len < 0 && errno == EINTR);
+
+	if (len < 0) {
+		const auto err = errno;
+		this->disconnect();
+		throw std::system_error(err, std::generic_category(), "send");
+	}
+	this->next_id++;
+	this->batches++;
+}
+
+void Resolver::receive_reply(std::span<result> results)
+{
+	struct iovec iov = {this->rx_buffer.data(), this->rx_buffer.size()};
+	struct msghdr mh = {};
+
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+
+	ssize_t len;
+	do {
+		len = recvmsg(this->sock_fd, &mh, 0);
+	} while (len < 0 && errno == EINTR);
+
+	if (len <= 0) {
+		const auto err = len < 0 ? errno : ECONNRESET;
+		this->disconnect();
+		throw std::system_error(err, std::generic_category(), "recv");
+	}
+
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+	rtm_lookup_reply reply;
+	if ((mh.msg_flags & MSG_TRUNC) ||
+	    !rtm_message::parse(std::span<const uint8_t>(this->rx_buffer.data(), len),
+				hdr, payload) ||
+	    hdr.opcode != RTM_LOOKUP_REPLY ||
+	    !rtm_message::parse_lookup_reply(hdr, payload, reply, this->reply_next_hops,
+					     this->reply_results) ||
+	    reply.id != this->expected_id) {
+		this->disconnect();
+		throw std::runtime_error("malformed lookup reply");
+	}
+	this->expected_id++;
+
+	if (hdr.count != results.size()) {
+		this->disconnect();
+		throw std::runtime_error(hdr.count == 0 ?
+					 "lookup reply exceeds the message size" :
+					 "malformed lookup reply");
+	}
+
+	// The next hops are kept once across all replies
+	this->reply_index.assign(1, nullptr);
+	for (auto &nh : this->reply_next_hops) {
+		this->reply_index.push_back(&*this->next_hops.insert(std::move(nh)).first);
+	}
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto &route = this->reply_results[i];
+		results[i] = {this->reply_index[route.next_hop], route.prefix_len};
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server epoll transport backend.
+ *
+ * Client sockets are non-blocking. flush() writes the queued messages of
+ * each client with one send() per message until the socket is full, the
+ * rest is written once epoll reports the socket to be writable again.
+ * A client with more than the backlog limit left queued after the write is
+ * closed by flush().
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+
+#include <io_backend.hpp>
+
+namespace RTM {
+
+class epoll_backend : public io_backend {
+public:
+	explicit epoll_backend(io_handler &handler);
+	~epoll_backend() override;
+
+	io_backend_type type() const override
+	{
+		return io_backend_type::epoll;
+	}
+
+	void start(int listen_fd) override;
+
+	int fd() const override
+	{
+		return this->epoll_fd;
+	}
+
+	int poll(int timeout_ms) override;
+	void send(int fd, const message_ptr &msg) override;
+	void flush() override;
+	bool add_client(int fd) override;
+	void close_client(int fd) override;
+
+private:
+	struct conn {
+		std::deque<message_ptr> tx_queue;
+		size_t tx_bytes = 0;    // size of the messages in tx_queue
+		bool epollout = false;  // waiting for the socket to be writable
+		bool pending = false;   // listed in pending_fds
+	};
+
+	void accept_clients();
+	void handle_client(int fd, uint32_t events);
+	bool write(int fd, conn &c);
+	void release(int fd);
+
+	io_handler &handler;
+	int epoll_fd = -1;
+	int listen_fd = -1;
+	std::unordered_map<int, conn> conns;
+	std::vector<int> pending_fds;  // clients with messages queued by send()
+	std::vector<uint8_t> rx_buffer;
+};
+
+}  // namespace RTM
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server transport backends.
+ *
+ * A backend owns the client sockets I/O of the server: it accepts new
+ * clients, receives their messages and sends the queued notifications.
+ * Sends are queued by send() and submitted to the kernel by flush(), so all
+ * notifications produced in a flush window go out together. A client not
+ * reading its notifications is closed once its queued messages exceed the
+ * backlog limit, see set_max_backlog().
+ *
+ *  | Backend  | Notes                                                    |
+ *  |----------|----------------------------------------------------------|
+ *  | epoll    | readiness based, one send() syscall per message          |
+ *  | io_uring | completion based, one io_uring_enter() per flush window, |
+ *  |          | registered buffers and fixed files (RTM_WITH_IO_URING)   |
+ *
+ * With a pool of I/O threads (see sharded_backend.hpp) each thread runs its
+ * own backend instance for its share of the clients, the handler is still
+ * called from the thread calling poll().
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace RTM {
+
+/**
+ * @brief Message shared between all of its recipients
+ */
+using message_ptr = std::shared_ptr<const std::vector<uint8_t>>;
+
+/**
+ * @brief Transport backend types
+ */
+enum class io_backend_type {
+	epoll,
+	io_uring,
+};
+
+/**
+ * @brief Receiver of the transport backend events
+ *
+ */
+class io_handler {
+public:
+	virtual ~io_handler() {};
+
+	/**
+	 * @brief A new client was accepted
+	 *
+	 * @param fd - the client socket, or the client id of a sharded backend
+	 */
+	virtual void on_accept(int fd) = 0;
+
+	/**
+	 * @brief A message was received from a client
+	 *
+	 * @param fd - the client socket
+	 * @param packet - the received message
+	 */
+	virtual void on_packet(int fd, std::span<const uint8_t> packet) = 0;
+
+	/**
+	 * @brief A client closed its connection or failed
+	 *
+	 * @param fd - the client socket, already released by the backend
+	 */
+	virtual void on_close(int fd) = 0;
+};
+
+
+/**
+ * @brief Transport Backend Interface
+ *
+ */
+class io_backend {
+public:
+	static constexpr size_t DEFAULT_MAX_BACKLOG = 256 << 20;  // bytes per client
+
+	virtual ~io_backend() {};
+
+	/**
+	 * @brief Create a transport backend
+	 *
+	 * @param type - the requested backend type
+	 * @param handler - the receiver of the backend events
+	 * @param num_threads - the number of I/O threads, 0 runs the backend in
+	 * the thread calling poll()
+	 * @return std::unique_ptr<io_backend> - the backend, an epoll backend if
+	 * io_uring was requested but is not available
+	 */
+	static std::unique_ptr<io_backend> create(io_backend_type type,
+						  io_handler &handler,
+						  unsigned num_threads = 0);
+
+	/**
+	 * @brief Get the backend type
+	 *
+	 * @return io_backend_type - the backend type
+	 */
+	virtual io_backend_type type() const = 0;
+
+	/**
+	 * @brief Start accepting clients on a listening socket
+	 *
+	 * @param listen_fd - the listening socket
+	 * @note Throws std::system_error on failure.
+	 */
+	virtual void start(int listen_fd) = 0;
+
+	/**
+	 * @brief Get the file descriptor to wait on for backend events
+	 *
+	 * @return int - the file descriptor, readable when poll() has work to do
+	 */
+	virtual int fd() const = 0;
+
+	/**
+	 * @brief Wait for and dispatch I/O events to the handler
+	 *
+	 * @param timeout_ms - the maximum time to wait for events, -1 waits forever
+	 * @return int - the number of processed events
+	 */
+	virtual int poll(int timeout_ms) = 0;
+
+	/**
+	 * @brief Queue a message for a client
+	 *
+	 * @param fd - the client socket
+	 * @param msg - the message, kept alive until it was sent
+	 * @note A client exceeding the backlog limit is closed by the next
+	 * flush(), the handler on_close() is called for it.
+	 */
+	virtual void send(int fd, const message_ptr &msg) = 0;
+
+	/**
+	 * @brief Send a message passing file descriptors to a client
+	 *
+	 * @param fd - the client socket
+	 * @param msg - the message
+	 * @param fds - the file descriptors to pass (SCM_RIGHTS), they may be
+	 * closed by the caller once the call returned
+	 * @return true if the message was sent or queued, false if the client
+	 * shall be dropped
+	 * @note The message bypasses the queue of send(), so it shall be the first
+	 * message to the client.
+	 */
+	virtual bool send_fds(int fd, std::span<const uint8_t> msg,
+			      std::span<const int> fds);
+
+	/**
+	 * @brief Submit all queued messages to the kernel
+	 *
+	 */
+	virtual void flush() = 0;
+
+	/**
+	 * @brief Take over a client socket accepted elsewhere
+	 *
+	 * @param fd - the connected client socket, owned by the backend afterwards
+	 * @return true if the client was added, false if its socket was closed
+	 * @note The handler on_accept() is not called for this client.
+	 */
+	virtual bool add_client(int fd) = 0;
+
+	/**
+	 * @brief Drop queued messages of a client and close its socket
+	 *
+	 * @param fd - the client socket
+	 * @note The handler on_close() is not called for this client.
+	 */
+	virtual void close_client(int fd) = 0;
+
+	/**
+	 * @brief Limit the messages queued for a client
+	 *
+	 * @param bytes - the maximum size of the messages queued for a client and
+	 * not yet submitted to the kernel
+	 * @note Call before start().
+	 */
+	virtual void set_max_backlog(size_t bytes)
+	{
+		this->max_backlog = bytes;
+	}
+
+protected:
+	size_t max_backlog = DEFAULT_MAX_BACKLOG;
+};
+
+}  // namespace RTM
@@ -24,16 +24,257 @@
  * to this newly connected client
  * - At any given point of time the routing table must be identical on RTM server
  * and all connected clients.
+ * - A client may subscribe only to a part of the table by prefix range and/or
+ * OIF filters (see rtm_subscription.hpp). Such a client receives only the
+ * matching entries of the table state and only the matching CUD notifications.
+ * - The client I/O may be split across a pool of I/O threads (see
+ * sharded_backend.hpp), the routing table and the subscriptions stay owned by
+ * the thread calling poll().
+ * - A client may follow the shared memory ring of the server instead (see
+ * rtm_ring.hpp): each CUD notification is written once into the ring for all
+ * such clients, which apply their filters themselves. The server signals the
+ * eventfd of a ring client only if it went to sleep.
+ * - With open_store() the routing table survives restarts (see rtm_store.hpp):
+ * the CUD operations of a flush window are logged and synced before their
+ * socket notifications are sent.
+ * - A client may resolve addresses by the server instead of holding a copy of
+ * the table: it sends batches of addresses as RTM_LOOKUP and receives one
+ * RTM_LOOKUP_REPLY per batch (see rtm_message.hpp and resolver.hpp). The
+ * batches are resolved by the aggregated FIB of the table (see rtm_fib.hpp),
+ * which is maintained from the first RTM_LOOKUP on.
+ * - The table state is kept encoded as RTM_CREATE messages (see rtm_pages.hpp),
+ * a client receiving the whole table is sent these messages by reference.
+ * A CUD operation re-encodes only the message of its entry.
  *
  */
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+
+#include <routing_table.hpp>
+#include <rtm_message.hpp>
+#include <rtm_subscription.hpp>
+#include <rtm_pages.hpp>
+#include <rtm_ring.hpp>
+#include <rtm_store.hpp>
+#include <io_backend.hpp>
+
 namespace RTM {
 
-class Server {
+class Server : private io_handler {
 public:
+	/**
+	 * @brief Construct a new Server object
+	 *
+	 * @param socket_path - the path of the Unix domain socket to listen on
+	 * @param backend - the transport backend for the client sockets I/O
+	 * @param num_threads - the number of I/O threads the clients are split
+	 * across, 0 handles the client I/O in the thread calling poll()
+	 */
+	explicit Server(const std::string &socket_path = RTM_SOCKET_PATH,
+			io_backend_type backend = io_backend_type::epoll,
+			unsigned num_threads = 0);
+	~Server();
+
+	Server(const Server&) = delete;
+	Server& operator=(const Server&) = delete;
+
+	/**
+	 * @brief Restore the routing table from a store and log its changes there
+	 *
+	 * @param dir - the directory of the store, must exist
+	 * @param snapshot_threshold - the minimum log size in bytes to write a
+	 * compacted snapshot at
+	 * @note Call before start(), the restored entries are not notified.
+	 * @note Throws std::system_error or std::runtime_error if the store
+	 * could not be opened, see rtm_store::open().
+	 */
+	void open_store(const std::string &dir,
+			size_t snapshot_threshold = rtm_store::DEFAULT_SNAPSHOT_THRESHOLD);
+
+	/**
+	 * @brief Seed the routing table from a text file
+	 *
+	 * @param path - the file with one "<destination>/<mask> <gateway> <oif>"
+	 * route per line, see routing_table::load_text()
+	 * @return size_t - the number of loaded routes
+	 * @note Call before start(), the loaded entries are not notified. With a
+	 * store the seeded table is written as a snapshot.
+	 * @note Throws std::system_error if the file could not be read and
+	 * std::invalid_argument if it is malformed.
+	 */
+	size_t load_table(const std::string &path);
+
+	/**
+	 * @brief Limit the notifications queued for a client
+	 *
+	 * @param bytes - the maximum size of the messages queued for a client, a
+	 * client not reading its notifications is disconnected once they exceed it
+	 * @note Call before start().
+	 */
+	void set_max_backlog(size_t bytes)
+	{
+		this->max_backlog = bytes;
+	}
+
+	/**
+	 * @brief Start listening for client connections
+	 *
+	 * @note Throws std::system_error if the socket could not be set up.
+	 * @note Falls back to the epoll backend if io_uring is not available,
+	 * see get_backend_type().
+	 */
+	void start();
+
+	/**
+	 * @brief Disconnect all clients and stop listening
+	 *
+	 */
+	void stop();
+
+	/**
+	 * @brief Process pending connections and client I/O
+	 *
+	 * @param timeout_ms - the maximum time to wait for events, -1 waits forever
+	 * @return int - the number of processed events
+	 * @note Queued notifications are flushed before and after waiting.
+	 */
+	int poll(int timeout_ms);
+
+	/**
+	 * @brief Send all queued notifications to the clients
+	 *
+	 * @note CUD operations only queue their notifications, so a batch of
+	 * operations is sent in one flush window. Sleeping ring clients are
+	 * woken up once per flush window.
+	 * @note With a store the operations are committed to its log first (one
+	 * sync per flush window). Ring clients may see an operation in the ring
+	 * before it is committed. Throws std::system_error if the log could not
+	 * be written.
+	 */
+	void flush();
+
+	/**
+	 * @brief Get the file descriptor to wait on for server events
+	 *
+	 * @return int - the file descriptor, readable when poll() has work to do
+	 * @note Use it to embed the server into another event loop.
+	 */
+	int fd() const
+	{
+		return this->backend ? this->backend->fd() : -1;
+	}
+
+	/**
+	 * @brief Get the type of the running transport backend
+	 *
+	 * @return io_backend_type - the backend type
+	 */
+	io_backend_type get_backend_type() const
+	{
+		return this->backend ? this->backend->type() : this->backend_type;
+	}
+
+	/**
+	 * @brief Create a routing table entry and notify the clients
+	 *
+	 * @param entry - the routing table entry to create
+	 */
+	void create_entry(const routing_table_entry &entry);
+
+	/**
+	 * @brief Update fields of a routing table entry and notify the clients
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the fields to update (rtm_field_t bitmask)
+	 * @note The clients holding the entry receive only the changed fields.
+	 */
+	void update_entry(const routing_table_entry &entry,
+			  uint32_t fields = RTM_FIELD_ALL);
+
+	/**
+	 * @brief Delete a routing table entry and notify the clients
+	 *
+	 * @param entry - the routing table entry to delete
+	 */
+	void delete_entry(const routing_table_entry &entry);
+
+	/**
+	 * @brief Get the routing table of the server
+	 *
+	 * @return const routing_table& - the routing table
+	 */
+	const routing_table& get_table() const
+	{
+		return this->table;
+	}
+
+	/**
+	 * @brief Get the number of connected clients
+	 *
+	 * @return size_t - the number of connected clients
+	 */
+	size_t num_clients() const
+	{
+		return this->clients.size();
+	}
+
 private:
+	struct client_conn {
+		bool subscribed = false;  // RTM_SUBSCRIBE received
+		int ring_consumer = -1;   // ring consumer slot of a ring client
+		int event_fd = -1;        // wakeup eventfd of a ring client
+		bool whole_table = true;  // the filters match all entries
+		std::vector<subscription_filter> filters;  // filters of a ring client
+	};
+
+	void on_accept(int fd) override;
+	void on_packet(int fd, std::span<const uint8_t> packet) override;
+	void on_close(int fd) override;
+
+	void handle_subscribe(int fd, const rtm_msg_hdr &hdr,
+			      std::span<const uint8_t> payload);
+	void handle_ring_attach(int fd);
+	void handle_lookup(int fd, const rtm_msg_hdr &hdr,
+			   std::span<const uint8_t> payload);
+	void send_table(int fd);
+	void wake_ring_clients();
+	void release_client(int fd);
+	void notify(cud_opcode_t opcode, const routing_table_entry &entry,
+		    uint32_t fields = RTM_FIELD_ALL);
+	void drop_client(int fd);
+
+	std::string socket_path;
+	io_backend_type backend_type;
+	unsigned num_threads;
+	size_t max_backlog = io_backend::DEFAULT_MAX_BACKLOG;
+	int listen_fd = -1;
+	std::unique_ptr<io_backend> backend;
+	std::pmr::unsynchronized_pool_resource table_pool;  // entries of the table
+	routing_table table;
+	rtm_pages table_pages;  // table state for clients without filters
+	std::unique_ptr<rtm_store> store;
+	subscription_index subscriptions;
+	std::unordered_map<int, client_conn> clients;
+	std::vector<uint32_t> recipients;      // scratch buffers of notify()
+	std::vector<uint32_t> old_recipients;
+
+	// Scratch buffers of handle_lookup()
+	std::vector<rtm_lookup_result> lookup_results;
+	std::vector<const rtm_fib::next_hop*> lookup_next_hops;
+	std::unordered_map<const rtm_fib::next_hop*, uint16_t> lookup_index;
+
+	// Shared memory ring, created on the first RTM_RING_ATTACH
+	std::unique_ptr<rtm_ring> ring;
+	std::vector<uint32_t> free_consumers;
+	size_t num_ring_clients = 0;
+	uint64_t woken_head = 0;  // ring head of the last wakeup
 };
 
 }  // namespace RTM
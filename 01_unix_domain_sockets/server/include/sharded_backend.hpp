@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server multithreaded transport backend.
+ *
+ * The clients are split across a pool of I/O threads (shards). Each shard
+ * runs its own epoll or io_uring backend instance for its clients.
+ *
+ * - The thread calling poll() (the server thread) owns all server state, the
+ * handler is only called from there.
+ * - The server thread accepts the clients and hands them to the shards
+ * round-robin.
+ * - Commands (add, send, close) go from the server thread to a shard through a
+ * lock-free SPSC queue, events (accept, packet, close) from a shard to the
+ * server thread through another one. A flush() wakes each shard with queued
+ * commands once by its eventfd.
+ * - Messages are serialized once by the server thread and shared by all
+ * shards and clients by reference count (message_ptr).
+ * - Clients are identified by ids which are not reused, so a command for a
+ * closed client never reaches a new client with the same socket.
+ *
+ */
+
+#pragma once
+
+#include <thread>
+#include <unordered_map>
+
+#include <io_backend.hpp>
+#include <spsc_queue.hpp>
+
+namespace RTM {
+
+class sharded_backend : public io_backend {
+public:
+	/**
+	 * @brief Construct a new sharded backend
+	 *
+	 * @param type - the backend type of each shard
+	 * @param handler - the receiver of the backend events
+	 * @param num_threads - the number of shards (I/O threads)
+	 * @note Throws std::system_error if a shard could not be set up.
+	 */
+	sharded_backend(io_backend_type type, io_handler &handler,
+			unsigned num_threads);
+	~sharded_backend() override;
+
+	io_backend_type type() const override;
+	void start(int listen_fd) override;
+
+	int fd() const override
+	{
+		return this->epoll_fd;
+	}
+
+	int poll(int timeout_ms) override;
+	void send(int fd, const message_ptr &msg) override;
+	bool send_fds(int fd, std::span<const uint8_t> msg,
+		      std::span<const int> fds) override;
+	void flush() override;
+	bool add_client(int fd) override;
+	void close_client(int fd) override;
+	void set_max_backlog(size_t bytes) override;
+
+	/**
+	 * @brief Get the number of shards
+	 *
+	 * @return size_t - the number of I/O threads
+	 */
+	size_t num_shards() const
+	{
+		return this->shards.size();
+	}
+
+private:
+	struct command {
+		enum : uint8_t {ADD, SEND, SEND_FDS, CLOSE, STOP} kind = SEND;
+		int id = -1;
+		message_ptr msg;
+		std::vector<int> fds;  // client socket of ADD, descriptors of SEND_FDS
+	};
+
+	struct event {
+		enum : uint8_t {PACKET, CLOSE} kind = PACKET;
+		int id = -1;
+		std::vector<uint8_t> packet;
+	};
+
+	class shard : private io_handler {
+	public:
+		shard(io_backend_type type, int event_fd);
+		~shard();
+
+		void start();
+		void stop();
+		void wakeup();
+		void set_max_backlog(size_t bytes);
+
+		spsc_queue<command> commands;  // server thread -> shard
+		spsc_queue<event> events;      // shard -> server thread
+		bool pending = false;          // commands queued since the last wakeup
+		io_backend_type backend_type;
+
+	private:
+		void on_accept(int fd) override;
+		void on_packet(int fd, std::span<const uint8_t> packet) override;
+		void on_close(int fd) override;
+
+		void run();
+		bool execute(command &cmd);
+		void post(event &&ev);
+
+		int server_event_fd;
+		int wakeup_fd = -1;
+		std::unique_ptr<io_backend> backend;
+		std::thread thread;
+		bool posted = false;  // events posted in this loop iteration
+		std::unordered_map<int, int> id_to_fd;
+		std::unordered_map<int, int> fd_to_id;
+	};
+
+	shard& shard_of(int id);
+	void accept_clients();
+
+	io_handler &handler;
+	int epoll_fd = -1;   // waits for the listening socket and event_fd
+	int event_fd = -1;   // signaled by the shards with events to handle
+	int listen_fd = -1;
+	unsigned id_shift = 0;
+	uint32_t next_id = 0;
+	std::vector<std::unique_ptr<shard>> shards;
+};
+
+}  // namespace RTM
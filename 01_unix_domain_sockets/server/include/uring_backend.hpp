@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server io_uring transport backend.
+ *
+ * - Clients are accepted by a single multishot accept request.
+ * - Each client socket is placed into the registered (fixed) file table at
+ * the index of its file descriptor, all requests use the fixed file.
+ * - Messages are staged once per flush window into a registered buffer pool
+ * and sent to all of their recipients with IORING_OP_SEND from the registered
+ * buffers (IORING_RECVSEND_FIXED_BUF, Linux 6.10). Messages not fitting into
+ * a pool slot, or all messages on kernels without fixed buffer sends, are
+ * sent from their own memory.
+ * - All sends pass MSG_NOSIGNAL, a client closing its socket does not raise
+ * SIGPIPE.
+ * - The messages of one client are linked (IOSQE_IO_LINK) to keep their order,
+ * the requests of all clients of a flush window are submitted with one
+ * io_uring_enter() syscall.
+ * - A client with more than the backlog limit left queued after its sends
+ * were submitted is closed by flush().
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+
+#include <linux/io_uring.h>
+
+#include <io_backend.hpp>
+
+namespace RTM {
+
+class uring_backend : public io_backend {
+public:
+	/**
+	 * @brief Construct a new io_uring backend
+	 *
+	 * @param handler - the receiver of the backend events
+	 * @param entries - the number of submission queue entries
+	 * @note Throws std::system_error if io_uring is not available.
+	 */
+	explicit uring_backend(io_handler &handler, unsigned entries = 4096);
+	~uring_backend() override;
+
+	io_backend_type type() const override
+	{
+		return io_backend_type::io_uring;
+	}
+
+	void start(int listen_fd) override;
+
+	int fd() const override
+	{
+		return this->ring_fd;
+	}
+
+	int poll(int timeout_ms) override;
+	void send(int fd, const message_ptr &msg) override;
+	void flush() override;
+	bool add_client(int fd) override;
+	void close_client(int fd) override;
+
+private:
+	enum class op_kind : uint8_t {
+		accept,
+		recv,
+		send,
+		cancel,
+	};
+
+	struct op {
+		op_kind kind;
+		int fd;
+		message_ptr msg;  // message of a send
+		int slot;         // registered buffer slot of a send or -1
+	};
+
+	struct conn {
+		std::deque<message_ptr> tx_queue;
+		size_t tx_bytes = 0;     // size of the messages in tx_queue
+		std::vector<uint8_t> rx_buffer;
+		unsigned num_ops = 0;    // requests in flight
+		unsigned num_sends = 0;  // send requests in flight
+		bool pending = false;    // listed in pending_fds
+		bool closing = false;    // waiting for requests to complete
+		bool notify = false;     // call on_close() once closed
+	};
+
+	struct io_uring_sqe *get_sqe();
+	void submit(unsigned min_complete);
+	uint32_t alloc_op(op_kind kind, int fd, message_ptr msg = nullptr,
+			  int slot = -1);
+	void arm_accept();
+	void arm_recv(int fd, conn &c);
+	void submit_sends(int fd, conn &c);
+	void check_backlog(int fd, conn &c);
+	int stage(const message_ptr &msg);
+	void release_slot(int slot);
+	void complete(const struct io_uring_cqe &cqe);
+	void accepted(int fd);
+	void shutdown(int fd, conn &c, bool notify);
+	void finalize(int fd);
+	bool probe_fixed_send();
+	void unmap();
+
+	io_handler &handler;
+	int ring_fd = -1;
+	int listen_fd = -1;
+
+	// Submission queue
+	void *sq_ring = nullptr;
+	size_t sq_ring_size = 0;
+	unsigned *sq_head = nullptr;
+	unsigned *sq_tail = nullptr;
+	unsigned *sq_mask = nullptr;
+	unsigned *sq_array = nullptr;
+	struct io_uring_sqe *sqes = nullptr;
+	size_t sqes_size = 0;
+	unsigned sq_entries = 0;
+	unsigned sq_local_tail = 0;  // tail including not yet submitted entries
+	unsigned to_submit = 0;
+
+	// Completion queue
+	void *cq_ring = nullptr;
+	size_t cq_ring_size = 0;
+	unsigned *cq_head = nullptr;
+	unsigned *cq_tail = nullptr;
+	unsigned *cq_mask = nullptr;
+	struct io_uring_cqe *cqes = nullptr;
+	unsigned cq_entries = 0;
+
+	// Registered resources
+	unsigned num_files = 0;
+	uint8_t *pool = nullptr;
+	size_t pool_size = 0;
+	std::vector<unsigned> slot_refs;
+	std::vector<const std::vector<uint8_t>*> slot_msgs;
+	std::vector<int> free_slots;
+	std::unordered_map<const std::vector<uint8_t>*, int> staged;
+	bool fixed_send = false;  // sends from registered buffers are supported
+
+	std::vector<op> ops;
+	std::vector<uint32_t> free_ops;
+	size_t num_inflight = 0;
+	std::unordered_map<int, conn> conns;
+	std::vector<int> pending_fds;  // clients with messages queued by send()
+};
+
+}  // namespace RTM
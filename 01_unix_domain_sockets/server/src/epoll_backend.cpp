@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server epoll transport backend implementation
+ */
+
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <epoll_backend.hpp>
+#include <rtm_message.hpp>
+
+using namespace RTM;
+
+static constexpr int MAX_EPOLL_EVENTS = 64;
+
+epoll_backend::epoll_backend(io_handler &handler) :
+	handler(handler), rx_buffer(RTM_MAX_MSG_SIZE)
+{
+	this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (this->epoll_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_create1");
+	}
+}
+
+epoll_backend::~epoll_backend()
+{
+	while (!this->conns.empty()) {
+		this->release(this->conns.begin()->first);
+	}
+	close(this->epoll_fd);
+}
+
+void epoll_backend::start(int listen_fd)
+{
+	struct epoll_event ev = {};
+
+	ev.events = EPOLLIN;
+	ev.data.fd = listen_fd;
+	if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+	}
+	this->listen_fd = listen_fd;
+}
+
+int epoll_backend::poll(int timeout_ms)
+{
+	struct epoll_event events[MAX_EPOLL_EVENTS];
+
+	const int num_events = epoll_wait(this->epoll_fd, events, MAX_EPOLL_EVENTS,
+					  timeout_ms);
+	if (num_events < 0) {
+		if (errno == EINTR) {
+			return 0;
+		}
+		throw std::system_error(errno, std::generic_category(), "epoll_wait");
+	}
+
+	for (int i = 0; i < num_events; ++i) {
+		const int fd = events[i].data.fd;
+		if (fd == this->listen_fd) {
+			this->accept_clients();
+		} else {
+			this->handle_client(fd, events[i].events);
+		}
+	}
+
+	return num_events;
+}
+
+void epoll_backend::send(int fd, const message_ptr &msg)
+{
+	const auto it = this->conns.find(fd);
+	if (it == this->conns.end()) {
+		return;
+	}
+
+	auto &c = it->second;
+	c.tx_queue.push_back(msg);
+	c.tx_bytes += msg->size();
+	// The backlog limit is checked by flush() while waiting for EPOLLOUT too
+	if (!c.pending && (!c.epollout || c.tx_bytes > this->max_backlog)) {
+		c.pending = true;
+		this->pending_fds.push_back(fd);
+	}
+}
+
+void epoll_backend::flush()
+{
+	// @note: write() may close a client, the list is swapped to stay valid
+	std::vector<int> fds;
+	fds.swap(this->pending_fds);
+
+	for (const int fd : fds) {
+		const auto it = this->conns.find(fd);
+		if (it == this->conns.end() || !it->second.pending) {
+			continue;
+		}
+		it->second.pending = false;
+		// A client not keeping up is dropped
+		if (!this->write(fd, it->second) ||
+		    it->second.tx_bytes > this->max_backlog) {
+			this->release(fd);
+			this->handler.on_close(fd);
+		}
+	}
+}
+
+bool epoll_backend::add_client(int fd)
+{
+	struct epoll_event ev = {};
+
+	ev.events = EPOLLIN;
+	ev.data.fd = fd;
+	if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		close(fd);
+		return false;
+	}
+	this->conns[fd] = conn();
+
+	return true;
+}
+
+void epoll_backend::close_client(int fd)
+{
+	this->release(fd);
+}
+
+void epoll_backend::accept_clients()
+{
+	while (true) {
+		const int fd = accept4(this->listen_fd, nullptr, nullptr,
+				       SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			// EAGAIN: all pending connections accepted
+			return;
+		}
+
+		if (this->add_client(fd)) {
+			this->handler.on_accept(fd);
+		}
+	}
+}
+
+void epoll_backend::handle_client(int fd, uint32_t events)
+{
+	// The client could be closed while handling a previous event
+	auto it = this->conns.find(fd);
+	if (it == this->conns.end()) {
+		return;
+	}
+
+	if (events & EPOLLOUT) {
+		if (!this->write(fd, it->second)) {
+			this->release(fd);
+			this->handler.on_close(fd);
+			return;
+		}
+	}
+
+	if (!(events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+		return;
+	}
+
+	while (true) {
+		const auto len = recv(fd, this->rx_buffer.data(), this->rx_buffer.size(),
+				      MSG_DONTWAIT);
+		if (len < 0 && errno == EINTR) {
+			continue;
+		}
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		}
+		if (len <= 0) {
+			// Peer closed the connection or socket error
+			this->release(fd);
+			this->handler.on_close(fd);
+			return;
+		}
+
+		this->handler.on_packet(fd, std::span<const uint8_t>(
+						    this->rx_buffer.data(), len));
+		if (this->conns.find(fd) == this->conns.end()) {
+			// Closed by the handler
+			return;
+		}
+	}
+}
+
+bool epoll_backend::write(int fd, conn &c)
+{
+	while (!c.tx_queue.empty()) {
+		const auto &msg = c.tx_queue.front();
+		const auto len = ::send(fd, msg->data(), msg->size(),
+					MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			return false;
+		}
+		c.tx_bytes -= msg->size();
+		c.tx_queue.pop_front();
+	}
+
+	// Wait for the socket to become writable only while there is a backlog
+	const bool want_epollout = !c.tx_queue.empty();
+	if (want_epollout != c.epollout) {
+		uint32_t events = EPOLLIN;
+		if (want_epollout) {
+			events |= EPOLLOUT;
+		}
+		struct epoll_event ev = {};
+		ev.events = events;
+		ev.data.fd = fd;
+		if (epoll_ctl(this->epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+			return false;
+		}
+		c.epollout = want_epollout;
+	}
+
+	return true;
+}
+
+void epoll_backend::release(int fd)
+{
+	if (this->conns.erase(fd) == 0) {
+		return;
+	}
+	epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+	close(fd);
+}
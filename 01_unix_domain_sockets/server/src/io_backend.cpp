@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server transport backends factory
+ */
+
+#include <cstring>
+#include <system_error>
+
+#include <sys/socket.h>
+
+#include <io_backend.hpp>
+#include <epoll_backend.hpp>
+#include <sharded_backend.hpp>
+#ifdef RTM_WITH_IO_URING
+#include <uring_backend.hpp>
+#endif
+
+using namespace RTM;
+
+std::unique_ptr<io_backend> io_backend::create(io_backend_type type,
+					       io_handler &handler,
+					       unsigned num_threads)
+{
+	if (num_threads > 0) {
+		return std::make_unique<sharded_backend>(type, handler, num_threads);
+	}
+
+#ifdef RTM_WITH_IO_URING
+	if (type == io_backend_type::io_uring) {
+		try {
+			return std::make_unique<uring_backend>(handler);
+		} catch (const std::system_error&) {
+			// io_uring is disabled or too old: fall back to epoll
+		}
+	}
+#endif
+	return std::make_unique<epoll_backend>(handler);
+}
+
+bool io_backend::send_fds(int fd, std::span<const uint8_t> msg,
+			  std::span<const int> fds)
+{
+	const size_t fds_size = fds.size() * sizeof(int);
+	std::vector<char> control(CMSG_SPACE(fds_size));
+	struct iovec iov = {const_cast<uint8_t*>(msg.data()), msg.size()};
+	struct msghdr mh = {};
+
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = control.data();
+	mh.msg_controllen = control.size();
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mh);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(fds_size);
+	std::memcpy(CMSG_DATA(cmsg), fds.data(), fds_size);
+
+	// Nothing is queued for the client yet, the socket buffer is empty
+	return sendmsg(fd, &mh, MSG_DONTWAIT | MSG_NOSIGNAL) ==
+	       static_cast<ssize_t>(msg.size());
+}
@@ -2,11 +2,221 @@
  * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
  * SPDX-License-Identifier: Apache-2.0
  * @brief Routig Table Manager (RTM) Server main entry point.
+ *
+ * Usage: rtm_server [-u] [-t threads] [-d dir] [-l file] [socket_path]
+ *	-u	use the io_uring transport backend (falls back to epoll)
+ *	-t	split the clients across a pool of I/O threads
+ *	-d	restore the routing table from and persist it to a directory
+ *	-l	seed the routing table from a text file with one route per line:
+ *		<destination>/<mask> <gateway> <oif>
+ *
+ * The routing table is modified with commands read from the standard input:
+ *	create <destination>/<mask> <gateway> <oif>
+ *	update <destination>/<mask> <gateway> <oif>
+ *	delete <destination>/<mask>
+ *	show
+ *	quit
  */
 
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
 #include <server.hpp>
 
 
+using namespace RTM;
+
+static bool parse_entry(std::istringstream &args, bool with_gateway,
+			routing_table_entry &entry)
+{
+	std::string destination;
+	std::string gateway;
+
+	args >> destination;
+	const auto slash = destination.find('/');
+	if (slash == std::string::npos ||
+	    !routing_table_entry::str2ip(destination.substr(0, slash),
+					 entry.destination_ip)) {
+		return false;
+	}
+	try {
+		const auto mask = std::stoul(destination.substr(slash + 1));
+		if (mask > 32) {
+			return false;
+		}
+		entry.destination_mask = static_cast<uint8_t>(mask);
+	} catch (const std::exception&) {
+		return false;
+	}
+
+	if (!with_gateway) {
+		entry.gateway_ip_u32 = 0;
+		entry.oif.clear();
+		return true;
+	}
+
+	args >> gateway >> entry.oif;
+	return routing_table_entry::str2ip(gateway, entry.gateway_ip) &&
+	       !entry.oif.empty();
+}
+
+/**
+ * @brief Get the fields of an entry differing from the table
+ *
+ * @param table - the routing table
+ * @param entry - the updated entry
+ * @return uint32_t - the changed fields (rtm_field_t bitmask)
+ */
+static uint32_t changed_fields(const routing_table &table,
+			       const routing_table_entry &entry)
+{
+	const auto *stored = table.find(entry.destination_ip_u32);
+	uint32_t fields = 0;
+
+	if (stored == nullptr) {
+		return RTM_FIELD_ALL;
+	}
+	if (stored->gateway_ip_u32 != entry.gateway_ip_u32) {
+		fields |= RTM_FIELD_GATEWAY;
+	}
+	if (stored->destination_mask != entry.destination_mask) {
+		fields |= RTM_FIELD_MASK;
+	}
+	if (stored->oif != entry.oif) {
+		fields |= RTM_FIELD_OIF;
+	}
+
+	return fields;
+}
+
+static bool handle_command(Server &server, const std::string &line)
+{
+	std::istringstream args(line);
+	std::string command;
+	routing_table_entry entry;
+
+	args >> command;
+	if (command.empty()) {
+		return true;
+	} else if (command == "quit") {
+		return false;
+	} else if (command == "show") {
+		server.get_table().dump(STDOUT_FILENO);
+	} else if (command == "create" && parse_entry(args, true, entry)) {
+		server.create_entry(entry);
+	} else if (command == "update" && parse_entry(args, true, entry)) {
+		server.update_entry(entry, changed_fields(server.get_table(), entry));
+	} else if (command == "delete" && parse_entry(args, false, entry)) {
+		server.delete_entry(entry);
+	} else {
+		std::cerr << "Invalid command: " << line << std::endl;
+	}
+
+	return true;
+}
+
 int main(int argc, char *argv[]) {
+	io_backend_type backend = io_backend_type::epoll;
+	unsigned num_threads = 0;
+	std::string store_dir;
+	std::string table_file;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "ut:d:l:")) != -1) {
+		switch (opt) {
+		case 'u':
+			backend = io_backend_type::io_uring;
+			break;
+		case 't':
+			num_threads = std::stoul(optarg);
+			break;
+		case 'd':
+			store_dir = optarg;
+			break;
+		case 'l':
+			table_file = optarg;
+			break;
+		default:
+			std::cerr << "Usage: " << argv[0]
+				  << " [-u] [-t threads] [-d dir] [-l file] [socket_path]"
+				  << std::endl;
+			return 1;
+		}
+	}
+
+	// Writes to disconnected clients shall fail with EPIPE instead
+	signal(SIGPIPE, SIG_IGN);
+
+	Server server(optind < argc ? argv[optind] : RTM_SOCKET_PATH, backend,
+		      num_threads);
+
+	if (!store_dir.empty()) {
+		try {
+			server.open_store(store_dir);
+		} catch (const std::exception &e) {
+			std::cerr << "Failed to open RTM store: " << e.what() << std::endl;
+			return 1;
+		}
+		std::cerr << "Restored " << server.get_table().size()
+			  << " routes from " << store_dir << std::endl;
+	}
+	if (!table_file.empty()) {
+		try {
+			const auto num_routes = server.load_table(table_file);
+			std::cerr << "Loaded " << num_routes << " routes from "
+				  << table_file << std::endl;
+		} catch (const std::exception &e) {
+			std::cerr << "Failed to load " << table_file << ": " << e.what()
+				  << std::endl;
+			return 1;
+		}
+	}
+
+	try {
+		server.start();
+	} catch (const std::exception &e) {
+		std::cerr << "Failed to start RTM server: " << e.what() << std::endl;
+		return 1;
+	}
+	if (backend != server.get_backend_type()) {
+		std::cerr << "io_uring is not available, using epoll" << std::endl;
+	}
+
+	struct pollfd fds[2] = {
+		{STDIN_FILENO, POLLIN, 0},
+		{server.fd(), POLLIN, 0},
+	};
+	std::string input;
+	bool running = true;
+
+	while (running) {
+		if (::poll(fds, 2, -1) < 0) {
+			continue;
+		}
+		if (fds[1].revents & POLLIN) {
+			server.poll(0);
+		}
+		if (fds[0].revents & (POLLIN | POLLHUP)) {
+			char buf[4096];
+			const auto len = read(STDIN_FILENO, buf, sizeof(buf));
+			if (len <= 0) {
+				break;
+			}
+			input.append(buf, len);
+
+			size_t eol;
+			while (running && (eol = input.find('\n')) != std::string::npos) {
+				running = handle_command(server, input.substr(0, eol));
+				input.erase(0, eol + 1);
+			}
+			// All commands of the read chunk form one flush window
+			server.flush();
+		}
+	}
+
 	return 0;
 }
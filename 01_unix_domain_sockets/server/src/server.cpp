@@ -4,6 +4,482 @@
  * @brief Routig Table Manager (RTM) Server implementation
  */
 
+#include <algorithm>
+#include <optional>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
 #include <server.hpp>
 
 using namespace RTM;
+
+Server::Server(const std::string &socket_path, io_backend_type backend,
+	       unsigned num_threads) :
+	socket_path(socket_path), backend_type(backend), num_threads(num_threads),
+	table(&this->table_pool)
+{
+}
+
+Server::~Server()
+{
+	this->stop();
+}
+
+void Server::open_store(const std::string &dir, size_t snapshot_threshold)
+{
+	auto new_store = std::make_unique<rtm_store>(dir, snapshot_threshold);
+
+	this->table.clear();
+	this->table_pages.clear();
+	try {
+		new_store->open(this->table);
+	} catch (...) {
+		this->table.clear();
+		throw;
+	}
+	this->store = std::move(new_store);
+}
+
+size_t Server::load_table(const std::string &path)
+{
+	const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "open " + path);
+	}
+
+	size_t num_entries;
+	try {
+		num_entries = this->table.load_text(fd);
+	} catch (...) {
+		close(fd);
+		throw;
+	}
+	close(fd);
+	this->table_pages.clear();
+
+	if (this->store) {
+		this->store->snapshot(this->table);
+	}
+
+	return num_entries;
+}
+
+void Server::start()
+{
+	struct sockaddr_un addr = {};
+
+	if (this->socket_path.size() >= sizeof(addr.sun_path)) {
+		throw std::invalid_argument("socket path is too long: " +
+					    this->socket_path);
+	}
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, this->socket_path.c_str(),
+		    this->socket_path.size());
+
+	this->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK |
+				 SOCK_CLOEXEC, 0);
+	if (this->listen_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "socket");
+	}
+
+	unlink(this->socket_path.c_str());
+	if (bind(this->listen_fd, reinterpret_cast<struct sockaddr*>(&addr),
+		 sizeof(addr)) < 0) {
+		const auto err = errno;
+		this->stop();
+		throw std::system_error(err, std::generic_category(), "bind");
+	}
+	if (listen(this->listen_fd, SOMAXCONN) < 0) {
+		const auto err = errno;
+		this->stop();
+		throw std::system_error(err, std::generic_category(), "listen");
+	}
+
+	try {
+		this->backend = io_backend::create(this->backend_type, *this,
+						    this->num_threads);
+		this->backend->set_max_backlog(this->max_backlog);
+		this->backend->start(this->listen_fd);
+	} catch (...) {
+		this->stop();
+		throw;
+	}
+}
+
+void Server::stop()
+{
+	// The backend owns the client sockets
+	this->backend.reset();
+	for (const auto &[fd, client] : this->clients) {
+		this->subscriptions.unsubscribe(fd);
+		if (client.event_fd >= 0) {
+			close(client.event_fd);
+		}
+	}
+	this->clients.clear();
+	this->ring.reset();
+	this->free_consumers.clear();
+	this->num_ring_clients = 0;
+	this->woken_head = 0;
+
+	if (this->listen_fd >= 0) {
+		close(this->listen_fd);
+		this->listen_fd = -1;
+		unlink(this->socket_path.c_str());
+	}
+}
+
+int Server::poll(int timeout_ms)
+{
+	this->flush();
+	const int num_events = this->backend->poll(timeout_ms);
+	this->flush();
+
+	return num_events;
+}
+
+void Server::flush()
+{
+	if (this->store) {
+		// Durable before the clients are notified
+		this->store->commit();
+		if (this->store->needs_snapshot()) {
+			this->store->snapshot(this->table);
+		}
+	}
+	this->backend->flush();
+	this->wake_ring_clients();
+}
+
+void Server::create_entry(const routing_table_entry &entry)
+{
+	this->notify(RTM_CREATE, entry);
+}
+
+void Server::update_entry(const routing_table_entry &entry, uint32_t fields)
+{
+	this->notify(RTM_UPDATE, entry, fields);
+}
+
+void Server::delete_entry(const routing_table_entry &entry)
+{
+	this->notify(RTM_DELETE, entry);
+}
+
+void Server::on_accept(int fd)
+{
+	this->clients[fd] = client_conn();
+}
+
+void Server::on_packet(int fd, std::span<const uint8_t> packet)
+{
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	if (!rtm_message::parse(packet, hdr, payload)) {
+		this->drop_client(fd);
+		return;
+	}
+	if (hdr.opcode == RTM_SUBSCRIBE) {
+		this->handle_subscribe(fd, hdr, payload);
+	} else if (hdr.opcode == RTM_RING_ATTACH) {
+		this->handle_ring_attach(fd);
+	} else if (hdr.opcode == RTM_LOOKUP) {
+		this->handle_lookup(fd, hdr, payload);
+	}
+	// Other messages are not expected from clients: ignore them
+}
+
+void Server::on_close(int fd)
+{
+	this->release_client(fd);
+}
+
+void Server::handle_subscribe(int fd, const rtm_msg_hdr &hdr,
+			      std::span<const uint8_t> payload)
+{
+	std::vector<subscription_filter> filters;
+
+	if (subscription_filter::deserialize(payload, filters) != payload.size() ||
+	    filters.size() != hdr.count) {
+		this->drop_client(fd);
+		return;
+	}
+
+	// (Re-)subscription: the client starts over with an empty table
+	auto &client = this->clients[fd];
+	client.whole_table = subscription_filter::matches_all(filters);
+	if (client.ring_consumer >= 0) {
+		// Ring clients filter the ring themselves
+		client.filters = std::move(filters);
+	} else {
+		this->subscriptions.subscribe(fd, filters);
+	}
+	client.subscribed = true;
+	this->send_table(fd);
+}
+
+void Server::handle_ring_attach(int fd)
+{
+	auto &client = this->clients[fd];
+
+	// The ring replaces the socket notifications from the first one on
+	if (client.subscribed || client.ring_consumer >= 0) {
+		this->drop_client(fd);
+		return;
+	}
+
+	if (!this->ring) {
+		try {
+			this->ring = rtm_ring::create();
+			for (uint32_t i = this->ring->max_consumers(); i > 0; --i) {
+				this->free_consumers.push_back(i - 1);
+			}
+		} catch (const std::exception&) {
+			// No shared memory: the clients stay on their sockets
+		}
+	}
+	const int event_fd = this->ring && !this->free_consumers.empty() ?
+			     eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+	if (event_fd < 0) {
+		// RTM_RING without descriptors: the ring is not available
+		std::vector<uint8_t> msg;
+		rtm_message::init(msg, RTM_RING);
+		this->backend->send(fd, std::make_shared<const std::vector<uint8_t>>(
+						std::move(msg)));
+		return;
+	}
+
+	const uint32_t consumer = this->free_consumers.back();
+	const auto msg = rtm_message::make<rtm_ring_info_codec>(RTM_RING, {consumer});
+
+	// Nothing is queued for a client before its subscription
+	const int ring_fds[2] = {this->ring->fd(), event_fd};
+	if (!this->backend->send_fds(fd, msg, ring_fds)) {
+		close(event_fd);
+		this->drop_client(fd);
+		return;
+	}
+
+	this->free_consumers.pop_back();
+	client.ring_consumer = static_cast<int>(consumer);
+	client.event_fd = event_fd;
+	this->num_ring_clients++;
+}
+
+void Server::handle_lookup(int fd, const rtm_msg_hdr &hdr,
+			   std::span<const uint8_t> payload)
+{
+	if (this->table.get_fib() == nullptr) {
+		// Built once, afterwards maintained with each CUD operation
+		this->table.set_aggregation(true);
+	}
+	const rtm_fib &fib = *this->table.get_fib();
+
+	this->lookup_results.clear();
+	this->lookup_next_hops.clear();
+	this->lookup_index.clear();
+
+	rtm_lookup lookup;
+	const bool ok = rtm_message::for_each_address(hdr, payload, lookup,
+		[&](uint32_t addr) {
+			rtm_lookup_result result = {0, 0};
+			const auto *nh = fib.lookup(addr, result.prefix_len);
+			if (nh != nullptr) {
+				// Each next hop is sent once per batch
+				auto [it, inserted] = this->lookup_index.try_emplace(
+					nh, static_cast<uint16_t>(this->lookup_next_hops.size() + 1));
+				if (inserted) {
+					this->lookup_next_hops.push_back(nh);
+				}
+				result.next_hop = it->second;
+			}
+			this->lookup_results.push_back(result);
+		});
+	if (!ok) {
+		this->drop_client(fd);
+		return;
+	}
+
+	std::vector<uint8_t> msg;
+	rtm_message::make_lookup_reply(msg, lookup.id, this->lookup_next_hops,
+				       this->lookup_results);
+	this->backend->send(fd, std::make_shared<const std::vector<uint8_t>>(
+					std::move(msg)));
+}
+
+void Server::send_table(int fd)
+{
+	const auto &client = this->clients[fd];
+	const bool ring_client = client.ring_consumer >= 0;
+	std::vector<uint8_t> msg;
+
+	if (client.whole_table) {
+		// The pre-encoded table state is shared by all such clients
+		for (const auto &page : this->table_pages.get(this->table)) {
+			this->backend->send(fd, page);
+		}
+	} else {
+		rtm_message::init(msg, RTM_CREATE);
+		this->table.for_each([&](const routing_table_entry &entry) {
+			if (ring_client ? !subscription_filter::matches(client.filters, entry) :
+					  !this->subscriptions.matches(fd, entry)) {
+				return;
+			}
+			if (msg.size() + entry.serialized_size() > RTM_MAX_MSG_SIZE) {
+				this->backend->send(fd, std::make_shared<const std::vector<uint8_t>>(
+								std::move(msg)));
+				rtm_message::init(msg, RTM_CREATE);
+			}
+			rtm_message::append_entry(msg, entry);
+		});
+		if (rtm_message::count(msg) > 0) {
+			this->backend->send(fd, std::make_shared<const std::vector<uint8_t>>(
+							std::move(msg)));
+		}
+	}
+
+	if (ring_client) {
+		// The ring client continues with the notifications after the state
+		msg = rtm_message::make<rtm_sync_done_codec>(RTM_SYNC_DONE,
+							     {this->ring->head()});
+	} else {
+		rtm_message::init(msg, RTM_SYNC_DONE);
+	}
+	this->backend->send(fd, std::make_shared<const std::vector<uint8_t>>(
+					std::move(msg)));
+}
+
+void Server::wake_ring_clients()
+{
+	if (!this->ring || this->num_ring_clients == 0 ||
+	    this->ring->head() == this->woken_head) {
+		return;
+	}
+	this->woken_head = this->ring->head();
+
+	for (const auto &[fd, client] : this->clients) {
+		if (client.ring_consumer >= 0 &&
+		    this->ring->take_wakeup(client.ring_consumer)) {
+			eventfd_write(client.event_fd, 1);
+		}
+	}
+}
+
+void Server::notify(cud_opcode_t opcode, const routing_table_entry &entry,
+		    uint32_t fields)
+{
+	// Subscribers of the entry before and after the operation:
+	auto &old_recipients = this->old_recipients;
+	std::optional<routing_table_entry> old_entry;
+
+	old_recipients.clear();
+	if (const auto *stored = this->table.find(entry.destination_ip_u32)) {
+		old_entry = *stored;
+		this->subscriptions.match(*old_entry, old_recipients);
+	} else if (opcode != RTM_CREATE) {
+		// Nothing to update or delete
+		return;
+	}
+	this->table_pages.invalidate(entry.destination_ip_u32);
+
+	// The entry after the operation (the deleted one for RTM_DELETE)
+	const routing_table_entry *current = &entry;
+	if (opcode == RTM_DELETE) {
+		this->table.delete_entry(*old_entry);
+		this->recipients.clear();
+		current = &*old_entry;
+	} else if (opcode == RTM_UPDATE) {
+		this->table.update_entry(entry, fields);
+		current = this->table.find(entry.destination_ip_u32);
+		this->subscriptions.match(*current, this->recipients);
+	} else {
+		// @note: create of an existing entry replaces it
+		this->table.create_entry(entry);
+		this->subscriptions.match(entry, this->recipients);
+	}
+	if (this->store) {
+		this->store->append(opcode, *current, fields);
+	}
+
+	message_ptr msg_new;     // opcode with the entry or the update delta
+	message_ptr msg_create;  // entry moved into the client filters
+	message_ptr msg_delete;  // entry moved out of the client filters
+
+	auto new_message = [&]() -> message_ptr& {
+		if (!msg_new) {
+			msg_new = std::make_shared<const std::vector<uint8_t>>(
+				opcode == RTM_UPDATE ?
+				rtm_message::make_update(*current, fields) :
+				rtm_message::make(opcode, *current));
+		}
+		return msg_new;
+	};
+
+	// Written once for all ring clients, they apply their filters themselves
+	if (this->ring && this->num_ring_clients > 0) {
+		if (opcode == RTM_UPDATE && (fields & (RTM_FIELD_MASK | RTM_FIELD_OIF))) {
+			// The filters of a ring client need the whole entry to
+			// decide if it moves into or out of them
+			this->ring->publish(rtm_message::make_update(*current, RTM_FIELD_ALL));
+		} else {
+			this->ring->publish(*new_message());
+		}
+	}
+
+	// Each message is built once and shared by all of its recipients
+	auto send_to = [this](uint32_t fd, message_ptr &msg, cud_opcode_t op,
+			      const routing_table_entry &e) {
+		if (!msg) {
+			msg = std::make_shared<const std::vector<uint8_t>>(
+				rtm_message::make(op, e));
+		}
+		this->backend->send(fd, msg);
+	};
+
+	for (const auto fd : this->recipients) {
+		const bool had_entry = std::binary_search(old_recipients.begin(),
+							  old_recipients.end(), fd);
+		if (had_entry || opcode == RTM_CREATE) {
+			this->backend->send(fd, new_message());
+		} else {
+			send_to(fd, msg_create, RTM_CREATE, *current);
+		}
+	}
+	for (const auto fd : old_recipients) {
+		if (!std::binary_search(this->recipients.begin(),
+					this->recipients.end(), fd)) {
+			send_to(fd, msg_delete, RTM_DELETE, *old_entry);
+		}
+	}
+}
+
+void Server::drop_client(int fd)
+{
+	this->release_client(fd);
+	this->backend->close_client(fd);
+}
+
+void Server::release_client(int fd)
+{
+	const auto it = this->clients.find(fd);
+
+	this->subscriptions.unsubscribe(fd);
+	if (it == this->clients.end()) {
+		return;
+	}
+	if (it->second.ring_consumer >= 0) {
+		// Clear a pending wakeup request for the next consumer of the slot
+		this->ring->take_wakeup(it->second.ring_consumer);
+		this->free_consumers.push_back(it->second.ring_consumer);
+		this->num_ring_clients--;
+		close(it->second.event_fd);
+	}
+	this->clients.erase(it);
+}
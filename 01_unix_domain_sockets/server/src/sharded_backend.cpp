@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server multithreaded transport backend
+ * implementation
+ */
+
+#include <bit>
+#include <climits>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <sharded_backend.hpp>
+
+using namespace RTM;
+
+sharded_backend::sharded_backend(io_backend_type type, io_handler &handler,
+				 unsigned num_threads) :
+	handler(handler), id_shift(std::bit_width(num_threads - 1))
+{
+	this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (this->epoll_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_create1");
+	}
+	this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->event_fd < 0) {
+		const auto err = errno;
+		close(this->epoll_fd);
+		throw std::system_error(err, std::generic_category(), "eventfd");
+	}
+
+	try {
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = this->event_fd;
+		if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->event_fd, &ev) < 0) {
+			throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+		}
+		for (unsigned i = 0; i < num_threads; ++i) {
+			this->shards.push_back(std::make_unique<shard>(type, this->event_fd));
+		}
+	} catch (...) {
+		this->shards.clear();
+		close(this->event_fd);
+		close(this->epoll_fd);
+		throw;
+	}
+}
+
+sharded_backend::~sharded_backend()
+{
+	for (auto &s : this->shards) {
+		s->stop();
+	}
+	this->shards.clear();
+	close(this->event_fd);
+	close(this->epoll_fd);
+}
+
+io_backend_type sharded_backend::type() const
+{
+	return this->shards.front()->backend_type;
+}
+
+void sharded_backend::start(int listen_fd)
+{
+	struct epoll_event ev = {};
+
+	ev.events = EPOLLIN;
+	ev.data.fd = listen_fd;
+	if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+		throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+	}
+	this->listen_fd = listen_fd;
+
+	for (auto &s : this->shards) {
+		s->start();
+	}
+}
+
+int sharded_backend::poll(int timeout_ms)
+{
+	struct epoll_event events[2];
+
+	const int num_ready = epoll_wait(this->epoll_fd, events, 2, timeout_ms);
+	int num_events = 0;
+	for (int i = 0; i < num_ready; ++i) {
+		if (events[i].data.fd == this->listen_fd) {
+			this->accept_clients();
+			num_events++;
+		} else {
+			eventfd_t value;
+			eventfd_read(this->event_fd, &value);
+		}
+	}
+
+	event ev;
+	for (auto &s : this->shards) {
+		while (s->events.pop(ev)) {
+			switch (ev.kind) {
+			case event::PACKET:
+				this->handler.on_packet(ev.id, ev.packet);
+				break;
+			case event::CLOSE:
+				this->handler.on_close(ev.id);
+				break;
+			}
+			num_events++;
+		}
+	}
+
+	return num_events;
+}
+
+void sharded_backend::send(int fd, const message_ptr &msg)
+{
+	auto &s = this->shard_of(fd);
+
+	s.commands.push({command::SEND, fd, msg, {}});
+	s.pending = true;
+}
+
+bool sharded_backend::send_fds(int fd, std::span<const uint8_t> msg,
+			       std::span<const int> fds)
+{
+	command cmd = {command::SEND_FDS, fd,
+		       std::make_shared<const std::vector<uint8_t>>(msg.begin(), msg.end()),
+		       {}};
+
+	// The caller may close its descriptors before the shard sends them
+	for (const int passed_fd : fds) {
+		const int dup_fd = fcntl(passed_fd, F_DUPFD_CLOEXEC, 0);
+		if (dup_fd < 0) {
+			for (const int d : cmd.fds) {
+				close(d);
+			}
+			return false;
+		}
+		cmd.fds.push_back(dup_fd);
+	}
+
+	auto &s = this->shard_of(fd);
+	s.commands.push(std::move(cmd));
+	s.pending = true;
+
+	return true;
+}
+
+void sharded_backend::flush()
+{
+	// One wakeup per shard and flush window
+	for (auto &s : this->shards) {
+		if (s->pending) {
+			s->pending = false;
+			s->wakeup();
+		}
+	}
+}
+
+bool sharded_backend::add_client(int fd)
+{
+	// Round-robin over the shards, the id encodes the shard index
+	const unsigned index = this->next_id % this->shards.size();
+	const uint32_t seq = (this->next_id++ / this->shards.size()) &
+			     (INT_MAX >> this->id_shift);
+	const int id = static_cast<int>((seq << this->id_shift) | index);
+	auto &s = *this->shards[index];
+
+	s.commands.push({command::ADD, id, nullptr, {fd}});
+	s.pending = true;
+	this->handler.on_accept(id);
+
+	return true;
+}
+
+void sharded_backend::close_client(int fd)
+{
+	auto &s = this->shard_of(fd);
+
+	s.commands.push({command::CLOSE, fd, nullptr, {}});
+	s.pending = true;
+}
+
+void sharded_backend::set_max_backlog(size_t bytes)
+{
+	// The shard threads are not running yet
+	for (auto &s : this->shards) {
+		s->set_max_backlog(bytes);
+	}
+}
+
+sharded_backend::shard& sharded_backend::shard_of(int id)
+{
+	const unsigned index = static_cast<unsigned>(id) & ((1u << this->id_shift) - 1);
+
+	return *this->shards.at(index);
+}
+
+void sharded_backend::accept_clients()
+{
+	while (true) {
+		const int fd = accept4(this->listen_fd, nullptr, nullptr,
+				       SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			// EAGAIN: all pending connections accepted
+			return;
+		}
+		this->add_client(fd);
+	}
+}
+
+sharded_backend::shard::shard(io_backend_type type, int event_fd) :
+	server_event_fd(event_fd)
+{
+	this->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->wakeup_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "eventfd");
+	}
+	try {
+		this->backend = io_backend::create(type, *this);
+	} catch (...) {
+		close(this->wakeup_fd);
+		throw;
+	}
+	this->backend_type = this->backend->type();
+}
+
+sharded_backend::shard::~shard()
+{
+	this->stop();
+	// Releases the client sockets
+	this->backend.reset();
+	close(this->wakeup_fd);
+}
+
+void sharded_backend::shard::start()
+{
+	this->thread = std::thread(&shard::run, this);
+}
+
+void sharded_backend::shard::stop()
+{
+	if (this->thread.joinable()) {
+		this->commands.push({command::STOP, -1, nullptr, {}});
+		this->wakeup();
+		this->thread.join();
+	}
+}
+
+void sharded_backend::shard::set_max_backlog(size_t bytes)
+{
+	this->backend->set_max_backlog(bytes);
+}
+
+void sharded_backend::shard::wakeup()
+{
+	eventfd_write(this->wakeup_fd, 1);
+}
+
+void sharded_backend::shard::run()
+{
+	struct pollfd pfds[2] = {
+		{this->backend->fd(), POLLIN, 0},
+		{this->wakeup_fd, POLLIN, 0},
+	};
+	bool running = true;
+
+	while (running) {
+		if (::poll(pfds, 2, -1) < 0) {
+			continue;
+		}
+		if (pfds[1].revents & POLLIN) {
+			eventfd_t value;
+			eventfd_read(this->wakeup_fd, &value);
+		}
+
+		command cmd;
+		while (running && this->commands.pop(cmd)) {
+			running = this->execute(cmd);
+		}
+		this->backend->poll(0);
+		this->backend->flush();
+
+		// One wakeup of the server thread per loop iteration
+		if (this->posted) {
+			this->posted = false;
+			eventfd_write(this->server_event_fd, 1);
+		}
+	}
+}
+
+bool sharded_backend::shard::execute(command &cmd)
+{
+	if (cmd.kind == command::STOP) {
+		return false;
+	}
+
+	if (cmd.kind == command::ADD) {
+		const int fd = cmd.fds.front();
+		if (this->backend->add_client(fd)) {
+			this->id_to_fd[cmd.id] = fd;
+			this->fd_to_id[fd] = cmd.id;
+		} else {
+			this->post({event::CLOSE, cmd.id, {}});
+		}
+		return true;
+	}
+
+	const auto it = this->id_to_fd.find(cmd.id);
+	if (it == this->id_to_fd.end()) {
+		// The client closed meanwhile
+		for (const int fd : cmd.fds) {
+			close(fd);
+		}
+		return true;
+	}
+	const int fd = it->second;
+
+	switch (cmd.kind) {
+	case command::SEND:
+		this->backend->send(fd, cmd.msg);
+		break;
+	case command::SEND_FDS: {
+		const bool sent = this->backend->send_fds(fd, *cmd.msg, cmd.fds);
+		for (const int passed_fd : cmd.fds) {
+			close(passed_fd);
+		}
+		if (!sent) {
+			this->backend->close_client(fd);
+			this->on_close(fd);
+		}
+		break;
+	}
+	case command::CLOSE:
+		this->fd_to_id.erase(fd);
+		this->id_to_fd.erase(it);
+		this->backend->close_client(fd);
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+void sharded_backend::shard::on_accept(int fd)
+{
+	// The shard backends do not listen, clients are added by the server thread
+	this->backend->close_client(fd);
+}
+
+void sharded_backend::shard::on_packet(int fd, std::span<const uint8_t> packet)
+{
+	const auto it = this->fd_to_id.find(fd);
+	if (it != this->fd_to_id.end()) {
+		this->post({event::PACKET, it->second,
+			    std::vector<uint8_t>(packet.begin(), packet.end())});
+	}
+}
+
+void sharded_backend::shard::on_close(int fd)
+{
+	const auto it = this->fd_to_id.find(fd);
+	if (it == this->fd_to_id.end()) {
+		return;
+	}
+	const int id = it->second;
+
+	this->id_to_fd.erase(id);
+	this->fd_to_id.erase(it);
+	this->post({event::CLOSE, id, {}});
+}
+
+void sharded_backend::shard::post(event &&ev)
+{
+	this->events.push(std::move(ev));
+	this->posted = true;
+}
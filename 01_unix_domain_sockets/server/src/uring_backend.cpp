@@ -0,0 +1,664 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server io_uring transport backend implementation
+ *
+ * @note The ring is driven by the raw io_uring syscalls, no liburing is needed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <uring_backend.hpp>
+#include <rtm_message.hpp>
+
+using namespace RTM;
+
+static constexpr size_t SLOT_SIZE = 4096;        // registered buffer slot size
+static constexpr size_t NUM_SLOTS = 1024;        // registered buffer slots
+static constexpr unsigned MAX_FILES = 65536;     // fixed file table size
+static constexpr size_t MAX_LINKED_SENDS = 64;   // sends per client and window
+
+#ifndef IORING_RECVSEND_FIXED_BUF
+// Headers older than the kernel, see probe_fixed_send()
+#define IORING_RECVSEND_FIXED_BUF (1U << 2)
+#endif
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+			  unsigned flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+					min_complete, flags, nullptr, 0));
+}
+
+static int io_uring_register(int fd, unsigned opcode, const void *arg,
+			     unsigned nr_args)
+{
+	return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg,
+					nr_args));
+}
+
+uring_backend::uring_backend(io_handler &handler, unsigned entries) :
+	handler(handler)
+{
+	struct io_uring_params p = {};
+
+	p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+	p.cq_entries = entries * 4;
+	this->ring_fd = io_uring_setup(entries, &p);
+	if (this->ring_fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+	}
+
+	try {
+		this->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		this->cq_ring_size = p.cq_off.cqes +
+				     p.cq_entries * sizeof(struct io_uring_cqe);
+		if (p.features & IORING_FEAT_SINGLE_MMAP) {
+			this->sq_ring_size = this->cq_ring_size =
+				std::max(this->sq_ring_size, this->cq_ring_size);
+		}
+
+		this->sq_ring = mmap(nullptr, this->sq_ring_size,
+				     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				     this->ring_fd, IORING_OFF_SQ_RING);
+		if (this->sq_ring == MAP_FAILED) {
+			this->sq_ring = nullptr;
+			throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+		if (p.features & IORING_FEAT_SINGLE_MMAP) {
+			this->cq_ring = this->sq_ring;
+		} else {
+			this->cq_ring = mmap(nullptr, this->cq_ring_size,
+					     PROT_READ | PROT_WRITE,
+					     MAP_SHARED | MAP_POPULATE,
+					     this->ring_fd, IORING_OFF_CQ_RING);
+			if (this->cq_ring == MAP_FAILED) {
+				this->cq_ring = nullptr;
+				throw std::system_error(errno, std::generic_category(),
+							"mmap");
+			}
+		}
+		this->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+		void *sqes_mem = mmap(nullptr, this->sqes_size, PROT_READ | PROT_WRITE,
+				      MAP_SHARED | MAP_POPULATE, this->ring_fd,
+				      IORING_OFF_SQES);
+		if (sqes_mem == MAP_FAILED) {
+			throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+		this->sqes = static_cast<struct io_uring_sqe*>(sqes_mem);
+
+		auto *sq = static_cast<uint8_t*>(this->sq_ring);
+		auto *cq = static_cast<uint8_t*>(this->cq_ring);
+		this->sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+		this->sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+		this->sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+		this->sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+		this->sq_entries = p.sq_entries;
+		this->sq_local_tail = *this->sq_tail;
+		this->cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+		this->cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+		this->cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+		this->cqes = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+		this->cq_entries = p.cq_entries;
+
+		// Sparse fixed file table, client sockets are placed at index fd
+		struct rlimit rlim = {};
+		getrlimit(RLIMIT_NOFILE, &rlim);
+		this->num_files = static_cast<unsigned>(
+			std::min<rlim_t>(rlim.rlim_cur, MAX_FILES));
+		struct io_uring_rsrc_register files = {};
+		files.nr = this->num_files;
+		files.flags = IORING_RSRC_REGISTER_SPARSE;
+		if (io_uring_register(this->ring_fd, IORING_REGISTER_FILES2, &files,
+				      sizeof(files)) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"IORING_REGISTER_FILES2");
+		}
+
+		// Registered buffer pool messages are staged into
+		this->pool_size = SLOT_SIZE * NUM_SLOTS;
+		void *pool_mem = mmap(nullptr, this->pool_size, PROT_READ | PROT_WRITE,
+				      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pool_mem == MAP_FAILED) {
+			throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+		this->pool = static_cast<uint8_t*>(pool_mem);
+		const struct iovec iov = {this->pool, this->pool_size};
+		if (io_uring_register(this->ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"IORING_REGISTER_BUFFERS");
+		}
+		this->slot_refs.assign(NUM_SLOTS, 0);
+		this->slot_msgs.assign(NUM_SLOTS, nullptr);
+		for (size_t i = NUM_SLOTS; i > 0; --i) {
+			this->free_slots.push_back(static_cast<int>(i - 1));
+		}
+		this->fixed_send = this->probe_fixed_send();
+	} catch (...) {
+		this->unmap();
+		throw;
+	}
+}
+
+uring_backend::~uring_backend()
+{
+	// Cancel all requests and wait for them, they may still reference
+	// message memory
+	this->listen_fd = -1;
+	if (this->num_inflight > 0) {
+		auto *sqe = this->get_sqe();
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+		sqe->user_data = this->alloc_op(op_kind::cancel, -1);
+		this->submit(0);
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() +
+			      std::chrono::seconds(1);
+	while (this->num_inflight > 0 &&
+	       std::chrono::steady_clock::now() < deadline) {
+		struct pollfd pfd = {this->ring_fd, POLLIN, 0};
+		::poll(&pfd, 1, 10);
+		unsigned head = *this->cq_head;
+		while (head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+			const auto cqe = this->cqes[head & *this->cq_mask];
+			__atomic_store_n(this->cq_head, ++head, __ATOMIC_RELEASE);
+			if (!(cqe.flags & IORING_CQE_F_MORE)) {
+				this->ops[cqe.user_data].msg.reset();
+				this->num_inflight--;
+			}
+		}
+	}
+
+	for (const auto &[fd, c] : this->conns) {
+		close(fd);
+	}
+	this->unmap();
+}
+
+bool uring_backend::probe_fixed_send()
+{
+	// A send from the registered buffers over a socket pair, older kernels
+	// reject the flag with EINVAL
+	int sv[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+		return false;
+	}
+
+	auto *sqe = this->get_sqe();
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = sv[0];
+	sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+	sqe->buf_index = 0;
+	sqe->addr = reinterpret_cast<uint64_t>(this->pool);
+	sqe->len = 1;
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = 0;
+	this->submit(1);
+
+	int res = -EINVAL;
+	unsigned head = *this->cq_head;
+	if (head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+		res = this->cqes[head & *this->cq_mask].res;
+		__atomic_store_n(this->cq_head, ++head, __ATOMIC_RELEASE);
+	}
+	close(sv[0]);
+	close(sv[1]);
+
+	return res == 1;
+}
+
+void uring_backend::unmap()
+{
+	if (this->ring_fd >= 0) {
+		close(this->ring_fd);
+		this->ring_fd = -1;
+	}
+	if (this->pool) {
+		munmap(this->pool, this->pool_size);
+		this->pool = nullptr;
+	}
+	if (this->sqes) {
+		munmap(this->sqes, this->sqes_size);
+		this->sqes = nullptr;
+	}
+	if (this->cq_ring && this->cq_ring != this->sq_ring) {
+		munmap(this->cq_ring, this->cq_ring_size);
+	}
+	this->cq_ring = nullptr;
+	if (this->sq_ring) {
+		munmap(this->sq_ring, this->sq_ring_size);
+		this->sq_ring = nullptr;
+	}
+}
+
+void uring_backend::start(int listen_fd)
+{
+	this->listen_fd = listen_fd;
+	this->arm_accept();
+	this->submit(0);
+}
+
+int uring_backend::poll(int timeout_ms)
+{
+	int num_events = 0;
+
+	if (this->to_submit > 0) {
+		this->submit(0);
+	}
+	if (timeout_ms != 0 &&
+	    *this->cq_head == __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+		struct pollfd pfd = {this->ring_fd, POLLIN, 0};
+		if (::poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR) {
+			throw std::system_error(errno, std::generic_category(), "poll");
+		}
+	}
+
+	// Completions may submit new requests which complete right away
+	unsigned head = *this->cq_head;
+	while (head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+		const auto cqe = this->cqes[head & *this->cq_mask];
+		__atomic_store_n(this->cq_head, ++head, __ATOMIC_RELEASE);
+		this->complete(cqe);
+		num_events++;
+	}
+
+	if (this->to_submit > 0) {
+		this->submit(0);
+	}
+
+	return num_events;
+}
+
+void uring_backend::send(int fd, const message_ptr &msg)
+{
+	const auto it = this->conns.find(fd);
+	if (it == this->conns.end() || it->second.closing) {
+		return;
+	}
+
+	auto &c = it->second;
+	c.tx_queue.push_back(msg);
+	c.tx_bytes += msg->size();
+	if (!c.pending) {
+		c.pending = true;
+		this->pending_fds.push_back(fd);
+	}
+}
+
+void uring_backend::flush()
+{
+	std::vector<int> fds;
+	fds.swap(this->pending_fds);
+
+	for (const int fd : fds) {
+		const auto it = this->conns.find(fd);
+		if (it == this->conns.end() || !it->second.pending) {
+			continue;
+		}
+		auto &c = it->second;
+		if (c.closing) {
+			c.pending = false;
+			continue;
+		}
+		// A new chain is started once the previous one completed, linked
+		// requests of different submissions are not ordered
+		if (c.num_sends > 0) {
+			c.pending = false;
+			this->check_backlog(fd, c);
+			continue;
+		}
+		// Each request completes with at least one CQE, requests are not
+		// submitted beyond the completion queue size
+		if (this->num_inflight + MAX_LINKED_SENDS > this->cq_entries / 2) {
+			this->pending_fds.push_back(fd);
+			continue;
+		}
+		c.pending = false;
+		this->submit_sends(fd, c);
+		this->check_backlog(fd, c);
+	}
+
+	if (this->to_submit > 0) {
+		this->submit(0);
+	}
+}
+
+void uring_backend::close_client(int fd)
+{
+	const auto it = this->conns.find(fd);
+	if (it != this->conns.end()) {
+		this->shutdown(fd, it->second, false);
+	}
+}
+
+struct io_uring_sqe *uring_backend::get_sqe()
+{
+	if (this->sq_local_tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE) >=
+	    this->sq_entries) {
+		this->submit(0);
+	}
+	if (this->sq_local_tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE) >=
+	    this->sq_entries) {
+		throw std::system_error(EBUSY, std::generic_category(),
+					"io_uring submission queue is full");
+	}
+
+	const unsigned idx = this->sq_local_tail & *this->sq_mask;
+	this->sq_array[idx] = idx;
+	this->sq_local_tail++;
+	this->to_submit++;
+
+	auto *sqe = &this->sqes[idx];
+	std::memset(sqe, 0, sizeof(*sqe));
+
+	return sqe;
+}
+
+void uring_backend::submit(unsigned min_complete)
+{
+	__atomic_store_n(this->sq_tail, this->sq_local_tail, __ATOMIC_RELEASE);
+
+	while (this->to_submit > 0 || min_complete > 0) {
+		const int ret = io_uring_enter(this->ring_fd, this->to_submit,
+					       min_complete,
+					       min_complete ? IORING_ENTER_GETEVENTS : 0);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EBUSY) {
+				// Out of resources or completions to reap first: the
+				// remaining entries are submitted by the next poll()
+				break;
+			}
+			throw std::system_error(errno, std::generic_category(),
+						"io_uring_enter");
+		}
+		this->to_submit -= std::min<unsigned>(ret, this->to_submit);
+		min_complete = 0;
+	}
+}
+
+uint32_t uring_backend::alloc_op(op_kind kind, int fd, message_ptr msg, int slot)
+{
+	uint32_t idx;
+
+	if (this->free_ops.empty()) {
+		idx = static_cast<uint32_t>(this->ops.size());
+		this->ops.push_back({kind, fd, std::move(msg), slot});
+	} else {
+		idx = this->free_ops.back();
+		this->free_ops.pop_back();
+		this->ops[idx] = {kind, fd, std::move(msg), slot};
+	}
+	this->num_inflight++;
+
+	return idx;
+}
+
+void uring_backend::arm_accept()
+{
+	auto *sqe = this->get_sqe();
+
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = this->listen_fd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->accept_flags = SOCK_CLOEXEC;
+	sqe->user_data = this->alloc_op(op_kind::accept, this->listen_fd);
+}
+
+void uring_backend::arm_recv(int fd, conn &c)
+{
+	auto *sqe = this->get_sqe();
+
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->flags = IOSQE_FIXED_FILE;
+	sqe->addr = reinterpret_cast<uint64_t>(c.rx_buffer.data());
+	sqe->len = static_cast<uint32_t>(c.rx_buffer.size());
+	sqe->user_data = this->alloc_op(op_kind::recv, fd);
+	c.num_ops++;
+}
+
+void uring_backend::submit_sends(int fd, conn &c)
+{
+	const size_t num_sends = std::min(c.tx_queue.size(), MAX_LINKED_SENDS);
+
+	// A chain shall not be split across two submissions
+	if (this->sq_entries - (this->sq_local_tail -
+				__atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE)) <
+	    num_sends) {
+		this->submit(0);
+	}
+
+	for (size_t i = 0; i < num_sends; ++i) {
+		auto msg = std::move(c.tx_queue.front());
+		c.tx_queue.pop_front();
+		c.tx_bytes -= msg->size();
+
+		const int slot = this->stage(msg);
+		auto *sqe = this->get_sqe();
+		sqe->fd = fd;
+		sqe->flags = IOSQE_FIXED_FILE;
+		if (i + 1 < num_sends) {
+			sqe->flags |= IOSQE_IO_LINK;
+		}
+		sqe->len = static_cast<uint32_t>(msg->size());
+		sqe->opcode = IORING_OP_SEND;
+		sqe->msg_flags = MSG_NOSIGNAL;
+		if (slot >= 0) {
+			sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+			sqe->buf_index = 0;
+			sqe->addr = reinterpret_cast<uint64_t>(this->pool + slot * SLOT_SIZE);
+		} else {
+			sqe->addr = reinterpret_cast<uint64_t>(msg->data());
+		}
+		sqe->user_data = this->alloc_op(op_kind::send, fd, std::move(msg), slot);
+		c.num_ops++;
+		c.num_sends++;
+	}
+}
+
+void uring_backend::check_backlog(int fd, conn &c)
+{
+	// A client not keeping up is dropped
+	if (c.tx_bytes > this->max_backlog) {
+		this->shutdown(fd, c, true);
+	}
+}
+
+int uring_backend::stage(const message_ptr &msg)
+{
+	if (!this->fixed_send || msg->size() > SLOT_SIZE) {
+		return -1;
+	}
+
+	// Messages shared by many clients are copied only once
+	const auto it = this->staged.find(msg.get());
+	if (it != this->staged.end()) {
+		this->slot_refs[it->second]++;
+		return it->second;
+	}
+
+	if (this->free_slots.empty()) {
+		return -1;
+	}
+	const int slot = this->free_slots.back();
+	this->free_slots.pop_back();
+	std::memcpy(this->pool + slot * SLOT_SIZE, msg->data(), msg->size());
+	this->slot_refs[slot] = 1;
+	this->slot_msgs[slot] = msg.get();
+	this->staged[msg.get()] = slot;
+
+	return slot;
+}
+
+void uring_backend::release_slot(int slot)
+{
+	if (slot < 0 || --this->slot_refs[slot] > 0) {
+		return;
+	}
+	this->staged.erase(this->slot_msgs[slot]);
+	this->slot_msgs[slot] = nullptr;
+	this->free_slots.push_back(slot);
+}
+
+void uring_backend::complete(const struct io_uring_cqe &cqe)
+{
+	auto &o = this->ops[cqe.user_data];
+	const op_kind kind = o.kind;
+	const int fd = o.fd;
+
+	if (kind == op_kind::send) {
+		this->release_slot(o.slot);
+		o.msg.reset();
+	}
+	// A multishot request stays armed while IORING_CQE_F_MORE is set
+	if (!(cqe.flags & IORING_CQE_F_MORE)) {
+		this->free_ops.push_back(static_cast<uint32_t>(cqe.user_data));
+		this->num_inflight--;
+	}
+
+	if (kind == op_kind::cancel) {
+		return;
+	}
+	if (kind == op_kind::accept) {
+		if (cqe.res >= 0) {
+			this->accepted(cqe.res);
+		}
+		if (!(cqe.flags & IORING_CQE_F_MORE) && this->listen_fd >= 0) {
+			this->arm_accept();
+		}
+		return;
+	}
+
+	const auto it = this->conns.find(fd);
+	if (it == this->conns.end()) {
+		return;
+	}
+	auto &c = it->second;
+	c.num_ops--;
+	if (kind == op_kind::send) {
+		c.num_sends--;
+	}
+
+	if (c.closing) {
+		if (c.num_ops == 0) {
+			this->finalize(fd);
+		}
+		return;
+	}
+	if (cqe.res < 0 || (kind == op_kind::recv && cqe.res == 0)) {
+		// Peer closed the connection or socket error
+		this->shutdown(fd, c, true);
+		return;
+	}
+
+	if (kind == op_kind::send) {
+		if (c.num_sends == 0 && !c.tx_queue.empty() && !c.pending) {
+			c.pending = true;
+			this->pending_fds.push_back(fd);
+		}
+		return;
+	}
+
+	this->handler.on_packet(fd, std::span<const uint8_t>(c.rx_buffer.data(),
+							     cqe.res));
+	// The handler may have closed the client
+	const auto again = this->conns.find(fd);
+	if (again != this->conns.end() && !again->second.closing) {
+		this->arm_recv(fd, again->second);
+	}
+}
+
+void uring_backend::accepted(int fd)
+{
+	if (this->add_client(fd)) {
+		this->handler.on_accept(fd);
+	}
+}
+
+bool uring_backend::add_client(int fd)
+{
+	if (static_cast<unsigned>(fd) >= this->num_files) {
+		close(fd);
+		return false;
+	}
+
+	struct io_uring_files_update update = {};
+	update.offset = static_cast<uint32_t>(fd);
+	update.fds = reinterpret_cast<uint64_t>(&fd);
+	if (io_uring_register(this->ring_fd, IORING_REGISTER_FILES_UPDATE,
+			      &update, 1) < 0) {
+		close(fd);
+		return false;
+	}
+
+	auto &c = this->conns[fd];
+	c = conn();
+	c.rx_buffer.resize(RTM_MAX_MSG_SIZE);
+	this->arm_recv(fd, c);
+
+	return true;
+}
+
+void uring_backend::shutdown(int fd, conn &c, bool notify)
+{
+	if (c.closing) {
+		return;
+	}
+	c.closing = true;
+	c.notify = notify;
+	c.tx_queue.clear();
+	c.tx_bytes = 0;
+
+	if (c.num_ops == 0) {
+		this->finalize(fd);
+		return;
+	}
+
+	auto *sqe = this->get_sqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = fd;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_FD_FIXED |
+			    IORING_ASYNC_CANCEL_ALL;
+	sqe->user_data = this->alloc_op(op_kind::cancel, fd);
+}
+
+void uring_backend::finalize(int fd)
+{
+	const auto it = this->conns.find(fd);
+	const bool notify = it->second.notify;
+
+	int unused = -1;
+	struct io_uring_files_update update = {};
+	update.offset = static_cast<uint32_t>(fd);
+	update.fds = reinterpret_cast<uint64_t>(&unused);
+	io_uring_register(this->ring_fd, IORING_REGISTER_FILES_UPDATE, &update, 1);
+
+	close(fd);
+	this->conns.erase(it);
+
+	if (notify) {
+		this->handler.on_close(fd);
+	}
+}
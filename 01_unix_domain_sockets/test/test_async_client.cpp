@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) asynchronous client Unit-Tests
+ */
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <async_client.hpp>
+#include <server.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+static task<void> follow(AsyncClient &client, size_t num_updates,
+			 std::vector<AsyncClient::update> &updates)
+{
+	co_await client.connect();
+	co_await client.synchronized();
+	while (updates.size() < num_updates) {
+		updates.push_back(co_await client.next_update());
+	}
+}
+
+class async_client_test : public ::testing::Test {
+public:
+	std::string path;
+	Server server;
+	reactor r;
+	AsyncClient client;
+	std::vector<AsyncClient::update> updates;
+
+	async_client_test() :
+		path("/tmp/rtm_async_client_test_" + std::to_string(getpid()) + ".sock"),
+		server(path), client(r, path)
+	{
+	}
+protected:
+	void SetUp() override
+	{
+		server.start();
+		for (uint32_t i = 0; i < 100; ++i) {
+			server.create_entry(make_entry(make_key(10, 0, 0, i), 32, "eth0", i));
+		}
+	}
+	void TearDown() override
+	{
+		unlink(path.c_str());
+	}
+
+	/**
+	 * @brief Run the server and the reactor until a condition holds
+	 *
+	 * @return true if the condition holds, false on timeout
+	 */
+	bool pump(const std::function<bool()> &done)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+				      std::chrono::seconds(10);
+
+		while (!done()) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			server.poll(0);
+			r.poll(1);
+		}
+		return true;
+	}
+};
+
+
+TEST_F(async_client_test, one_wakeup_per_burst)
+{
+	r.spawn(follow(client, 100, updates));
+	ASSERT_TRUE(pump([this] { return client.get_client().synchronized(); }));
+	EXPECT_EQ(client.get_client().get_table(), server.get_table());
+	EXPECT_TRUE(updates.empty());
+
+	// Ten messages arrive before the reactor polls again
+	const auto wakeups = client.num_wakeups();
+	for (uint32_t i = 0; i < 100; ++i) {
+		server.create_entry(make_entry(make_key(10, 1, 0, i), 32, "eth1", i));
+		if (i % 10 == 9) {
+			server.flush();
+		}
+	}
+	EXPECT_EQ(r.poll(1000), 1);
+	EXPECT_EQ(client.num_wakeups(), wakeups + 1);
+	EXPECT_EQ(r.num_tasks(), 0);
+
+	ASSERT_EQ(updates.size(), 100);
+	for (uint32_t i = 0; i < 100; ++i) {
+		EXPECT_EQ(updates[i].opcode, RTM_CREATE);
+		EXPECT_EQ(updates[i].entry.gateway_ip_u32, i);
+	}
+	EXPECT_EQ(client.get_client().get_table(), server.get_table());
+}
+
+TEST_F(async_client_test, connection_closed)
+{
+	r.spawn(follow(client, 1000, updates));
+	ASSERT_TRUE(pump([this] { return client.get_client().synchronized(); }));
+
+	// The awaiting task fails, its exception is rethrown by poll()
+	server.stop();
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	EXPECT_THROW({
+		while (std::chrono::steady_clock::now() < deadline) {
+			r.poll(1);
+		}
+	}, std::system_error);
+	EXPECT_EQ(r.num_tasks(), 0);
+	EXPECT_FALSE(client.get_client().connected());
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) client receive pipeline Unit-Tests
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <client_pipeline.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+class client_pipeline_test : public ::testing::Test {
+public:
+	int server_fd = -1;  // the peer writing the messages
+	int client_fd = -1;  // the connection read by the pipeline
+	std::unique_ptr<client_pipeline> pipeline;
+	std::vector<client_pipeline::change> changes;
+	bool closed = false;
+protected:
+	void SetUp() override
+	{
+		int sv[2];
+
+		ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv), 0);
+		server_fd = sv[0];
+		client_fd = sv[1];
+	}
+	void TearDown() override
+	{
+		pipeline.reset();
+		if (server_fd >= 0) {
+			close(server_fd);
+		}
+		close(client_fd);
+	}
+
+	void send_message(const std::vector<uint8_t> &msg)
+	{
+		ASSERT_EQ(send(server_fd, msg.data(), msg.size(), MSG_NOSIGNAL),
+			  static_cast<ssize_t>(msg.size()));
+	}
+
+	void send_create(uint32_t i)
+	{
+		send_message(rtm_message::make(RTM_CREATE,
+					       make_entry(make_key(10, 0, i >> 8, i), 32,
+							  "eth0", i)));
+	}
+
+	/**
+	 * @brief Apply the decoded batches until the connection closed or the
+	 * number of changes was received
+	 *
+	 * @return true if the condition holds, false on timeout
+	 */
+	bool receive(size_t num_changes)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+				      std::chrono::seconds(10);
+
+		while (!closed && changes.size() < num_changes) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			struct pollfd pfd = {pipeline->fd(), POLLIN, 0};
+			if (::poll(&pfd, 1, 10) <= 0) {
+				continue;
+			}
+			eventfd_t value;
+			eventfd_read(pipeline->fd(), &value);
+
+			while (auto *b = pipeline->pop()) {
+				changes.insert(changes.end(), b->changes.begin(), b->changes.end());
+				closed = closed || b->closed;
+				pipeline->recycle(b);
+			}
+		}
+		return true;
+	}
+};
+
+
+TEST_F(client_pipeline_test, batch_ordering)
+{
+	// More messages than all batch buffers of a stage hold together
+	const uint32_t num_messages = 20 * client_pipeline::NUM_BATCHES *
+				      client_pipeline::RX_BATCH_PACKETS;
+
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	std::thread writer([this, num_messages] {
+		for (uint32_t i = 0; i < num_messages; ++i) {
+			send_create(i);
+		}
+		send_message(rtm_message::make(RTM_DELETE, make_entry(make_key(10, 0, 0, 0), 32)));
+	});
+	ASSERT_TRUE(receive(num_messages + 1));
+	writer.join();
+
+	EXPECT_FALSE(closed);
+	ASSERT_EQ(changes.size(), num_messages + 1);
+	for (uint32_t i = 0; i < num_messages; ++i) {
+		EXPECT_EQ(changes[i].opcode, RTM_CREATE);
+		EXPECT_EQ(changes[i].entry.gateway_ip_u32, i);
+	}
+	EXPECT_EQ(changes.back().opcode, RTM_DELETE);
+}
+
+TEST_F(client_pipeline_test, malformed_message)
+{
+	const std::vector<uint8_t> garbage = {1, 2, 3};
+
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	send_create(1);
+	send_message(garbage);
+	send_create(2);
+	ASSERT_TRUE(receive(3));
+
+	// The connection ends at the malformed message
+	EXPECT_TRUE(closed);
+	ASSERT_EQ(changes.size(), 1);
+	EXPECT_EQ(changes[0].entry.gateway_ip_u32, 1);
+}
+
+TEST_F(client_pipeline_test, truncated_message)
+{
+	// A valid header with a payload larger than RTM_MAX_MSG_SIZE
+	std::vector<uint8_t> oversized;
+	rtm_message::init(oversized, RTM_SYNC_DONE);
+	oversized.resize(RTM_MAX_MSG_SIZE + 1024);
+
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	send_create(1);
+	send_message(oversized);
+	ASSERT_TRUE(receive(3));
+
+	EXPECT_TRUE(closed);
+	ASSERT_EQ(changes.size(), 1);
+	EXPECT_EQ(changes[0].opcode, RTM_CREATE);
+}
+
+TEST_F(client_pipeline_test, peer_closes_with_batches_in_flight)
+{
+	// More messages than the batch buffers of both stages hold together
+	const uint32_t num_messages = 3 * client_pipeline::NUM_BATCHES *
+				      client_pipeline::RX_BATCH_PACKETS;
+
+	// All messages are queued before the pipeline runs, the close follows
+	// them while the batches are still being received and decoded
+	for (uint32_t i = 0; i < num_messages; ++i) {
+		send_create(i);
+	}
+	close(server_fd);
+	server_fd = -1;
+
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	ASSERT_TRUE(receive(num_messages + 1));
+
+	EXPECT_TRUE(closed);
+	ASSERT_EQ(changes.size(), num_messages);
+	for (uint32_t i = 0; i < num_messages; ++i) {
+		EXPECT_EQ(changes[i].entry.gateway_ip_u32, i);
+	}
+}
+
+TEST_F(client_pipeline_test, stop_in_recvmmsg)
+{
+	// No data: the receive thread waits in recvmmsg()
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	pipeline.reset();
+
+	// The connection stays open for the client
+	const std::vector<uint8_t> msg = {0};
+	EXPECT_EQ(send(client_fd, msg.data(), msg.size(), MSG_NOSIGNAL), 1);
+}
+
+TEST_F(client_pipeline_test, stop_in_eventfd_read)
+{
+	// No batch is applied: the decode thread waits for a free batch and the
+	// receive thread for a free buffer, both in eventfd_read()
+	for (uint32_t i = 0; i < 3 * client_pipeline::NUM_BATCHES *
+			       client_pipeline::RX_BATCH_PACKETS; ++i) {
+		send_create(i);
+	}
+	pipeline = std::make_unique<client_pipeline>(client_fd);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	pipeline.reset();
+}
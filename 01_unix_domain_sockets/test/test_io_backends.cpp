@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) Server transport backends Unit-Tests
+ */
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <client.hpp>
+#include <server.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+struct backend_config {
+	io_backend_type type;
+	unsigned num_threads;
+};
+
+static std::string config_name(const ::testing::TestParamInfo<backend_config> &info)
+{
+	const std::string type = info.param.type == io_backend_type::epoll ? "epoll"
+									 : "io_uring";
+
+	return type + "_" + std::to_string(info.param.num_threads) + "_threads";
+}
+
+class io_backend_test : public ::testing::TestWithParam<backend_config> {
+public:
+	std::string path;
+	std::unique_ptr<Server> server;
+	std::vector<std::unique_ptr<Client>> clients;
+protected:
+	void SetUp() override
+	{
+		path = "/tmp/rtm_backend_test_" + std::to_string(getpid()) + ".sock";
+		server = std::make_unique<Server>(path, GetParam().type,
+						  GetParam().num_threads);
+	}
+	void TearDown() override
+	{
+		clients.clear();
+		server.reset();
+		unlink(path.c_str());
+	}
+
+	Client& connect()
+	{
+		clients.push_back(std::make_unique<Client>(path));
+		clients.back()->connect();
+		return *clients.back();
+	}
+
+	/**
+	 * @brief Run the server and the clients until a condition holds
+	 *
+	 * @return true if the condition holds, false on timeout
+	 */
+	bool pump(const std::function<bool()> &done)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+				      std::chrono::seconds(10);
+
+		while (!done()) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			server->poll(1);
+			for (auto &client : clients) {
+				while (client->connected() && client->try_receive()) {
+				}
+			}
+		}
+		return true;
+	}
+
+	bool in_sync()
+	{
+		return pump([this] {
+			for (const auto &client : clients) {
+				if (!client->synchronized() ||
+				    client->get_table() != server->get_table()) {
+					return false;
+				}
+			}
+			return true;
+		});
+	}
+};
+
+
+TEST_P(io_backend_test, sync_and_notify)
+{
+	server->start();
+	if (server->get_backend_type() != GetParam().type) {
+		GTEST_SKIP() << "io_uring is not available";
+	}
+
+	for (uint32_t i = 0; i < 500; ++i) {
+		server->create_entry(make_entry(make_key(10, 0, i >> 8, i), 32, "eth0", i));
+	}
+	// More clients than shards, the ids of all shards are in use
+	for (int i = 0; i < 7; ++i) {
+		connect();
+	}
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 7; }));
+	ASSERT_TRUE(in_sync());
+
+	for (uint32_t i = 0; i < 2000; ++i) {
+		server->create_entry(make_entry(make_key(10, 1, i >> 8, i), 32, "eth1", i));
+	}
+	for (uint32_t i = 0; i < 500; i += 2) {
+		server->delete_entry(make_entry(make_key(10, 0, i >> 8, i), 32));
+	}
+	auto delta = make_entry(make_key(10, 1, 0, 7), 32, "eth2", 42);
+	server->update_entry(delta, RTM_FIELD_GATEWAY | RTM_FIELD_OIF);
+	ASSERT_TRUE(in_sync());
+	EXPECT_EQ(server->get_table().size(), 2250);
+
+	// The remaining clients are still served once others left
+	clients.erase(clients.begin(), clients.begin() + 3);
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 4; }));
+	server->create_entry(make_entry(make_key(10, 2, 0, 0), 16, "eth3"));
+	ASSERT_TRUE(in_sync());
+
+	connect();
+	ASSERT_TRUE(in_sync());
+	EXPECT_EQ(server->num_clients(), 5);
+}
+
+TEST_P(io_backend_test, client_closes_during_sends)
+{
+	server->start();
+	auto &reader = connect();
+	connect();
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 2; }));
+	ASSERT_TRUE(in_sync());
+
+	// The second client leaves with notifications queued and in flight, a
+	// send to its socket shall not raise SIGPIPE
+	uint32_t i = 0;
+	for (; i < 3000; ++i) {
+		server->create_entry(make_entry(make_key(10, 3, i >> 8, i), 32, "eth0", i));
+		if (i % 100 == 99) {
+			server->flush();
+		}
+	}
+	clients.pop_back();
+	for (; i < 6000; ++i) {
+		server->create_entry(make_entry(make_key(10, 3, i >> 8, i), 32, "eth0", i));
+		if (i % 100 == 99) {
+			server->poll(0);
+		}
+	}
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 1; }));
+	ASSERT_TRUE(in_sync());
+	EXPECT_TRUE(reader.connected());
+}
+
+TEST_P(io_backend_test, backlog_limit)
+{
+	server->set_max_backlog(64 << 10);
+	server->start();
+	auto &reader = connect();
+	// Not pumped, the client does not read its notifications
+	Client stalled(path);
+	stalled.connect();
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 2; }));
+
+	// The server drops the stalled client once its backlog exceeds the limit
+	for (uint32_t i = 0; i < 100'000 && server->num_clients() == 2; ++i) {
+		server->create_entry(make_entry(make_key(10, 4, i >> 8, i), 32, "eth0", i));
+		// The reader keeps up with the server
+		if (i % 100 == 99) {
+			ASSERT_TRUE(pump([this, &reader] {
+				return reader.get_table().size() == server->get_table().size();
+			}));
+		}
+	}
+	ASSERT_TRUE(pump([this] { return server->num_clients() == 1; }));
+	ASSERT_TRUE(in_sync());
+	EXPECT_TRUE(reader.connected());
+}
+
+INSTANTIATE_TEST_SUITE_P(backends, io_backend_test,
+			 ::testing::Values(backend_config{io_backend_type::epoll, 0},
+					   backend_config{io_backend_type::io_uring, 0},
+					   backend_config{io_backend_type::epoll, 1},
+					   backend_config{io_backend_type::epoll, 3},
+					   backend_config{io_backend_type::io_uring, 3}),
+			 config_name);
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Manager (RTM) coroutine task and reactor Unit-Tests
+ */
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <reactor.hpp>
+#include <task.hpp>
+
+
+using namespace RTM;
+
+
+static task<int> count_down(int n)
+{
+	if (n == 0) {
+		co_return 0;
+	}
+	co_return 1 + co_await count_down(n - 1);
+}
+
+static task<int> fail(int n)
+{
+	if (n == 0) {
+		throw std::runtime_error("failed");
+	}
+	co_return co_await fail(n - 1);
+}
+
+static task<int> catch_failure()
+{
+	try {
+		co_await fail(3);
+	} catch (const std::runtime_error&) {
+		co_return -1;
+	}
+	co_return 0;
+}
+
+/**
+ * @brief Count the wakeups of a source until stopped
+ */
+static task<void> count_wakeups(reactor::source &src, int &wakeups, const bool &stop)
+{
+	while (!stop) {
+		co_await src;
+		wakeups++;
+	}
+}
+
+static task<void> throw_now()
+{
+	throw std::runtime_error("started");
+	co_return;
+}
+
+static task<void> throw_on_wakeup(reactor::source &src)
+{
+	co_await src;
+	throw std::runtime_error("woken up");
+}
+
+class reactor_test : public ::testing::Test {
+public:
+	reactor r;
+	int efd = -1;
+	reactor::source src;
+protected:
+	void SetUp() override
+	{
+		efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		ASSERT_GE(efd, 0);
+		r.add(efd, src);
+	}
+	void TearDown() override
+	{
+		r.remove(efd);
+		close(efd);
+	}
+
+	void signal()
+	{
+		eventfd_write(efd, 1);
+	}
+
+	void drain()
+	{
+		eventfd_t value;
+		eventfd_read(efd, &value);
+	}
+};
+
+
+TEST(task_test, symmetric_transfer)
+{
+	reactor r;
+
+	// Each level resumes the next one by symmetric transfer, a nested
+	// resume per level would overflow the stack. GCC emits the transfer as a
+	// tail call only in optimized builds.
+#ifdef __OPTIMIZE__
+	const int depth = 1'000'000;
+#else
+	const int depth = 1'000;
+#endif
+	EXPECT_EQ(r.run(count_down(depth)), depth);
+}
+
+TEST(task_test, exception)
+{
+	reactor r;
+
+	// The exception passes the awaiting tasks up to the first handler
+	EXPECT_EQ(r.run(catch_failure()), -1);
+	EXPECT_THROW(r.run(fail(3)), std::runtime_error);
+}
+
+TEST_F(reactor_test, nested_wait)
+{
+	// The awaiting task is resumed once the awaited one completed later
+	const auto outer = [](reactor::source &src) -> task<int> {
+		co_return 1 + co_await [](reactor::source &s) -> task<int> {
+			co_await s;
+			co_return 41;
+		}(src);
+	};
+	auto t = outer(src);
+
+	t.start();
+	EXPECT_FALSE(t.done());
+	signal();
+	EXPECT_EQ(r.poll(0), 1);
+	ASSERT_TRUE(t.done());
+	EXPECT_EQ(t.result(), 42);
+}
+
+TEST_F(reactor_test, signaled_before_wait)
+{
+	int wakeups = 0;
+	bool stop = false;
+
+	// No one waits yet, the source keeps the signal
+	signal();
+	EXPECT_EQ(r.poll(0), 1);
+	drain();
+
+	r.spawn(count_wakeups(src, wakeups, stop));
+	EXPECT_EQ(wakeups, 1);
+	EXPECT_EQ(r.poll(0), 0);
+	EXPECT_EQ(wakeups, 1);
+
+	stop = true;
+	signal();
+	r.run();
+	EXPECT_EQ(wakeups, 2);
+	EXPECT_EQ(r.num_tasks(), 0);
+}
+
+TEST_F(reactor_test, one_wakeup_per_burst)
+{
+	int wakeups = 0;
+	bool stop = false;
+
+	r.spawn(count_wakeups(src, wakeups, stop));
+	EXPECT_EQ(wakeups, 0);
+
+	// Edge-triggered: a burst before the poll resumes the task once
+	for (int i = 0; i < 10; ++i) {
+		signal();
+	}
+	EXPECT_EQ(r.poll(0), 1);
+	EXPECT_EQ(wakeups, 1);
+	EXPECT_EQ(r.poll(0), 0);
+	EXPECT_EQ(wakeups, 1);
+
+	// New data after the wakeup is signaled again
+	drain();
+	signal();
+	EXPECT_EQ(r.poll(0), 1);
+	EXPECT_EQ(wakeups, 2);
+
+	stop = true;
+	drain();
+	signal();
+	r.run();
+	EXPECT_EQ(r.num_tasks(), 0);
+}
+
+TEST_F(reactor_test, task_exception)
+{
+	// Thrown before the first suspension, rethrown by spawn()
+	EXPECT_THROW(r.spawn(throw_now()), std::runtime_error);
+	EXPECT_EQ(r.num_tasks(), 0);
+
+	// Thrown after a wakeup, rethrown by poll() once the task was released
+	r.spawn(throw_on_wakeup(src));
+	EXPECT_EQ(r.num_tasks(), 1);
+	signal();
+	EXPECT_THROW(r.poll(0), std::runtime_error);
+	EXPECT_EQ(r.num_tasks(), 0);
+}
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Multibit trie with compressed nodes for longest prefix matches over
+ * IPv4 or IPv6 addresses.
+ *
+ * A binary trie (see prefix_trie.hpp) needs one memory access per address
+ * bit, up to 128 for IPv6. The multibit trie consumes the address in strides
+ * instead:
+ *
+ * - the first 16 bits index a direct array of 65536 slots
+ * - every further 8 bits index a node of 256 expanded slots, each one either
+ * a child node or the value of the longest prefix covering it (leaf)
+ *
+ * so a lookup takes 1 + (prefix length - 16) / 8 steps: 3 for any IPv4
+ * address, 5 for an IPv6 route of the usual /48. The nodes are compressed
+ * like in Poptrie: a node holds two 256 bit maps instead of 256 slots, the
+ * children of a node are stored next to each other and found by the number of
+ * child bits before the slot (popcount), the leaves are stored once per run
+ * of equal slots.
+ *
+ * The prefixes and their values are kept in an ordered map, the compressed
+ * nodes refer to its values. A change of the prefixes marks the direct slots
+ * it covers, the next lookup rebuilds the nodes of these slots only from the
+ * prefixes inside of them. The direct array (1.5 MB) is allocated by the
+ * first lookup of a trie holding prefixes, a trie never looked up takes the
+ * memory of its prefixes only.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <rtm_address.hpp>
+
+namespace RTM {
+
+/**
+ * @brief Multibit trie mapping prefixes to values
+ *
+ * @tparam T - the value type stored per prefix
+ * @tparam Family - the address family (see rtm_address.hpp)
+ * @note Prefixes are given in host order, bits beyond the prefix length are
+ * ignored. The first lookup() after a change is not thread-safe.
+ */
+template <typename T, typename Family = inet4>
+class multibit_trie {
+public:
+	using address = typename Family::address;
+
+	static constexpr uint8_t DIRECT_BITS = 16;  // bits of the direct array
+	static constexpr uint8_t STRIDE = 8;        // bits of each node
+
+	static_assert((Family::bits - DIRECT_BITS) % STRIDE == 0);
+
+	multibit_trie() {};
+	~multibit_trie() {};
+
+	// The nodes refer to the values of the copied prefixes, a copy builds
+	// its own ones on its first lookup
+	multibit_trie(const multibit_trie &other) :
+		prefixes(other.prefixes)
+	{
+	}
+
+	multibit_trie& operator=(const multibit_trie &other)
+	{
+		if (this != &other) {
+			this->prefixes = other.prefixes;
+			this->release_slots();
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Get the value of a prefix, create a default one if missing
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return T& - the reference to the value of the prefix
+	 * @note The value keeps its address until the prefix is erased.
+	 */
+	T& insert(address prefix, uint8_t len)
+	{
+		const auto [it, inserted] = this->prefixes.try_emplace(
+			key(prefix & Family::mask(len), len));
+		if (inserted) {
+			this->invalidate(prefix, len);
+		}
+		return it->second;
+	}
+
+	/**
+	 * @brief Find the value of a prefix
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return T* - the value or nullptr if the prefix is not in the trie
+	 */
+	T* find(address prefix, uint8_t len)
+	{
+		const auto it = this->prefixes.find(key(prefix & Family::mask(len), len));
+		return it != this->prefixes.end() ? &it->second : nullptr;
+	}
+
+	/**
+	 * @brief Remove the value of a prefix
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return true if the prefix was removed, false if it was not found
+	 */
+	bool erase(address prefix, uint8_t len)
+	{
+		if (this->prefixes.erase(key(prefix & Family::mask(len), len)) == 0) {
+			return false;
+		}
+		this->invalidate(prefix, len);
+		return true;
+	}
+
+	/**
+	 * @brief Find the value of the longest prefix covering an address
+	 *
+	 * @param addr - the address in host order
+	 * @return const T* - the value or nullptr if no prefix covers the address
+	 */
+	const T* lookup(address addr) const
+	{
+		if (this->slots.empty()) {
+			if (this->prefixes.empty()) {
+				return nullptr;
+			}
+			this->allocate_slots();
+		}
+		if (!this->dirty.empty()) {
+			this->rebuild();
+		}
+
+		const auto &s = this->slots[static_cast<size_t>(
+			addr >> (Family::bits - DIRECT_BITS))];
+		if (!s.tree) {
+			return s.value;
+		}
+
+		const subtree &t = *s.tree;
+		const node *n = t.nodes.data();
+		for (unsigned shift = Family::bits - DIRECT_BITS - STRIDE;; shift -= STRIDE) {
+			const unsigned i = static_cast<unsigned>(addr >> shift) & 0xff;
+			if (!test(n->child_bits, i)) {
+				return t.leaves[n->leaves + rank(n->leaf_bits, i + 1) - 1];
+			}
+			n = &t.nodes[n->children + rank(n->child_bits, i)];
+		}
+	}
+
+	/**
+	 * @brief Remove all prefixes from the trie
+	 *
+	 */
+	void clear()
+	{
+		this->prefixes.clear();
+		this->release_slots();
+	}
+
+	/**
+	 * @brief Get the number of prefixes holding a value
+	 *
+	 * @return size_t - the number of prefixes in the trie
+	 */
+	size_t size() const
+	{
+		return this->prefixes.size();
+	}
+
+	/**
+	 * @brief Check if the trie holds no prefixes
+	 *
+	 * @return true if the trie is empty, false otherwise
+	 */
+	bool empty() const
+	{
+		return this->prefixes.empty();
+	}
+
+	/**
+	 * @brief Get the memory taken by the compressed nodes
+	 *
+	 * @return size_t - the size in bytes of the direct array, the nodes and
+	 * the leaves, as of the last lookup(), 0 before the first one
+	 */
+	size_t memory_usage() const
+	{
+		size_t size = this->slots.size() * sizeof(slot);
+		for (const auto &s : this->slots) {
+			if (s.tree) {
+				size += sizeof(subtree) + s.tree->nodes.size() * sizeof(node) +
+					s.tree->leaves.size() * sizeof(const T*);
+			}
+		}
+		return size;
+	}
+
+private:
+	// Prefixes ordered by address first, so the prefixes inside of an
+	// address range are adjacent
+	using key = std::pair<address, uint8_t>;
+	using prefix_iterator = typename std::map<key, T>::const_iterator;
+
+	struct node {
+		uint64_t child_bits[4];  // the slot is a child node
+		uint64_t leaf_bits[4];   // a run of equal leaves starts at the slot
+		uint32_t children;       // index of the first child node
+		uint32_t leaves;         // index of the first leaf
+	};
+
+	// The nodes below a direct slot, the first one is the root
+	struct subtree {
+		std::vector<node> nodes;
+		std::vector<const T*> leaves;
+	};
+
+	struct slot {
+		const T *value = nullptr;       // leaf of a slot without nodes
+		std::unique_ptr<subtree> tree;
+		bool dirty = false;
+	};
+
+	static bool test(const uint64_t (&bits)[4], unsigned i)
+	{
+		return (bits[i / 64] >> (i % 64)) & 1u;
+	}
+
+	/**
+	 * @brief Count the bits set before a slot
+	 */
+	static unsigned rank(const uint64_t (&bits)[4], unsigned i)
+	{
+		unsigned n = 0;
+		for (unsigned w = 0; w < i / 64; ++w) {
+			n += std::popcount(bits[w]);
+		}
+		return i % 64 ? n + std::popcount(bits[i / 64] << (64 - i % 64)) : n;
+	}
+
+	void allocate_slots() const
+	{
+		this->slots.resize(size_t(1) << DIRECT_BITS);
+		for (const auto &[k, value] : this->prefixes) {
+			this->invalidate(k.first, k.second);
+		}
+	}
+
+	void release_slots()
+	{
+		std::vector<slot>().swap(this->slots);
+		std::vector<uint32_t>().swap(this->dirty);
+	}
+
+	void invalidate(address prefix, uint8_t len) const
+	{
+		if (this->slots.empty()) {
+			// Built from all prefixes by the first lookup
+			return;
+		}
+
+		const size_t first = static_cast<size_t>(
+			(prefix & Family::mask(len)) >> (Family::bits - DIRECT_BITS));
+		const size_t count = len >= DIRECT_BITS ?
+			1 : size_t(1) << (DIRECT_BITS - len);
+
+		for (size_t i = first; i < first + count; ++i) {
+			if (!this->slots[i].dirty) {
+				this->slots[i].dirty = true;
+				this->dirty.push_back(static_cast<uint32_t>(i));
+			}
+		}
+	}
+
+	void rebuild() const
+	{
+		for (const uint32_t i : this->dirty) {
+			this->build_slot(i);
+		}
+		this->dirty.clear();
+	}
+
+	void build_slot(uint32_t index) const
+	{
+		constexpr unsigned shift = Family::bits - DIRECT_BITS;
+		const address base = static_cast<address>(index) << shift;
+		auto &s = this->slots[index];
+
+		// The longest prefix of up to DIRECT_BITS covering the slot
+		s.value = nullptr;
+		for (int len = DIRECT_BITS; len >= 0 && !s.value; --len) {
+			const auto it = this->prefixes.find(key(base & Family::mask(len), len));
+			if (it != this->prefixes.end()) {
+				s.value = &it->second;
+			}
+		}
+
+		// The longer prefixes inside of the slot
+		const auto first = this->prefixes.lower_bound(key(base, DIRECT_BITS + 1));
+		const auto last = index + 1 < this->slots.size() ?
+			this->prefixes.lower_bound(key(base + (address(1) << shift), 0)) :
+			this->prefixes.end();
+
+		s.dirty = false;
+		s.tree.reset();
+		if (first != last) {
+			s.tree = std::make_unique<subtree>();
+			s.tree->nodes.resize(1);
+			build_node(*s.tree, 0, DIRECT_BITS, first, last, s.value);
+		}
+	}
+
+	/**
+	 * @brief Build a node and its children
+	 *
+	 * @param t - the subtree to add the nodes and leaves to
+	 * @param index - the index of the node in the subtree
+	 * @param depth - the number of address bits above the node
+	 * @param first - the first prefix inside of the node, longer than depth
+	 * @param last - the end of the prefixes inside of the node
+	 * @param value - the value of the longest prefix covering the node
+	 */
+	static void build_node(subtree &t, uint32_t index, unsigned depth,
+			       prefix_iterator first, prefix_iterator last, const T *value)
+	{
+		constexpr unsigned num_slots = 1u << STRIDE;
+		const unsigned shift = Family::bits - depth - STRIDE;
+		std::vector<const T*> values(num_slots, value);
+		std::vector<std::pair<prefix_iterator, prefix_iterator>> children(num_slots,
+										  {last, last});
+		std::vector<prefix_iterator> leaves;
+
+		// Expand the prefixes ending in the node, shorter ones first so the
+		// longest prefix covering a slot wins
+		for (auto it = first; it != last; ++it) {
+			const auto [prefix, len] = it->first;
+			const unsigned i = static_cast<unsigned>(prefix >> shift) & (num_slots - 1);
+			if (len > depth + STRIDE) {
+				// Prefixes of a slot are adjacent
+				if (children[i].first == last) {
+					children[i].first = it;
+				}
+				children[i].second = std::next(it);
+			} else {
+				leaves.push_back(it);
+			}
+		}
+		std::stable_sort(leaves.begin(), leaves.end(),
+				 [](prefix_iterator a, prefix_iterator b) {
+					 return a->first.second < b->first.second;
+				 });
+		for (const auto it : leaves) {
+			const auto [prefix, len] = it->first;
+			const unsigned i = static_cast<unsigned>(prefix >> shift) & (num_slots - 1);
+			std::fill_n(values.begin() + i, 1u << (depth + STRIDE - len), &it->second);
+		}
+
+		// The children are stored next to each other, the leaves once per run
+		node n = {};
+		uint32_t num_children = 0;
+		bool first_leaf = true;
+
+		n.children = static_cast<uint32_t>(t.nodes.size());
+		n.leaves = static_cast<uint32_t>(t.leaves.size());
+		for (unsigned i = 0; i < num_slots; ++i) {
+			if (children[i].first != last) {
+				n.child_bits[i / 64] |= uint64_t(1) << (i % 64);
+				num_children++;
+			} else if (first_leaf || values[i] != t.leaves.back()) {
+				n.leaf_bits[i / 64] |= uint64_t(1) << (i % 64);
+				t.leaves.push_back(values[i]);
+				first_leaf = false;
+			}
+		}
+		t.nodes.resize(t.nodes.size() + num_children);
+		t.nodes[index] = n;
+
+		uint32_t child = n.children;
+		for (unsigned i = 0; i < num_slots; ++i) {
+			if (children[i].first != last) {
+				build_node(t, child++, depth + STRIDE, children[i].first,
+					   children[i].second, values[i]);
+			}
+		}
+	}
+
+	std::map<key, T> prefixes;         // the prefixes and their values
+	mutable std::vector<slot> slots;   // the direct array, empty before the
+					   // first lookup
+	mutable std::vector<uint32_t> dirty;  // slots to rebuild before a lookup
+};
+
+}  // namespace RTM
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Binary (unibit) trie over IPv4 or IPv6 prefixes.
+ *
+ * Each node represents a prefix; the node depth is the prefix length. Values
+ * are attached to nodes, so a walk along the bits of an address visits all
+ * prefixes covering this address from the shortest to the longest one.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <rtm_address.hpp>
+
+namespace RTM {
+
+/**
+ * @brief Binary trie mapping prefixes to values
+ *
+ * @tparam T - the value type stored per prefix
+ * @tparam Family - the address family (see rtm_address.hpp)
+ * @note Prefixes are given in host order (see routing_table_entry::ip2host),
+ * bits beyond the prefix length are ignored.
+ */
+template <typename T, typename Family = inet4>
+class prefix_trie {
+public:
+	using address = typename Family::address;
+
+	prefix_trie() : root(std::make_unique<node>()) {};
+	~prefix_trie() {};
+
+	prefix_trie(const prefix_trie& other) :
+		root(clone(*other.root)), num_values(other.num_values)
+	{
+	}
+
+	prefix_trie& operator=(const prefix_trie& other)
+	{
+		if (this != &other) {
+			this->root = clone(*other.root);
+			this->num_values = other.num_values;
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Get the value of a prefix, create a default one if missing
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return T& - the reference to the value of the prefix
+	 */
+	T& insert(address prefix, uint8_t len)
+	{
+		node *n = this->root.get();
+		for (uint8_t depth = 0; depth < len; ++depth) {
+			auto &child = n->child[bit(prefix, depth)];
+			if (!child) {
+				child = std::make_unique<node>();
+			}
+			n = child.get();
+		}
+		if (!n->value) {
+			n->value.emplace();
+			this->num_values++;
+		}
+		return *n->value;
+	}
+
+	/**
+	 * @brief Find the value of a prefix
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return T* - the value or nullptr if the prefix is not in the trie
+	 */
+	T* find(address prefix, uint8_t len) const
+	{
+		node *n = this->root.get();
+		for (uint8_t depth = 0; n && depth < len; ++depth) {
+			n = n->child[bit(prefix, depth)].get();
+		}
+		return (n && n->value) ? &*n->value : nullptr;
+	}
+
+	/**
+	 * @brief Remove the value of a prefix and prune empty nodes
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return true if the prefix was removed, false if it was not found
+	 */
+	bool erase(address prefix, uint8_t len)
+	{
+		const bool erased = erase(this->root, prefix, len, 0);
+		if (erased) {
+			this->num_values--;
+		}
+		return erased;
+	}
+
+	/**
+	 * @brief Visit all prefixes covering an address, shortest first
+	 *
+	 * @param addr - the address in host order
+	 * @param max_len - do not visit prefixes longer than this length
+	 * @param func - called as func(len, value) for each covering prefix
+	 */
+	template <typename Func>
+	void for_each_match(address addr, uint8_t max_len, Func&& func) const
+	{
+		const node *n = this->root.get();
+		for (uint8_t depth = 0; n; ++depth) {
+			if (n->value) {
+				func(depth, *n->value);
+			}
+			if (depth >= max_len || depth >= Family::bits) {
+				break;
+			}
+			n = n->child[bit(addr, depth)].get();
+		}
+	}
+
+	/**
+	 * @brief Remove all prefixes from the trie
+	 *
+	 */
+	void clear()
+	{
+		this->root = std::make_unique<node>();
+		this->num_values = 0;
+	}
+
+	/**
+	 * @brief Get the number of prefixes holding a value
+	 *
+	 * @return size_t - the number of prefixes in the trie
+	 */
+	size_t size() const
+	{
+		return this->num_values;
+	}
+
+	/**
+	 * @brief Check if the trie holds no prefixes
+	 *
+	 * @return true if the trie is empty, false otherwise
+	 */
+	bool empty() const
+	{
+		return this->num_values == 0;
+	}
+
+private:
+	struct node {
+		std::unique_ptr<node> child[2];
+		std::optional<T> value;
+	};
+
+	static unsigned bit(address prefix, uint8_t depth)
+	{
+		return static_cast<unsigned>(prefix >> (Family::bits - 1 - depth)) & 1u;
+	}
+
+	static std::unique_ptr<node> clone(const node &n)
+	{
+		auto copy = std::make_unique<node>();
+		copy->value = n.value;
+		for (unsigned i = 0; i < 2; ++i) {
+			if (n.child[i]) {
+				copy->child[i] = clone(*n.child[i]);
+			}
+		}
+		return copy;
+	}
+
+	static bool erase(std::unique_ptr<node> &n, address prefix, uint8_t len,
+			  uint8_t depth)
+	{
+		if (!n) {
+			return false;
+		}
+		bool erased = false;
+		if (depth == len) {
+			erased = n->value.has_value();
+			n->value.reset();
+		} else {
+			erased = erase(n->child[bit(prefix, depth)], prefix, len,
+				       depth + 1);
+		}
+		// Keep the root node, prune all other nodes without content
+		if (depth != 0 && !n->value && !n->child[0] && !n->child[1]) {
+			n.reset();
+		}
+		return erased;
+	}
+
+	std::unique_ptr<node> root;
+	size_t num_values = 0;
+};
+
+}  // namespace RTM
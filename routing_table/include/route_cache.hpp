@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) route cache.
+ *
+ * Direct-mapped cache of routing_table::lookup() results in front of a
+ * routing table. Each slot holds an address, the resolved entry (or nullptr
+ * for "no route") and the generation it was filled in. A slot is valid only
+ * if its generation is the current one, so the whole cache is invalidated by
+ * bumping the generation.
+ *
+ * A change of the table invalidates only the addresses covered by the changed
+ * prefix, as long as the prefix covers no more addresses than the cache has
+ * slots. Otherwise the generation is bumped.
+ *
+ * The cache is not thread-safe, use one cache per thread.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <routing_table.hpp>
+
+namespace RTM {
+
+class route_cache {
+public:
+	static constexpr size_t DEFAULT_SLOTS = 1024;
+
+	/**
+	 * @brief Construct a new route cache
+	 *
+	 * @param num_slots - the number of slots, rounded up to a power of two
+	 */
+	explicit route_cache(size_t num_slots = DEFAULT_SLOTS);
+
+	/**
+	 * @brief Find the route to an address, resolving misses from the table
+	 *
+	 * @param table - the routing table the cache is in front of
+	 * @param addr - the address in host order (see routing_table_entry::ip2host)
+	 * @return const routing_table_entry* - the entry with the longest prefix
+	 * covering the address or nullptr if there is no route
+	 * @note The table must report each change by invalidate() or clear().
+	 */
+	const routing_table_entry* lookup(const routing_table &table, uint32_t addr);
+
+	/**
+	 * @brief Invalidate the addresses covered by a prefix
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length
+	 */
+	void invalidate(uint32_t prefix, uint8_t len);
+
+	/**
+	 * @brief Invalidate the addresses covered by the destination of an entry
+	 *
+	 * @param entry - the created, updated or deleted entry
+	 */
+	void invalidate(const routing_table_entry &entry);
+
+	/**
+	 * @brief Invalidate all slots (generation bump)
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the number of slots
+	 *
+	 * @return size_t - the number of slots
+	 */
+	size_t capacity() const
+	{
+		return this->slots.size();
+	}
+
+	/**
+	 * @brief Get the number of lookups served by the cache
+	 *
+	 * @return uint64_t - the number of hits
+	 */
+	uint64_t hits() const
+	{
+		return this->num_hits;
+	}
+
+	/**
+	 * @brief Get the number of lookups resolved by the table
+	 *
+	 * @return uint64_t - the number of misses
+	 */
+	uint64_t misses() const
+	{
+		return this->num_misses;
+	}
+
+	/**
+	 * @brief Get the number of full invalidations (generation bumps)
+	 *
+	 * @return uint64_t - the number of flushes
+	 */
+	uint64_t flushes() const
+	{
+		return this->num_flushes;
+	}
+
+	/**
+	 * @brief Reset the hit, miss and flush counters
+	 */
+	void reset_stats();
+
+private:
+	struct slot {
+		uint32_t addr = 0;
+		uint32_t generation = 0;  // 0: never valid
+		const routing_table_entry *entry = nullptr;
+	};
+
+	size_t index_of(uint32_t addr) const;
+
+	std::vector<slot> slots;
+	unsigned index_shift;
+	uint32_t generation = 1;
+	uint64_t num_hits = 0;
+	uint64_t num_misses = 0;
+	uint64_t num_flushes = 0;
+};
+
+}  // namespace RTM
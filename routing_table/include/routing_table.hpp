@@ -18,20 +18,47 @@
 #include <cstring>
 #include <cassert>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <span>
 #include <map>
+#include <memory_resource>
+#include <optional>
+
+#include <multibit_trie.hpp>
+#include <rtm_address.hpp>
+#include <rtm_codec.hpp>
+#include <rtm_fib.hpp>
 
 namespace RTM {
 
 /**
  * @brief Routing Table Management Operation Codes
  */
-enum {
+enum cud_opcode_t : uint32_t {
 	RTM_CREATE = 0,
 	RTM_UPDATE,
 	RTM_DELETE,
-} cud_opcode_t;
+	RTM_SUBSCRIBE,   // client -> server: subscription filters
+	RTM_SYNC_DONE,   // server -> client: full table state was sent
+	RTM_RING_ATTACH, // client -> server: follow the shared memory ring
+	RTM_RING,        // server -> client: shared memory ring descriptors
+	RTM_LOOKUP,      // client -> server: batch of addresses to resolve
+	RTM_LOOKUP_REPLY,// server -> client: routes of a RTM_LOOKUP batch
+	RTM_CREATE6,     // RTM_CREATE of IPv6 entries (see routing_table6.hpp)
+	RTM_UPDATE6,     // RTM_UPDATE of IPv6 entries
+	RTM_DELETE6,     // RTM_DELETE of IPv6 entries
+};
+
+/**
+ * @brief Routing Table Entry Fields changed by an update (bitmask)
+ */
+enum rtm_field_t : uint32_t {
+	RTM_FIELD_GATEWAY = 1u << 0,
+	RTM_FIELD_MASK = 1u << 1,
+	RTM_FIELD_OIF = 1u << 2,
+	RTM_FIELD_ALL = RTM_FIELD_GATEWAY | RTM_FIELD_MASK | RTM_FIELD_OIF,
+};
 
 
 /**
@@ -60,6 +87,16 @@ struct routing_table_entry
 	 */
 	size_t size() const;
 
+	/**
+	 * @brief Get the size of the serialized routing table entry
+	 *
+	 * @return size_t - the number of bytes written by serialize()
+	 */
+	size_t serialized_size() const
+	{
+		return this->size() + 5 * sizeof(uint32_t);
+	}
+
 	/**
 	 * @brief Comparison operator for routing table entries
 	 *
@@ -88,6 +125,30 @@ struct routing_table_entry
 	 */
 	static std::string destination_ip2str(const routing_table_entry& entry);
 
+	/**
+	 * @brief Parse an IPv4 address in dotted decimal format
+	 *
+	 * @param str - the string to parse (e.g. "10.1.1.1")
+	 * @param ip - the parsed address bytes
+	 * @return true if the string is a valid IPv4 address, false otherwise
+	 */
+	static bool str2ip(const std::string& str, uint8_t (&ip)[4]);
+
+	/**
+	 * @brief Convert IPv4 address bytes into a host order integer
+	 *
+	 * @param ip - the address bytes (e.g. destination_ip)
+	 * @return uint32_t - the address with the first byte as most significant one
+	 * @note Use this value for prefix arithmetics (masking, bit walks).
+	 */
+	static uint32_t ip2host(const uint8_t (&ip)[4])
+	{
+		return (static_cast<uint32_t>(ip[0]) << 24) |
+		       (static_cast<uint32_t>(ip[1]) << 16) |
+		       (static_cast<uint32_t>(ip[2]) << 8) |
+		       static_cast<uint32_t>(ip[3]);
+	}
+
 	/**
 	 * @brief Serialize the routing table entry into a std::array buffer
 	 *
@@ -97,7 +158,9 @@ struct routing_table_entry
 	 * 	<gateway_ip_bytes><gateway_ip>
 	 * 	<mask_bytes><mask>
 	 * 	<oif_bytes><oif>
-	 * @note: bytes sizes are given as 32 bit unsigned integers
+	 * @note: bytes sizes are given as 32 bit unsigned little-endian
+	 * integers, the IP addresses in network byte order (see
+	 * routing_table_entry_codec)
 	 *
 	 * @param entry - the routing table entry to serialize
 	 * @param buffer - the buffer to write the serialized data into
@@ -106,6 +169,16 @@ struct routing_table_entry
 	static size_t serialize(const routing_table_entry &entry,
 				std::vector<uint8_t>& buffer);
 
+	/**
+	 * @brief Serialize the routing table entry into a memory region
+	 *
+	 * @param entry - the routing table entry to serialize
+	 * @param out - the memory region of at least serialized_size() bytes
+	 * @return size_t - the number of bytes written
+	 * @note Use this overload to append entries to a message buffer.
+	 */
+	static size_t serialize(const routing_table_entry &entry, uint8_t *out);
+
 	/**
 	 * @brief Deserialize a std::array buffer into a routing table entry
 	 *
@@ -115,32 +188,224 @@ struct routing_table_entry
 	 */
 	static size_t deserialize(const std::vector<uint8_t>& buffer,
 				  routing_table_entry &entry);
+
+	/**
+	 * @brief Deserialize a routing table entry from a memory region
+	 *
+	 * @param buffer - the memory region starting with a serialized entry
+	 * @param entry - the routing table entry to populate
+	 * @return size_t - the number of bytes read from the buffer, 0 if the
+	 * entry is malformed or truncated
+	 * @note Use this overload to read entries packed into a message buffer.
+	 */
+	static size_t deserialize(std::span<const uint8_t> buffer,
+				  routing_table_entry &entry);
+
+	/**
+	 * @brief Get the size of an update delta of the routing table entry
+	 *
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return size_t - the size in bytes of the serialized delta
+	 */
+	size_t delta_size(uint32_t fields) const;
+
+	/**
+	 * @brief Serialize the key and some fields of the routing table entry
+	 * (update delta)
+	 *
+	 * Serialization format:
+	 * 	<dest_ip><fields>
+	 * 	<gateway_ip>		if fields has RTM_FIELD_GATEWAY
+	 * 	<mask>			if fields has RTM_FIELD_MASK, a single byte
+	 * 	<oif_bytes><oif>	if fields has RTM_FIELD_OIF
+	 * @note: all other values are given as 32 bit unsigned little-endian
+	 * integers, a gateway change takes 12 bytes (see routing_table_delta_codec)
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @param out - the memory region of at least delta_size() bytes
+	 * @return size_t - the number of bytes written
+	 */
+	static size_t serialize_delta(const routing_table_entry &entry,
+				      uint32_t fields, uint8_t *out);
+
+	/**
+	 * @brief Deserialize an update delta
+	 *
+	 * @param buffer - the memory region starting with a serialized delta
+	 * @param entry - populated with the key and the changed fields, other
+	 * fields are left as they are
+	 * @param fields - populated with the changed fields
+	 * @return size_t - the number of bytes read, 0 if the delta is malformed
+	 */
+	static size_t deserialize_delta(std::span<const uint8_t> buffer,
+					routing_table_entry &entry, uint32_t &fields);
+};
+
+/**
+ * @brief Wire format of a routing table entry of any address family, the
+ * address sizes tell the family apart (see routing_table_entry::serialize())
+ *
+ * @tparam Entry - routing_table_entry or routing_table6_entry
+ */
+template <typename Entry>
+using routing_entry_codec = wire::size_prefixed<wire::codec<Entry,
+	wire::sized_field<wire::bytes_field<&Entry::destination_ip>>,
+	wire::sized_field<wire::bytes_field<&Entry::gateway_ip>>,
+	wire::sized_field<wire::uint_field<&Entry::destination_mask>>,
+	wire::string_field<&Entry::oif>>>;
+
+/**
+ * @brief Wire format of an IPv4 routing table entry
+ */
+using routing_table_entry_codec = routing_entry_codec<routing_table_entry>;
+
+/**
+ * @brief Update delta of a routing table entry: the entry holding the new
+ * values and the changed fields
+ *
+ * @tparam Entry - const routing_table_entry to encode, routing_table_entry
+ * to decode (routing_table6_entry for IPv6)
+ */
+template <typename Entry>
+struct routing_table_delta {
+	Entry *entry;
+	uint32_t fields;  // rtm_field_t bitmask
+};
+
+/**
+ * @brief Wire format of an update delta (see routing_table_entry::serialize_delta())
+ */
+template <typename Entry, typename Stored = std::remove_const_t<Entry>>
+using routing_table_delta_codec = wire::codec<routing_table_delta<Entry>,
+	wire::nested_field<&routing_table_delta<Entry>::entry,
+			   wire::bytes_field<&Stored::destination_ip>>,
+	wire::uint_field<&routing_table_delta<Entry>::fields>,
+	wire::optional_field<&routing_table_delta<Entry>::fields, RTM_FIELD_GATEWAY,
+		wire::nested_field<&routing_table_delta<Entry>::entry,
+				   wire::bytes_field<&Stored::gateway_ip>>>,
+	wire::optional_field<&routing_table_delta<Entry>::fields, RTM_FIELD_MASK,
+		wire::nested_field<&routing_table_delta<Entry>::entry,
+				   wire::uint_field<&Stored::destination_mask>>>,
+	wire::optional_field<&routing_table_delta<Entry>::fields, RTM_FIELD_OIF,
+		wire::nested_field<&routing_table_delta<Entry>::entry,
+				   wire::string_field<&Stored::oif>>>>;
+
+/**
+ * @brief Header of a serialized routing table (see routing_table::serialize())
+ */
+struct routing_table_header {
+	uint32_t total_size;   // including the header
+	uint32_t num_entries;
+};
+
+using routing_table_header_codec = wire::codec<routing_table_header,
+	wire::uint_field<&routing_table_header::total_size>,
+	wire::uint_field<&routing_table_header::num_entries>>;
+
+
+/**
+ * @brief The entry, key and FIB types of an address family, specialized by
+ * the header of the family (see routing_table6.hpp for IPv6)
+ *
+ * @tparam Family - the address family (see rtm_address.hpp)
+ */
+template <typename Family>
+struct routing_family;
+
+template <>
+struct routing_family<inet4> {
+	using entry_type = routing_table_entry;
+	using key_type = uint32_t;  // destination_ip_u32, the address in memory order
+	using fib_type = rtm_fib;
+
+	static key_type key(const entry_type &entry)
+	{
+		return entry.destination_ip_u32;
+	}
+
+	static fib_type::next_hop next_hop(const entry_type &entry)
+	{
+		return {entry.gateway_ip_u32, entry.oif};
+	}
 };
 
 
 /**
  * @brief Routing Table Class
  *
+ * The entries are allocated from a polymorphic memory resource, by default
+ * from the heap. With a pool resource (e.g. std::pmr::unsynchronized_pool_resource)
+ * the entries of a large table are carved out of few large chunks: building
+ * the table does not fragment the heap and the memory of a cleared table is
+ * reused by the next reload.
+ * @tparam Family - the address family, see the routing_table and
+ * routing_table6 aliases
+ * @note The OIF names of Linux fit into the small string buffer of
+ * std::string (IFNAMSIZ), so an entry takes a single allocation.
  */
-class routing_table {
+template <typename Family>
+class basic_routing_table {
 public:
-	routing_table() {};
-	~routing_table() {};
+	using entry_type = typename routing_family<Family>::entry_type;
+	using key_type = typename routing_family<Family>::key_type;
+	using fib_type = typename routing_family<Family>::fib_type;
+	using address = typename Family::address;
+
+	basic_routing_table() {};
+
+	/**
+	 * @brief Construct a new routing table allocating from a memory resource
+	 *
+	 * @param resource - the memory resource of the entries, must outlive
+	 * the table
+	 * @note A copy of the table allocates from the default resource.
+	 */
+	explicit basic_routing_table(std::pmr::memory_resource *resource) :
+		table(resource)
+	{
+	}
+
+	~basic_routing_table() {};
+
+	/**
+	 * @brief Get the memory resource of the entries
+	 *
+	 * @return std::pmr::memory_resource* - the memory resource
+	 */
+	std::pmr::memory_resource* get_memory_resource() const
+	{
+		return this->table.get_allocator().resource();
+	}
 
 	/**
 	 * @brief Create a entry object
 	 *
 	 * @param entry - the routing table entry to create
 	 */
-	void create_entry(const routing_table_entry &entry);
+	void create_entry(const entry_type &entry);
 
 	/**
-	 * @brief Update a routing table entry
+	 * @brief Create many routing table entries at once
 	 *
-	 * @param entry - the routing table entry to update.
+	 * @param entries - the entries to create, sorted by key and moved from
+	 * @note The entries are inserted in key order, each one next to the
+	 * previous one, which is much faster than create_entry() for each entry.
+	 * A later entry replaces an earlier one with the same key.
+	 */
+	void bulk_load(std::vector<entry_type> &entries);
+
+	/**
+	 * @brief Update fields of a routing table entry in place
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the fields to update (rtm_field_t bitmask)
+	 * @return true if the entry was updated, false if it does not exist
 	 * @note The destination IP is used as the key for update.
+	 * @note The entry is not reallocated: the OIF is assigned to the
+	 * existing string, which holds Linux interface names without allocation.
 	 */
-	void update_entry(const routing_table_entry &entry);
+	bool update_entry(const entry_type &entry, uint32_t fields = RTM_FIELD_ALL);
 
 	/**
 	 * @brief Delete a routing table entry
@@ -151,19 +416,103 @@ public:
 	 * @note This function could be potentially slow but acceptable for
 	 * this project.
 	 */
-	void delete_entry(const routing_table_entry &entry);
+	void delete_entry(const entry_type &entry);
 
 	/**
 	 * @brief Get a routing table entry by key
 	 *
 	 * @param key 	- the key of the entry to retrieve
-	 * @return const routing_table_entry& - the reference to routing table entry
+	 * @return const entry_type& - the reference to routing table entry
 	 */
-	const routing_table_entry& at(const uint32_t& key) const
+	const entry_type& at(const key_type& key) const
 	{
 		return this->table.at(key);
 	}
 
+	/**
+	 * @brief Find a routing table entry by key
+	 *
+	 * @param key - the key of the entry to find
+	 * @return const entry_type* - the entry or nullptr if not found
+	 */
+	const entry_type* find(const key_type& key) const
+	{
+		const auto it = this->table.find(key);
+		return it != this->table.end() ? &it->second : nullptr;
+	}
+
+	/**
+	 * @brief Find the route to an address (longest prefix match)
+	 *
+	 * @param addr - the address in host order (see Family::load())
+	 * @return const entry_type* - the entry with the longest prefix
+	 * covering the address or nullptr if there is no route
+	 * @note The prefix index is built by the first lookup and maintained by
+	 * the table changes afterwards, tables never looked up do not pay for it.
+	 */
+	const entry_type* lookup(address addr) const;
+
+	/**
+	 * @brief Get the memory taken by the lookup structure
+	 *
+	 * @return size_t - the size in bytes, see multibit_trie::memory_usage()
+	 */
+	size_t lookup_memory_usage() const
+	{
+		return this->prefixes.memory_usage();
+	}
+
+	/**
+	 * @brief Maintain an aggregated FIB of the routes (see rtm_fib.hpp)
+	 *
+	 * @param enable - true to build the FIB and keep it up to date with the
+	 * table changes, false to drop it
+	 * @note The next hop of each prefix is the one of the entry lookup()
+	 * returns, so get_fib()->lookup() resolves the same gateway and OIF.
+	 */
+	void set_aggregation(bool enable);
+
+	/**
+	 * @brief Get the aggregated FIB
+	 *
+	 * @return const fib_type* - the FIB or nullptr if aggregation is disabled
+	 */
+	const fib_type* get_fib() const
+	{
+		return this->fib ? &*this->fib : nullptr;
+	}
+
+	/**
+	 * @brief Call a function for each routing table entry in key order
+	 *
+	 * @param func - the function to call with each entry
+	 */
+	template <typename Func>
+	void for_each(Func&& func) const
+	{
+		for (const auto& [key, entry] : this->table) {
+			func(entry);
+		}
+	}
+
+	/**
+	 * @brief Call a function for the routing table entries from a key on
+	 * in key order
+	 *
+	 * @param key - the first key to visit, need not exist
+	 * @param func - the function to call with each entry, returns false to
+	 * stop the iteration
+	 */
+	template <typename Func>
+	void for_each_from(key_type key, Func&& func) const
+	{
+		for (auto it = this->table.lower_bound(key); it != this->table.end(); ++it) {
+			if (!func(it->second)) {
+				break;
+			}
+		}
+	}
+
 	/**
 	 * @brief Clear the routing table
 	 *
@@ -171,6 +520,11 @@ public:
 	void clear()
 	{
 		this->table.clear();
+		this->prefixes.clear();
+		this->indexed = this->fib.has_value();
+		if (this->fib) {
+			this->fib->clear();
+		}
 	}
 
 	/**
@@ -205,8 +559,10 @@ public:
 	 * 	<serialized_entry_1>...<serialized_entry_n>
 	 * @note: each entry has its own serialization size at the beginnig
 	 * @note: all sizes are given as 32 bit unsigned integers
+	 * @note The buffer is grown if it is too small for the table.
 	 */
-	static size_t serialize(routing_table &table, std::vector<uint8_t> &buffer);
+	static size_t serialize(const basic_routing_table &table,
+				std::vector<uint8_t> &buffer);
 
 	/**
 	 * @brief Deserialize a routing table from a buffer
@@ -222,15 +578,29 @@ public:
 	 * @note: all sizes are given as 32 bit unsigned integers
 	 */
 	static size_t deserialize(const std::vector<uint8_t>& buffer,
-				  routing_table &table);
+				  basic_routing_table &table);
 
+	/**
+	 * @brief Deserialize a routing table from a memory region
+	 *
+	 * @param buffer - the memory region starting with a serialized table
+	 * @param table - the routing table to populate
+	 * @return size_t - the number of bytes read from the buffer
+	 * @note Use this overload to read a table in place, e.g. from a mapped
+	 * file. Throws std::invalid_argument if an entry exceeds the table size.
+	 */
+	static size_t deserialize(std::span<const uint8_t> buffer,
+				  basic_routing_table &table);
 	/**
 	 * @brief Comparison operator for routing table entries
 	 *
 	 * @param other - the routing table to compare with
 	 * @return true if the entries are equal, false otherwise
 	 */
-	bool operator==(const routing_table& other) const;
+	bool operator==(const basic_routing_table& other) const
+	{
+		return this->table == other.table;
+	}
 
 	/**
 	 * @brief Inequality operator for routing table
@@ -239,7 +609,7 @@ public:
 	 * @return true - if the tables are not equal, false otherwise
 	 * @note This operator is the negation of the equality operator.
 	 */
-	bool operator!=(const routing_table& other) const
+	bool operator!=(const basic_routing_table& other) const
 	{
 		return !(this->operator==(other));
 	}
@@ -250,7 +620,68 @@ public:
 	 * @return std::string& - the string representation of the routing table
 	 */
 	std::string to_string() const;
+
+	/**
+	 * @brief Append the string representation of the table to a buffer
+	 *
+	 * @param out - the buffer to append to
+	 * @note Same format as to_string(), without temporary strings per entry.
+	 */
+	void dump(std::string &out) const;
+
+	/**
+	 * @brief Write the string representation of the table to a file
+	 *
+	 * @param fd - the file descriptor to write to
+	 * @note Same format as to_string(), written in chunks, so the whole
+	 * table is never held in memory as text.
+	 * @note Throws std::system_error if the write fails.
+	 */
+	void dump(int fd) const;
+
+	/**
+	 * @brief Create the entries of a text, one route per line
+	 *
+	 * @param text - lines of the form "<destination>/<mask> <gateway> <oif>",
+	 * empty lines and lines starting with '#' are skipped
+	 * @return size_t - the number of loaded entries
+	 * @note The entries are created by bulk_load().
+	 * @note Throws std::invalid_argument with the line number if a line is
+	 * malformed, no entry is created in this case.
+	 */
+	size_t load_text(std::string_view text);
+
+	/**
+	 * @brief Create the entries of a text file, see load_text(std::string_view)
+	 *
+	 * @param fd - the file descriptor to read up to the end
+	 * @return size_t - the number of loaded entries
+	 * @note Throws std::system_error if the file could not be read.
+	 */
+	size_t load_text(int fd);
 private:
-	std::map<uint32_t, routing_table_entry> table;  // store routing table entries
+	using table_iterator = typename std::pmr::map<key_type, entry_type>::iterator;
+
+	table_iterator insert_entry(table_iterator hint, entry_type &&entry);
+	void build_index() const;
+	void index_entry(const entry_type &entry) const;
+	void unindex_entry(const entry_type &entry);
+	void update_fib(address prefix, uint8_t len) const;
+
+	std::pmr::map<key_type, entry_type> table;  // store routing table entries
+	// Keys of the entries by their prefix for lookup(), entries may share a
+	// prefix if their destinations differ only in the host bits
+	mutable multibit_trie<std::vector<key_type>, Family> prefixes;
+	mutable bool indexed = false;  // prefixes is built and maintained
+	// The next hops of the prefixes aggregated, requires the index
+	mutable std::optional<fib_type> fib;
 };
+
+/**
+ * @brief IPv4 Routing Table
+ */
+using routing_table = basic_routing_table<inet4>;
+
+extern template class basic_routing_table<inet4>;
+
 }  // namespace RTM
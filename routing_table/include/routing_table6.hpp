@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief IPv6 Routig Table, the IPv6 counterpart of routing_table.hpp:
+ *
+ *  | Destination (Key) | Destination       | Gateway IP  | OIF  |
+ *  |-------------------|-------------------|-------------|------|
+ *  | 2001:db8::/32     | 2001:db8::/32     | fe80::1     | eth0 |
+ *  | 2001:db8:1::/48   | 2001:db8:1::/48   | fe80::2     | eth1 |
+ *
+ * - The entries are serialized in the format of the IPv4 entries, the 16 byte
+ * address sizes tell them apart (see routing_entry_codec). Update deltas use
+ * routing_table_delta_codec like the IPv4 ones.
+ * - The table is the IPv4 one (see basic_routing_table) over the inet6
+ * address family: the same storage, lookup engine, FIB and text format.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <multibit_trie.hpp>
+#include <routing_table.hpp>
+#include <rtm_address.hpp>
+
+namespace RTM {
+
+/**
+ * @brief IPv6 Routing Table Entry Structure
+ *
+ */
+struct routing_table6_entry
+{
+	uint8_t destination_ip[16] = {};  // IPv6 address in network byte order
+	uint8_t gateway_ip[16] = {};      // IPv6 address in network byte order
+	uint8_t destination_mask = 0;     // prefix length (e.g., 48 for /48)
+	std::string oif;                  // Output Interface (e.g., "eth0")
+
+	/**
+	 * @brief Get the size of the serialized routing table entry
+	 *
+	 * @return size_t - the number of bytes written by serialize()
+	 */
+	size_t serialized_size() const;
+
+	/**
+	 * @brief Get the size of an update delta of the routing table entry
+	 *
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return size_t - the size in bytes of the serialized delta
+	 */
+	size_t delta_size(uint32_t fields) const;
+
+	/**
+	 * @brief Get the key of the entry
+	 *
+	 * @return inet6::address - the destination IP in host order
+	 */
+	inet6::address key() const
+	{
+		return inet6::load(this->destination_ip);
+	}
+
+	bool operator==(const routing_table6_entry& other) const = default;
+
+	/**
+	 * @brief Parse an IPv6 address in its text form
+	 *
+	 * @param str - the string to parse (e.g. "2001:db8::1")
+	 * @param ip - the parsed address bytes
+	 * @return true if the string is a valid IPv6 address, false otherwise
+	 */
+	static bool str2ip(const std::string& str, uint8_t (&ip)[16])
+	{
+		return inet6::parse(str, ip);
+	}
+
+	/**
+	 * @brief Convert IPv6 address bytes to their text form
+	 *
+	 * @param ip - the address bytes (e.g. destination_ip)
+	 * @return std::string - the text form of the address
+	 */
+	static std::string ip2str(const uint8_t (&ip)[16])
+	{
+		return inet6::format(ip);
+	}
+
+	/**
+	 * @brief Serialize the routing table entry into a memory region
+	 *
+	 * @param entry - the routing table entry to serialize
+	 * @param out - the memory region of at least serialized_size() bytes
+	 * @return size_t - the number of bytes written
+	 */
+	static size_t serialize(const routing_table6_entry &entry, uint8_t *out);
+
+	/**
+	 * @brief Deserialize a routing table entry from a memory region
+	 *
+	 * @param buffer - the memory region starting with a serialized entry
+	 * @param entry - the routing table entry to populate
+	 * @return size_t - the number of bytes read from the buffer, 0 if the
+	 * entry is malformed, truncated or an IPv4 entry
+	 */
+	static size_t deserialize(std::span<const uint8_t> buffer,
+				  routing_table6_entry &entry);
+
+	/**
+	 * @brief Serialize the key and some fields of the routing table entry
+	 * (update delta), see routing_table_entry::serialize_delta()
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @param out - the memory region of at least delta_size() bytes
+	 * @return size_t - the number of bytes written
+	 */
+	static size_t serialize_delta(const routing_table6_entry &entry,
+				      uint32_t fields, uint8_t *out);
+};
+
+/**
+ * @brief Wire format of an IPv6 routing table entry
+ */
+using routing_table6_entry_codec = routing_entry_codec<routing_table6_entry>;
+
+
+template <>
+struct routing_family<inet6> {
+	using entry_type = routing_table6_entry;
+	using key_type = inet6::address;  // the destination IP in host order
+	using fib_type = rtm_fib6;
+
+	static key_type key(const entry_type &entry)
+	{
+		return entry.key();
+	}
+
+	static fib_type::next_hop next_hop(const entry_type &entry)
+	{
+		fib_type::next_hop nh;
+
+		std::copy(std::begin(entry.gateway_ip), std::end(entry.gateway_ip),
+			  nh.gateway_ip);
+		nh.oif = entry.oif;
+		return nh;
+	}
+};
+
+
+/**
+ * @brief IPv6 Routing Table, see basic_routing_table
+ *
+ * @note The text form of the entries has the IPv6 addresses in their usual
+ * notation (see inet6::format()), the keys are looked up in host order.
+ */
+using routing_table6 = basic_routing_table<inet6>;
+
+extern template class basic_routing_table<inet6>;
+
+}  // namespace RTM
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) address families.
+ *
+ * The lookup structure (see multibit_trie.hpp) is a template over an address
+ * family:
+ *
+ *  | Family | Address (host order) | Bits | Bytes (network order) |
+ *  |--------|----------------------|------|-----------------------|
+ *  | inet4  | uint32_t             | 32   | 4                     |
+ *  | inet6  | unsigned __int128    | 128  | 16                    |
+ *
+ * Addresses are handled as host order integers, so masking and bit walks are
+ * plain integer arithmetics, the first address byte is the most significant
+ * one.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+namespace RTM {
+
+namespace detail {
+
+template <typename Family>
+struct address_family {
+	/**
+	 * @brief Get the mask of a prefix length
+	 *
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return address - the mask in host order
+	 */
+	static constexpr auto mask(uint8_t len)
+	{
+		using address = typename Family::address;
+		return len == 0 ? address(0) : ~address(0) << (Family::bits - len);
+	}
+
+	/**
+	 * @brief Convert address bytes into a host order integer
+	 *
+	 * @param ip - the Family::bytes address bytes in network order
+	 * @return address - the address with the first byte as most significant one
+	 */
+	static constexpr auto load(const uint8_t *ip)
+	{
+		typename Family::address addr = 0;
+		for (size_t i = 0; i < Family::bytes; ++i) {
+			addr = (addr << 8) | ip[i];
+		}
+		return addr;
+	}
+
+	/**
+	 * @brief Convert a host order integer into address bytes
+	 *
+	 * @param value - the address in host order
+	 * @param ip - the Family::bytes address bytes to write in network order
+	 */
+	static constexpr void store(auto value, uint8_t *ip)
+	{
+		// Family is incomplete at the declaration, the type is taken here
+		typename Family::address addr = value;
+		for (size_t i = Family::bytes; i-- > 0;) {
+			ip[i] = static_cast<uint8_t>(addr);
+			addr >>= 8;
+		}
+	}
+
+	/**
+	 * @brief Parse an address in its text form
+	 *
+	 * @param str - the string to parse (e.g. "10.1.1.1" or "2001:db8::1")
+	 * @param ip - the Family::bytes address bytes to populate
+	 * @return true if the string is a valid address, false otherwise
+	 */
+	static bool parse(const std::string &str, uint8_t *ip)
+	{
+		return inet_pton(Family::af, str.c_str(), ip) == 1;
+	}
+
+	/**
+	 * @brief Format an address in its text form
+	 *
+	 * @param ip - the Family::bytes address bytes
+	 * @return std::string - the text form of the address
+	 */
+	static std::string format(const uint8_t *ip)
+	{
+		char str[INET6_ADDRSTRLEN];
+		return inet_ntop(Family::af, ip, str, sizeof(str));
+	}
+};
+
+}  // namespace detail
+
+/**
+ * @brief IPv4 address family
+ */
+struct inet4 : detail::address_family<inet4> {
+	using address = uint32_t;
+	static constexpr uint8_t bits = 32;
+	static constexpr size_t bytes = 4;
+	static constexpr int af = AF_INET;
+};
+
+/**
+ * @brief IPv6 address family
+ */
+struct inet6 : detail::address_family<inet6> {
+	using address = unsigned __int128;
+	static constexpr uint8_t bits = 128;
+	static constexpr size_t bytes = 16;
+	static constexpr int af = AF_INET6;
+};
+
+}  // namespace RTM
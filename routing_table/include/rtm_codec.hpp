@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) wire codecs generated at compile time.
+ *
+ * A wire format is declared as a list of field descriptors of a structure:
+ *
+ * 	using point_codec = wire::codec<point,
+ * 		wire::uint_field<&point::x>,
+ * 		wire::uint_field<&point::y>>;
+ *
+ * and the codec provides encode(), decode() and size() by folding over the
+ * fields. Integers are encoded little-endian on any host, byte arrays (IPv4
+ * addresses in network order) are copied as they are.
+ *
+ * The size checks of decode() are derived at compile time: the minimum size
+ * of all fields is checked once up front, so fixed-size fields are read
+ * without further checks. A variable-size field (string, optional field)
+ * checks its own size and leaves room for the minimum size of the fields
+ * behind it. A codec of fixed-size fields only compiles down to one size
+ * check and a load or store per field.
+ *
+ * Field descriptors (and codecs, which are fields themselves) provide:
+ * 	fixed		- true if the field has always min_size bytes
+ * 	min_size	- the minimum encoded size in bytes
+ * 	size(v)		- the encoded size of the field of v
+ * 	encode(v, out)	- write the field, return the end of the written bytes
+ * 	decode(v, in, end) - read the field, return the end of the read bytes or
+ * 			nullptr if malformed; fixed fields may ignore end
+ *
+ */
+
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RTM::wire {
+
+/**
+ * @brief Store an unsigned integer in little-endian byte order
+ *
+ * @param out - the memory to write sizeof(T) bytes to
+ * @param value - the value to store
+ */
+template <std::unsigned_integral T>
+inline void store_le(uint8_t *out, T value)
+{
+	if constexpr (std::endian::native == std::endian::big) {
+		value = std::byteswap(value);
+	}
+	std::memcpy(out, &value, sizeof(value));
+}
+
+/**
+ * @brief Load an unsigned integer in little-endian byte order
+ *
+ * @param in - the memory to read sizeof(T) bytes from
+ * @return T - the loaded value
+ */
+template <std::unsigned_integral T>
+inline T load_le(const uint8_t *in)
+{
+	T value;
+
+	std::memcpy(&value, in, sizeof(value));
+	if constexpr (std::endian::native == std::endian::big) {
+		value = std::byteswap(value);
+	}
+	return value;
+}
+
+template <auto Member>
+struct member_traits;
+
+template <typename Class, typename Type, Type Class::*Member>
+struct member_traits<Member> {
+	using class_type = Class;
+	using type = Type;
+};
+
+template <auto Member>
+using member_type = typename member_traits<Member>::type;
+
+/**
+ * @brief Unsigned integer member, little-endian
+ */
+template <auto Member>
+struct uint_field {
+	using value_type = member_type<Member>;
+	static_assert(std::is_unsigned_v<value_type>);
+
+	static constexpr bool fixed = true;
+	static constexpr size_t min_size = sizeof(value_type);
+
+	template <typename T>
+	static size_t size(const T&)
+	{
+		return min_size;
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		store_le(out, v.*Member);
+		return out + min_size;
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t*)
+	{
+		v.*Member = load_le<value_type>(in);
+		return in + min_size;
+	}
+};
+
+/**
+ * @brief Byte array member, copied as it is
+ */
+template <auto Member>
+struct bytes_field {
+	using value_type = member_type<Member>;
+	static_assert(std::is_same_v<std::remove_extent_t<value_type>, uint8_t>);
+
+	static constexpr bool fixed = true;
+	static constexpr size_t min_size = sizeof(value_type);
+
+	template <typename T>
+	static size_t size(const T&)
+	{
+		return min_size;
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		std::memcpy(out, v.*Member, min_size);
+		return out + min_size;
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t*)
+	{
+		std::memcpy(v.*Member, in, min_size);
+		return in + min_size;
+	}
+};
+
+/**
+ * @brief String member: <size><bytes>, the size as 32 bit integer
+ */
+template <auto Member>
+struct string_field {
+	static constexpr bool fixed = false;
+	static constexpr size_t min_size = sizeof(uint32_t);
+
+	template <typename T>
+	static size_t size(const T &v)
+	{
+		return min_size + (v.*Member).size();
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		const auto &str = v.*Member;
+		store_le(out, static_cast<uint32_t>(str.size()));
+		std::memcpy(out + min_size, str.data(), str.size());
+		return out + min_size + str.size();
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t *end)
+	{
+		const uint32_t len = load_le<uint32_t>(in);
+		in += min_size;
+		if (len > static_cast<size_t>(end - in)) {
+			return nullptr;
+		}
+		(v.*Member).assign(reinterpret_cast<const char*>(in), len);
+		return in + len;
+	}
+};
+
+/**
+ * @brief Fixed-size field preceded by its size as 32 bit integer
+ *
+ * @note A different size on decode is malformed.
+ */
+template <typename Field>
+struct sized_field {
+	static_assert(Field::fixed);
+
+	static constexpr bool fixed = true;
+	static constexpr size_t min_size = sizeof(uint32_t) + Field::min_size;
+
+	template <typename T>
+	static size_t size(const T&)
+	{
+		return min_size;
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		store_le(out, static_cast<uint32_t>(Field::min_size));
+		return Field::encode(v, out + sizeof(uint32_t));
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t *end)
+	{
+		if (load_le<uint32_t>(in) != Field::min_size) {
+			return nullptr;
+		}
+		return Field::decode(v, in + sizeof(uint32_t), end);
+	}
+};
+
+/**
+ * @brief Field present only if a bit of a flags member is set
+ *
+ * @note The flags member must be encoded before the field.
+ */
+template <auto Flags, member_type<Flags> Bit, typename Field>
+struct optional_field {
+	static constexpr bool fixed = false;
+	static constexpr size_t min_size = 0;
+
+	template <typename T>
+	static size_t size(const T &v)
+	{
+		return (v.*Flags & Bit) ? Field::size(v) : 0;
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		return (v.*Flags & Bit) ? Field::encode(v, out) : out;
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t *end)
+	{
+		if (!(v.*Flags & Bit)) {
+			return in;
+		}
+		if (static_cast<size_t>(end - in) < Field::min_size) {
+			return nullptr;
+		}
+		return Field::decode(v, in, end);
+	}
+};
+
+/**
+ * @brief Field of a member structure (or of the structure it points to)
+ */
+template <auto Member, typename Field>
+struct nested_field {
+	static constexpr bool fixed = Field::fixed;
+	static constexpr size_t min_size = Field::min_size;
+
+	template <typename M>
+	static decltype(auto) deref(M &m)
+	{
+		if constexpr (std::is_pointer_v<std::remove_cv_t<M>>) {
+			return *m;
+		} else {
+			return (m);
+		}
+	}
+
+	template <typename T>
+	static size_t size(const T &v)
+	{
+		return Field::size(deref(v.*Member));
+	}
+
+	template <typename T>
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		return Field::encode(deref(v.*Member), out);
+	}
+
+	template <typename T>
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t *end)
+	{
+		return Field::decode(deref(v.*Member), in, end);
+	}
+};
+
+/**
+ * @brief Wire format of a structure as a sequence of fields
+ *
+ * @tparam T - the structure
+ * @tparam Fields - the field descriptors in wire order
+ */
+template <typename T, typename... Fields>
+struct codec {
+	using value_type = T;
+
+	static constexpr bool fixed = (Fields::fixed && ...);
+	static constexpr size_t min_size = (Fields::min_size + ... + 0);
+
+	/**
+	 * @brief Get the encoded size of a value
+	 *
+	 * @param v - the value
+	 * @return size_t - the size in bytes, min_size for fixed codecs
+	 */
+	static size_t size(const T &v)
+	{
+		if constexpr (fixed) {
+			return min_size;
+		} else {
+			return (Fields::size(v) + ... + 0);
+		}
+	}
+
+	/**
+	 * @brief Encode a value
+	 *
+	 * @param v - the value
+	 * @param out - the memory of at least size(v) bytes
+	 * @return uint8_t* - the end of the written bytes
+	 */
+	static uint8_t* encode(const T &v, uint8_t *out)
+	{
+		((out = Fields::encode(v, out)), ...);
+		return out;
+	}
+
+	/**
+	 * @brief Decode a value
+	 *
+	 * @param v - the value to populate
+	 * @param in - the encoded value
+	 * @param end - the end of the readable memory
+	 * @return const uint8_t* - the end of the read bytes or nullptr if the
+	 * encoding is malformed
+	 */
+	static const uint8_t* decode(T &v, const uint8_t *in, const uint8_t *end)
+	{
+		if (static_cast<size_t>(end - in) < min_size) {
+			return nullptr;
+		}
+		return decode_fields(v, in, end, std::index_sequence_for<Fields...>());
+	}
+
+private:
+	using field_list = std::tuple<Fields...>;
+
+	// The minimum size of the fields behind the field I
+	template <size_t I>
+	static constexpr size_t tail_size()
+	{
+		constexpr size_t sizes[] = {Fields::min_size...};
+		size_t size = 0;
+		for (size_t i = I + 1; i < sizeof...(Fields); ++i) {
+			size += sizes[i];
+		}
+		return size;
+	}
+
+	template <size_t... I>
+	static const uint8_t* decode_fields(T &v, const uint8_t *in, const uint8_t *end,
+					    std::index_sequence<I...>)
+	{
+		// A field after a failed one is skipped, the first one cannot follow one
+		((in = (I == 0 || in) ? std::tuple_element_t<I, field_list>::decode(
+				v, in, end - tail_size<I>()) : nullptr), ...);
+		return in;
+	}
+};
+
+/**
+ * @brief Record preceded by its total size (including the size itself) as
+ * 32 bit integer
+ *
+ * @note A record not ending at its size on decode is malformed.
+ */
+template <typename Codec>
+struct size_prefixed {
+	using value_type = typename Codec::value_type;
+
+	static constexpr bool fixed = Codec::fixed;
+	static constexpr size_t min_size = sizeof(uint32_t) + Codec::min_size;
+
+	static size_t size(const value_type &v)
+	{
+		return sizeof(uint32_t) + Codec::size(v);
+	}
+
+	static uint8_t* encode(const value_type &v, uint8_t *out)
+	{
+		store_le(out, static_cast<uint32_t>(size(v)));
+		return Codec::encode(v, out + sizeof(uint32_t));
+	}
+
+	static const uint8_t* decode(value_type &v, const uint8_t *in, const uint8_t *end)
+	{
+		if (static_cast<size_t>(end - in) < min_size) {
+			return nullptr;
+		}
+		const uint32_t total = load_le<uint32_t>(in);
+		if (total < min_size || total > static_cast<size_t>(end - in)) {
+			return nullptr;
+		}
+		const uint8_t *record_end = in + total;
+		return Codec::decode(v, in + sizeof(uint32_t), record_end) == record_end ?
+		       record_end : nullptr;
+	}
+};
+
+/**
+ * @brief Append the encoding of a value to a buffer
+ *
+ * @tparam Codec - the codec of the value
+ * @param buffer - the buffer to append to
+ * @param v - the value
+ * @return size_t - the number of bytes appended
+ */
+template <typename Codec>
+size_t append(std::vector<uint8_t> &buffer, const typename Codec::value_type &v)
+{
+	const size_t offset = buffer.size();
+
+	buffer.resize(offset + Codec::size(v));
+	Codec::encode(v, buffer.data() + offset);
+
+	return buffer.size() - offset;
+}
+
+/**
+ * @brief Decode a value from the beginning of a memory region
+ *
+ * @tparam Codec - the codec of the value
+ * @param in - the memory region
+ * @param v - the value to populate
+ * @return size_t - the number of bytes read, 0 if the encoding is malformed
+ */
+template <typename Codec>
+size_t read(std::span<const uint8_t> in, typename Codec::value_type &v)
+{
+	const uint8_t *end = Codec::decode(v, in.data(), in.data() + in.size());
+
+	return end ? static_cast<size_t>(end - in.data()) : 0;
+}
+
+}  // namespace RTM::wire
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) aggregated forwarding table (FIB).
+ *
+ * The FIB maps IPv4 or IPv6 prefixes to next hops (gateway and OIF) like the routes it
+ * is fed with, but holds fewer prefixes:
+ *
+ * - a prefix with the same next hop as the prefix covering it is dropped
+ * (child merging)
+ * - a prefix whose address space resolves to the same next hop in both halves
+ * is replaced by one prefix, e.g. 10.0.0.0/25 and 10.0.0.128/25 via the
+ * same gateway become 10.0.0.0/24 (sibling merging)
+ *
+ * so lookup() returns the same next hop as a longest prefix match over the
+ * routes. The routes are kept in a binary trie, each node caches if its
+ * address space resolves to a single next hop. A route change recomputes this
+ * up the path to the root as long as it changes and rebuilds the aggregated
+ * prefixes below the topmost changed node only. The aggregated prefixes are
+ * looked up in a separate, smaller prefix_trie.
+ *
+ */
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <prefix_trie.hpp>
+#include <rtm_address.hpp>
+
+namespace RTM {
+
+/**
+ * @brief The forwarding decision of an IPv4 route
+ */
+struct rtm_next_hop {
+	uint32_t gateway_ip_u32;
+	std::string oif;
+
+	auto operator<=>(const rtm_next_hop&) const = default;
+};
+
+/**
+ * @brief The forwarding decision of an IPv6 route
+ */
+struct rtm_next_hop6 {
+	uint8_t gateway_ip[16] = {};  // IPv6 address in network byte order
+	std::string oif;
+
+	auto operator<=>(const rtm_next_hop6&) const = default;
+};
+
+/**
+ * @brief Aggregated FIB of an address family
+ *
+ * @tparam Family - the address family (see rtm_address.hpp)
+ * @tparam NextHop - the forwarding decision of a route, ordered
+ */
+template <typename Family, typename NextHop>
+class basic_rtm_fib {
+public:
+	using address = typename Family::address;
+	using next_hop = NextHop;
+
+	basic_rtm_fib() : root(std::make_unique<node>()) {};
+	~basic_rtm_fib() {};
+
+	basic_rtm_fib(const basic_rtm_fib &other);
+	basic_rtm_fib& operator=(const basic_rtm_fib &other);
+
+	/**
+	 * @brief Add a route or replace the next hop of a route
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @param nh - the next hop of the prefix
+	 */
+	void insert(address prefix, uint8_t len, const next_hop &nh);
+
+	/**
+	 * @brief Remove a route
+	 *
+	 * @param prefix - the prefix in host order
+	 * @param len - the prefix length in bits (0..Family::bits)
+	 * @return true if the route was removed, false if it was not found
+	 */
+	bool erase(address prefix, uint8_t len);
+
+	/**
+	 * @brief Find the next hop of an address
+	 *
+	 * @param addr - the address in host order
+	 * @return const next_hop* - the next hop of the longest prefix covering
+	 * the address or nullptr if there is no route
+	 */
+	const next_hop* lookup(address addr) const;
+
+	/**
+	 * @brief Find the next hop and the aggregated prefix of an address
+	 *
+	 * @param addr - the address in host order
+	 * @param len - set to the length of the longest aggregated prefix
+	 * covering the address
+	 * @return const next_hop* - the next hop or nullptr if there is no route
+	 * @note The next hop is valid until the next change of the FIB.
+	 */
+	const next_hop* lookup(address addr, uint8_t &len) const;
+
+	/**
+	 * @brief Call a function for each aggregated prefix
+	 *
+	 * @param func - called as func(prefix, len, next_hop) in prefix order
+	 */
+	template <typename Func>
+	void for_each(Func&& func) const
+	{
+		for_each(*this->root, 0, 0, func);
+	}
+
+	/**
+	 * @brief Remove all routes
+	 *
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the number of routes the FIB is fed with
+	 *
+	 * @return size_t - the number of routes
+	 */
+	size_t num_routes() const
+	{
+		return this->routes;
+	}
+
+	/**
+	 * @brief Get the number of aggregated prefixes
+	 *
+	 * @return size_t - the number of prefixes in the lookup structure
+	 */
+	size_t size() const
+	{
+		return this->fib.size();
+	}
+
+	/**
+	 * @brief Get the number of distinct next hops
+	 *
+	 * @return size_t - the number of next hops
+	 */
+	size_t num_next_hops() const
+	{
+		return this->ids.size();
+	}
+
+private:
+	// Next hop ids are indices into next_hops plus one, 0 is no next hop
+	static constexpr uint32_t NO_ROUTE = 0;
+	static constexpr uint32_t MIXED = ~uint32_t(0);
+
+	struct node {
+		std::unique_ptr<node> child[2];
+		uint32_t route = NO_ROUTE;    // next hop id of the route of this prefix
+		// The next hop id all addresses of this prefix resolve to by the
+		// routes of this prefix and below (NO_ROUTE: none of them, the
+		// covering route applies) or MIXED
+		uint32_t uniform = NO_ROUTE;
+		uint32_t aggregated = NO_ROUTE;  // next hop id of this prefix in fib
+	};
+
+	struct next_hop_slot {
+		next_hop nh;
+		size_t refs = 0;  // number of routes with this next hop
+	};
+
+	static unsigned bit(address prefix, uint8_t depth)
+	{
+		return static_cast<unsigned>(prefix >> (Family::bits - 1 - depth)) & 1u;
+	}
+
+	static address child_prefix(address prefix, uint8_t depth, unsigned i)
+	{
+		return prefix | (address(i) << (Family::bits - 1 - depth));
+	}
+
+	static std::unique_ptr<node> clone(const node &n);
+	static uint32_t uniform_of(const node &n);
+
+	template <typename Func>
+	void for_each(const node &n, address prefix, uint8_t depth, Func &func) const
+	{
+		if (n.aggregated != NO_ROUTE) {
+			func(prefix, depth, this->next_hops[n.aggregated - 1].nh);
+		}
+		for (unsigned i = 0; i < 2; ++i) {
+			if (n.child[i]) {
+				for_each(*n.child[i], child_prefix(prefix, depth, i),
+					 depth + 1, func);
+			}
+		}
+	}
+
+	uint32_t acquire(const next_hop &nh);
+	void release(uint32_t id);
+	void update(address prefix, uint8_t len, uint32_t route);
+	void aggregate(node &n, address prefix, uint8_t depth, uint32_t covering,
+		       bool visible);
+
+	std::unique_ptr<node> root;  // the routes
+	prefix_trie<uint32_t, Family> fib;  // the aggregated prefixes by next hop id
+	size_t routes = 0;
+	std::vector<next_hop_slot> next_hops;
+	std::vector<uint32_t> free_ids;
+	std::map<next_hop, uint32_t> ids;
+};
+
+using rtm_fib = basic_rtm_fib<inet4, rtm_next_hop>;
+using rtm_fib6 = basic_rtm_fib<inet6, rtm_next_hop6>;
+
+extern template class basic_rtm_fib<inet4, rtm_next_hop>;
+extern template class basic_rtm_fib<inet6, rtm_next_hop6>;
+
+}  // namespace RTM
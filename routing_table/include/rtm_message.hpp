@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) messages exchanged between the RTM server
+ * and its clients over a SOCK_SEQPACKET Unix domain socket.
+ *
+ * Each message is a single packet:
+ * 	<opcode><count>
+ * 	<record_1>...<record_count>
+ *
+ *  | Opcode        | Direction       | Records                       |
+ *  |---------------|-----------------|-------------------------------|
+ *  | RTM_CREATE    | server -> client| serialized routing entries    |
+ *  | RTM_UPDATE    | server -> client| update deltas (key, changed fields)|
+ *  | RTM_DELETE    | server -> client| serialized routing entries    |
+ *  | RTM_SUBSCRIBE | client -> server| serialized subscription filters|
+ *  | RTM_SYNC_DONE | server -> client| none, ring position of a ring client|
+ *  | RTM_RING_ATTACH| client -> server| none                         |
+ *  | RTM_RING      | server -> client| consumer index, ring fds (SCM_RIGHTS)|
+ *  | RTM_LOOKUP    | client -> server| batch id, addresses            |
+ *  | RTM_LOOKUP_REPLY| server -> client| batch id, next hops, routes  |
+ *  | RTM_CREATE6   | server -> client| serialized IPv6 routing entries|
+ *  | RTM_UPDATE6   | server -> client| IPv6 update deltas            |
+ *  | RTM_DELETE6   | server -> client| serialized IPv6 routing entries|
+ *
+ * The full table state is sent to a new client as a sequence of RTM_CREATE
+ * messages followed by RTM_SYNC_DONE.
+ *
+ * A client sending RTM_RING_ATTACH before RTM_SUBSCRIBE receives the CUD
+ * notifications through the shared memory ring of the server instead of its
+ * socket (see rtm_ring.hpp). The RTM_SYNC_DONE of such a client carries the
+ * 64 bit ring position of the table state. RTM_RING without file descriptors
+ * means the ring is not available and the client stays on its socket.
+ *
+ * A client may resolve addresses by the server instead of holding the table:
+ * it sends batches of up to RTM_MAX_LOOKUP_BATCH addresses as RTM_LOOKUP and
+ * may send further batches before the replies arrive. The server answers each
+ * batch in order with one RTM_LOOKUP_REPLY:
+ * 	<opcode><count><id><num_next_hops>
+ * 	<next_hop_1>...<next_hop_num_next_hops>	(gateway, OIF)
+ * 	<route_1>...<route_count>		(prefix length, next hop index)
+ * The next hops of a batch are sent once, the routes refer to them by their
+ * index plus one, 0 for an address without a route. A reply with no routes to
+ * a non-empty batch means the reply would exceed RTM_MAX_MSG_SIZE.
+ *
+ * The CUD messages of IPv6 entries (see routing_table6.hpp) have their own
+ * opcodes, their records have the format of the IPv4 ones with 16 byte
+ * addresses.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <span>
+
+#include <routing_table.hpp>
+#include <routing_table6.hpp>
+#include <rtm_fib.hpp>
+
+namespace RTM {
+
+/**
+ * @brief Default path of the RTM server socket
+ */
+constexpr const char *RTM_SOCKET_PATH = "/tmp/rtm_server.sock";
+
+/**
+ * @brief Maximum size of a single RTM message in bytes
+ */
+constexpr size_t RTM_MAX_MSG_SIZE = 64 * 1024;
+
+/**
+ * @brief Maximum number of addresses of a RTM_LOOKUP batch
+ */
+constexpr size_t RTM_MAX_LOOKUP_BATCH = 1024;
+
+/**
+ * @brief RTM Message Header Structure
+ *
+ * @note: all fields are given as 32 bit unsigned integers
+ */
+struct rtm_msg_hdr
+{
+	uint32_t opcode;  // cud_opcode_t
+	uint32_t count;   // number of records following the header
+};
+
+using rtm_msg_hdr_codec = wire::codec<rtm_msg_hdr,
+	wire::uint_field<&rtm_msg_hdr::opcode>,
+	wire::uint_field<&rtm_msg_hdr::count>>;
+
+/**
+ * @brief RTM_SYNC_DONE payload of a ring client
+ */
+struct rtm_sync_done
+{
+	uint64_t ring_position;  // of the notifications after the table state
+};
+
+using rtm_sync_done_codec = wire::codec<rtm_sync_done,
+	wire::uint_field<&rtm_sync_done::ring_position>>;
+
+/**
+ * @brief RTM_RING payload sent with the ring descriptors
+ */
+struct rtm_ring_info
+{
+	uint32_t consumer;  // consumer index of the client in the ring
+};
+
+using rtm_ring_info_codec = wire::codec<rtm_ring_info,
+	wire::uint_field<&rtm_ring_info::consumer>>;
+
+/**
+ * @brief RTM_LOOKUP payload ahead of the addresses (32 bit, host order)
+ */
+struct rtm_lookup
+{
+	uint32_t id;  // batch id, echoed by the reply
+};
+
+using rtm_lookup_codec = wire::codec<rtm_lookup,
+	wire::uint_field<&rtm_lookup::id>>;
+
+/**
+ * @brief RTM_LOOKUP_REPLY payload ahead of the next hops and the routes
+ */
+struct rtm_lookup_reply
+{
+	uint32_t id;             // batch id of the RTM_LOOKUP
+	uint32_t num_next_hops;  // number of next hops following
+};
+
+using rtm_lookup_reply_codec = wire::codec<rtm_lookup_reply,
+	wire::uint_field<&rtm_lookup_reply::id>,
+	wire::uint_field<&rtm_lookup_reply::num_next_hops>>;
+
+using rtm_next_hop_codec = wire::codec<rtm_fib::next_hop,
+	wire::uint_field<&rtm_fib::next_hop::gateway_ip_u32>,
+	wire::string_field<&rtm_fib::next_hop::oif>>;
+
+/**
+ * @brief Route of an address in a RTM_LOOKUP_REPLY
+ */
+struct rtm_lookup_result
+{
+	uint8_t prefix_len;  // of the longest (aggregated) prefix covering the address
+	uint16_t next_hop;   // index of the next hop in the reply plus one, 0: no route
+};
+
+using rtm_lookup_result_codec = wire::codec<rtm_lookup_result,
+	wire::uint_field<&rtm_lookup_result::prefix_len>,
+	wire::uint_field<&rtm_lookup_result::next_hop>>;
+
+
+/**
+ * @brief RTM Message Class
+ *
+ * Builds and parses RTM messages in a byte buffer.
+ *
+ */
+class rtm_message {
+public:
+	/**
+	 * @brief Start a new message in a buffer
+	 *
+	 * @param buffer - the buffer to reset and write the header into
+	 * @param opcode - the message opcode
+	 */
+	static void init(std::vector<uint8_t>& buffer, cud_opcode_t opcode);
+
+	/**
+	 * @brief Append a routing table entry to a message
+	 *
+	 * @param buffer - the buffer holding a message started with init()
+	 * @param entry - the routing table entry to append
+	 * @return size_t - the number of bytes appended to the buffer
+	 */
+	static size_t append_entry(std::vector<uint8_t>& buffer,
+				   const routing_table_entry& entry);
+
+	/**
+	 * @brief Build a message holding a single routing table entry
+	 *
+	 * @param opcode - the message opcode
+	 * @param entry - the routing table entry
+	 * @return std::vector<uint8_t> - the message
+	 */
+	static std::vector<uint8_t> make(cud_opcode_t opcode,
+					 const routing_table_entry& entry);
+
+	/**
+	 * @brief Append an IPv6 routing table entry to a message
+	 *
+	 * @param buffer - the buffer holding a message started with init()
+	 * @param entry - the routing table entry to append
+	 * @return size_t - the number of bytes appended to the buffer
+	 */
+	static size_t append_entry(std::vector<uint8_t>& buffer,
+				   const routing_table6_entry& entry);
+
+	/**
+	 * @brief Build a message holding a single IPv6 routing table entry
+	 *
+	 * @param opcode - the message opcode (RTM_CREATE6 or RTM_DELETE6)
+	 * @param entry - the routing table entry
+	 * @return std::vector<uint8_t> - the message
+	 */
+	static std::vector<uint8_t> make(cud_opcode_t opcode,
+					 const routing_table6_entry& entry);
+
+	/**
+	 * @brief Append an update delta to a RTM_UPDATE message
+	 *
+	 * @param buffer - the buffer holding a message started with init()
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return size_t - the number of bytes appended to the buffer
+	 */
+	static size_t append_delta(std::vector<uint8_t>& buffer,
+				   const routing_table_entry& entry, uint32_t fields);
+
+	/**
+	 * @brief Build a RTM_UPDATE message holding a single update delta
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return std::vector<uint8_t> - the message
+	 */
+	static std::vector<uint8_t> make_update(const routing_table_entry& entry,
+						uint32_t fields);
+
+	/**
+	 * @brief Append an IPv6 update delta to a RTM_UPDATE6 message
+	 *
+	 * @param buffer - the buffer holding a message started with init()
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return size_t - the number of bytes appended to the buffer
+	 */
+	static size_t append_delta(std::vector<uint8_t>& buffer,
+				   const routing_table6_entry& entry, uint32_t fields);
+
+	/**
+	 * @brief Build a RTM_UPDATE6 message holding a single update delta
+	 *
+	 * @param entry - the routing table entry holding the new field values
+	 * @param fields - the changed fields (rtm_field_t bitmask)
+	 * @return std::vector<uint8_t> - the message
+	 */
+	static std::vector<uint8_t> make_update(const routing_table6_entry& entry,
+						uint32_t fields);
+
+	/**
+	 * @brief Build a message with a fixed-layout payload
+	 *
+	 * @tparam Codec - the codec of the payload (e.g. rtm_sync_done_codec)
+	 * @param opcode - the message opcode
+	 * @param payload - the payload
+	 * @return std::vector<uint8_t> - the message
+	 */
+	template <typename Codec>
+	static std::vector<uint8_t> make(cud_opcode_t opcode,
+					 const typename Codec::value_type& payload)
+	{
+		static_assert(Codec::fixed);
+		std::vector<uint8_t> buffer(rtm_msg_hdr_codec::min_size + Codec::min_size);
+
+		const rtm_msg_hdr hdr = {static_cast<uint32_t>(opcode), 0};
+		Codec::encode(payload, rtm_msg_hdr_codec::encode(hdr, buffer.data()));
+
+		return buffer;
+	}
+
+	/**
+	 * @brief Decode a fixed-layout payload
+	 *
+	 * @tparam Codec - the codec of the payload (e.g. rtm_sync_done_codec)
+	 * @param payload - the message payload
+	 * @param value - the payload to populate
+	 * @return true if the payload has the size of the layout, false otherwise
+	 */
+	template <typename Codec>
+	static bool parse(std::span<const uint8_t> payload,
+			  typename Codec::value_type& value)
+	{
+		static_assert(Codec::fixed);
+		return payload.size() == Codec::min_size &&
+		       wire::read<Codec>(payload, value) == Codec::min_size;
+	}
+
+	/**
+	 * @brief Build a RTM_LOOKUP message
+	 *
+	 * @param buffer - the buffer to reset and write the message into
+	 * @param id - the batch id
+	 * @param addrs - up to RTM_MAX_LOOKUP_BATCH addresses in host order
+	 */
+	static void make_lookup(std::vector<uint8_t>& buffer, uint32_t id,
+				std::span<const uint32_t> addrs);
+
+	/**
+	 * @brief Build a RTM_LOOKUP_REPLY message
+	 *
+	 * @param buffer - the buffer to reset and write the message into
+	 * @param id - the batch id of the RTM_LOOKUP
+	 * @param next_hops - the next hops the results refer to
+	 * @param results - the routes of the addresses of the batch
+	 * @return true if the reply fits into RTM_MAX_MSG_SIZE, false if an
+	 * empty reply was built instead
+	 */
+	static bool make_lookup_reply(std::vector<uint8_t>& buffer, uint32_t id,
+				      std::span<const rtm_fib::next_hop* const> next_hops,
+				      std::span<const rtm_lookup_result> results);
+
+	/**
+	 * @brief Decode a RTM_LOOKUP_REPLY message payload
+	 *
+	 * @param hdr - the message header
+	 * @param payload - the message payload
+	 * @param reply - the reply header to populate
+	 * @param next_hops - the next hops to populate
+	 * @param results - the routes to populate, hdr.count of them
+	 * @return true if the payload is well-formed and the routes refer to
+	 * its next hops, false otherwise
+	 */
+	static bool parse_lookup_reply(const rtm_msg_hdr& hdr,
+				       std::span<const uint8_t> payload,
+				       rtm_lookup_reply& reply,
+				       std::vector<rtm_fib::next_hop>& next_hops,
+				       std::vector<rtm_lookup_result>& results);
+
+	/**
+	 * @brief Get the number of records in a message
+	 *
+	 * @param buffer - the buffer holding a message started with init()
+	 * @return uint32_t - the number of records
+	 * @note Throws std::invalid_argument if the buffer holds no header.
+	 */
+	static uint32_t count(const std::vector<uint8_t>& buffer);
+
+	/**
+	 * @brief Split a received message into header and payload
+	 *
+	 * @param packet - the received message
+	 * @param hdr - the message header to populate
+	 * @param payload - the message records
+	 * @return true if the message is well-formed, false otherwise
+	 */
+	static bool parse(std::span<const uint8_t> packet, rtm_msg_hdr& hdr,
+			  std::span<const uint8_t>& payload);
+
+	/**
+	 * @brief Decode all routing table entries of a message payload
+	 *
+	 * @tparam Entry - routing_table6_entry to decode IPv6 entries
+	 * @param hdr - the message header
+	 * @param payload - the message records
+	 * @param func - called with each decoded routing table entry
+	 * @return true if all records were decoded, false if the payload is
+	 * malformed
+	 */
+	template <typename Entry = routing_table_entry, typename Func>
+	static bool for_each_entry(const rtm_msg_hdr& hdr,
+				   std::span<const uint8_t> payload, Func&& func)
+	{
+		Entry entry;
+		const uint8_t *in = payload.data();
+		const uint8_t *end = payload.data() + payload.size();
+		for (uint32_t i = 0; i < hdr.count; ++i) {
+			in = routing_entry_codec<Entry>::decode(entry, in, end);
+			if (in == nullptr) {
+				return false;
+			}
+			func(entry);
+		}
+		return in == end;
+	}
+
+	/**
+	 * @brief Decode all addresses of a RTM_LOOKUP message payload
+	 *
+	 * @param hdr - the message header
+	 * @param payload - the message payload
+	 * @param lookup - the batch header to populate
+	 * @param func - called with each address in host order
+	 * @return true if all addresses were decoded, false if the payload is
+	 * malformed or the batch is too large
+	 */
+	template <typename Func>
+	static bool for_each_address(const rtm_msg_hdr& hdr,
+				     std::span<const uint8_t> payload,
+				     rtm_lookup& lookup, Func&& func)
+	{
+		if (hdr.count > RTM_MAX_LOOKUP_BATCH ||
+		    payload.size() != rtm_lookup_codec::min_size +
+				      hdr.count * sizeof(uint32_t)) {
+			return false;
+		}
+		const uint8_t *in = rtm_lookup_codec::decode(lookup, payload.data(),
+							      payload.data() + payload.size());
+		for (uint32_t i = 0; i < hdr.count; ++i, in += sizeof(uint32_t)) {
+			func(wire::load_le<uint32_t>(in));
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Decode all update deltas of a RTM_UPDATE message payload
+	 *
+	 * @tparam Entry - routing_table6_entry to decode IPv6 deltas
+	 * @param hdr - the message header
+	 * @param payload - the message records
+	 * @param func - called as func(entry, fields) with each decoded delta,
+	 * only the key and the changed fields of the entry are valid
+	 * @return true if all records were decoded, false if the payload is
+	 * malformed
+	 */
+	template <typename Entry = routing_table_entry, typename Func>
+	static bool for_each_delta(const rtm_msg_hdr& hdr,
+				   std::span<const uint8_t> payload, Func&& func)
+	{
+		Entry entry;
+		routing_table_delta<Entry> delta = {&entry, 0};
+		const uint8_t *in = payload.data();
+		const uint8_t *end = payload.data() + payload.size();
+		for (uint32_t i = 0; i < hdr.count; ++i) {
+			in = routing_table_delta_codec<Entry>::decode(delta, in, end);
+			if (in == nullptr || (delta.fields & ~RTM_FIELD_ALL)) {
+				return false;
+			}
+			func(entry, delta.fields);
+		}
+		return in == end;
+	}
+};
+
+}  // namespace RTM
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) pre-encoded table state.
+ *
+ * The full table state is sent to each new client as a sequence of RTM_CREATE
+ * messages (see rtm_message.hpp). Instead of encoding all entries for every
+ * client, the messages are kept encoded as pages:
+ *
+ * - each page is a complete RTM_CREATE message of up to the page size and
+ * holds the entries of a key range, the ranges of all pages cover the whole
+ * key space
+ * - a CUD operation invalidates only the page of its key, the next get()
+ * re-encodes the invalid pages from the table and splits them again at the
+ * page size, all other pages are reused as they are
+ * - the pages are shared and never modified, a page still queued for a
+ * client stays valid after it was replaced
+ *
+ * A client receiving the whole table is sent the pages by reference, without
+ * any encoding or copying by the server.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <routing_table.hpp>
+#include <rtm_message.hpp>
+
+namespace RTM {
+
+class rtm_pages {
+public:
+	using page_ptr = std::shared_ptr<const std::vector<uint8_t>>;
+
+	/**
+	 * @brief Construct a new pages object, all pages are invalid
+	 *
+	 * @param page_size - the maximum size of a page in bytes, a page holds
+	 * at least one entry
+	 */
+	explicit rtm_pages(size_t page_size = RTM_MAX_MSG_SIZE);
+	~rtm_pages() {};
+
+	/**
+	 * @brief Invalidate the page holding a key
+	 *
+	 * @param key - the key of a created, updated or deleted entry
+	 * @note Call for each CUD operation on the table, before or after it.
+	 */
+	void invalidate(uint32_t key);
+
+	/**
+	 * @brief Invalidate all pages
+	 *
+	 * @note Call if the table was replaced as a whole (cleared, loaded).
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the pages of the table, encoding the invalid ones
+	 *
+	 * @param table - the routing table all invalidations refer to
+	 * @return const std::vector<page_ptr>& - the RTM_CREATE messages of the
+	 * table in key order, empty pages are left out
+	 */
+	const std::vector<page_ptr>& get(const routing_table &table);
+
+	/**
+	 * @brief Get the number of entries encoded so far
+	 *
+	 * @return size_t - the number of entries encoded by all get() calls
+	 */
+	size_t num_encoded() const
+	{
+		return this->encoded;
+	}
+
+private:
+	using page_iterator = std::map<uint32_t, page_ptr>::iterator;
+
+	void encode(const routing_table &table, uint32_t first, page_iterator next);
+
+	size_t page_size;
+	// The pages by the first key of their range, which ends at the first key
+	// of the next page; nullptr for an invalid page
+	std::map<uint32_t, page_ptr> pages;
+	std::vector<page_ptr> valid;  // the non-empty pages, result of get()
+	bool changed = true;          // valid is out of date
+	size_t encoded = 0;
+};
+
+}  // namespace RTM
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) single-producer/multi-consumer shared
+ * memory ring.
+ *
+ * The RTM server writes each CUD notification once into the ring, every
+ * client follows the ring with its own read position. The cost of a broadcast
+ * does not depend on the number of clients.
+ *
+ * Memory layout (a memfd shared by the server with its clients):
+ * 	<header><consumer_1>...<consumer_max><data>
+ *
+ * - Records are appended at the 64 bit byte position 'head'. A record is
+ * 	<uint32_t length><uint32_t reserved><message padded to 8 bytes>
+ * and does not wrap around the end of the data area, the producer writes a
+ * wrap marker instead and continues at the start of the data area.
+ * - The producer never waits for consumers. Before overwriting it advances
+ * 'reserve', so a consumer detects if its record was overwritten while
+ * reading it (seqlock). A consumer more than the ring capacity behind the
+ * head is overrun and has to resynchronize its table.
+ * - A consumer going to sleep sets its need_wakeup flag, the producer signals
+ * only the sleeping consumers after a batch of records (see take_wakeup()).
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace RTM {
+
+/**
+ * @brief Default size of the RTM ring data area in bytes
+ */
+constexpr size_t RTM_RING_SIZE = 4 * 1024 * 1024;
+
+/**
+ * @brief Default maximum number of RTM ring consumers
+ */
+constexpr uint32_t RTM_RING_MAX_CONSUMERS = 1024;
+
+
+/**
+ * @brief RTM Shared Memory Ring Class
+ *
+ */
+class rtm_ring {
+public:
+	/**
+	 * @brief Result of a ring read
+	 */
+	enum read_status {
+		RING_OK,       // a message was read
+		RING_EMPTY,    // no message after the position
+		RING_OVERRUN,  // the position was overwritten, resynchronize
+	};
+
+	/**
+	 * @brief Create a new ring in an anonymous shared memory file
+	 *
+	 * @param size - the size of the data area in bytes, a power of two
+	 * @param max_consumers - the maximum number of consumers
+	 * @return std::unique_ptr<rtm_ring> - the ring, owned by the producer
+	 * @note Throws std::system_error if the shared memory could not be set up.
+	 */
+	static std::unique_ptr<rtm_ring> create(size_t size = RTM_RING_SIZE,
+						uint32_t max_consumers = RTM_RING_MAX_CONSUMERS);
+
+	/**
+	 * @brief Attach to a ring created by the producer
+	 *
+	 * @param fd - the shared memory file of the ring, owned by the ring
+	 * afterwards
+	 * @return std::unique_ptr<rtm_ring> - the ring
+	 * @note Throws std::system_error if the file could not be mapped and
+	 * std::invalid_argument if it does not hold a ring.
+	 */
+	static std::unique_ptr<rtm_ring> attach(int fd);
+
+	~rtm_ring();
+
+	rtm_ring(const rtm_ring&) = delete;
+	rtm_ring& operator=(const rtm_ring&) = delete;
+
+	/**
+	 * @brief Get the shared memory file descriptor
+	 *
+	 * @return int - the file descriptor to pass to the consumers
+	 */
+	int fd() const
+	{
+		return this->mem_fd;
+	}
+
+	/**
+	 * @brief Get the size of the data area
+	 *
+	 * @return size_t - the size in bytes
+	 */
+	size_t capacity() const
+	{
+		return this->size;
+	}
+
+	/**
+	 * @brief Get the maximum number of consumers
+	 *
+	 * @return uint32_t - the number of consumer slots
+	 */
+	uint32_t max_consumers() const;
+
+	/**
+	 * @brief Get the position after the last published record
+	 *
+	 * @return uint64_t - the ring position
+	 */
+	uint64_t head() const;
+
+	/**
+	 * @brief Append a message to the ring (producer only)
+	 *
+	 * @param msg - the message
+	 * @note Throws std::invalid_argument if the message is larger than a
+	 * quarter of the ring.
+	 */
+	void publish(std::span<const uint8_t> msg);
+
+	/**
+	 * @brief Read the message at a position (consumer)
+	 *
+	 * @param position - the read position, advanced past the message read
+	 * @param msg - the buffer to copy the message into
+	 * @return read_status - RING_OK if a message was read
+	 */
+	read_status read(uint64_t &position, std::vector<uint8_t> &msg) const;
+
+	/**
+	 * @brief Ask the producer for a wakeup before going to sleep (consumer)
+	 *
+	 * @param consumer - the consumer slot
+	 * @param position - the read position of the consumer
+	 * @return true if the consumer may sleep, false if messages were published
+	 * after the position in the meantime
+	 * @note Throws std::out_of_range for an invalid consumer slot.
+	 */
+	bool arm_wakeup(uint32_t consumer, uint64_t position);
+
+	/**
+	 * @brief Take the wakeup request of a consumer (producer)
+	 *
+	 * @param consumer - the consumer slot
+	 * @return true if the consumer sleeps and shall be signaled
+	 * @note Throws std::out_of_range for an invalid consumer slot.
+	 */
+	bool take_wakeup(uint32_t consumer);
+
+private:
+	rtm_ring(int fd, uint8_t *mem, size_t mem_size);
+
+	std::atomic<uint32_t>& need_wakeup(uint32_t consumer) const;
+
+	int mem_fd;
+	uint8_t *mem;
+	size_t mem_size;
+	uint8_t *data = nullptr;
+	size_t size = 0;
+};
+
+}  // namespace RTM
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) persistent store.
+ *
+ * The store keeps a routing table across restarts in a directory with two
+ * files:
+ *
+ * - rtm.snapshot: the table at some point in time in the routing_table
+ * serialization format, preceded by a header with a generation number and a
+ * checksum. It is written to a temporary file and renamed, so it is either
+ * the old or the new snapshot after a crash.
+ * - rtm.wal: the write-ahead log of the CUD operations since that snapshot,
+ * each one an RTM message (see rtm_message.hpp) with its length and checksum.
+ * The header holds the generation of the snapshot the log continues. A log of
+ * version 1 (updates logged as whole entries) is replayed and compacted into
+ * a snapshot on open().
+ *
+ * Operations are appended to a buffer and written with one write() and one
+ * fdatasync() per commit() (group commit). A snapshot is taken once the log is
+ * larger than the last snapshot (and the snapshot threshold), so replaying the
+ * log never takes longer than loading the snapshot.
+ *
+ * On open() the snapshot is mapped and read in place, then the log is
+ * replayed. A torn record at the end of the log (crash during a write) is
+ * truncated. A log of an older generation than the snapshot was already
+ * compacted into it and is discarded.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <routing_table.hpp>
+#include <rtm_message.hpp>
+
+namespace RTM {
+
+class rtm_store {
+public:
+	static constexpr size_t DEFAULT_SNAPSHOT_THRESHOLD = 16 * 1024 * 1024;
+
+	/**
+	 * @brief Construct a new store
+	 *
+	 * @param dir - the directory of the snapshot and the log, must exist
+	 * @param snapshot_threshold - the minimum log size in bytes to take a
+	 * snapshot at
+	 */
+	explicit rtm_store(const std::string &dir,
+			   size_t snapshot_threshold = DEFAULT_SNAPSHOT_THRESHOLD);
+	~rtm_store();
+
+	rtm_store(const rtm_store&) = delete;
+	rtm_store& operator=(const rtm_store&) = delete;
+
+	/**
+	 * @brief Load the table from the snapshot and the log, open the log
+	 *
+	 * @param table - the routing table to populate, should be empty
+	 * @note Throws std::system_error on I/O errors and std::runtime_error if
+	 * the snapshot is corrupt or newer logs than the snapshot exist.
+	 */
+	void open(routing_table &table);
+
+	/**
+	 * @brief Close the log, pending operations are committed
+	 *
+	 */
+	void close();
+
+	/**
+	 * @brief Append an operation to the log
+	 *
+	 * @param opcode - RTM_CREATE, RTM_UPDATE or RTM_DELETE
+	 * @param entry - the created, updated or deleted entry
+	 * @param fields - the updated fields (rtm_field_t bitmask), an update
+	 * is logged as a delta of these fields only
+	 * @note The operation is durable after the next commit().
+	 */
+	void append(cud_opcode_t opcode, const routing_table_entry &entry,
+		    uint32_t fields = RTM_FIELD_ALL);
+
+	/**
+	 * @brief Write the appended operations to the log and sync it
+	 *
+	 * @note Throws std::system_error if the log could not be written.
+	 */
+	void commit();
+
+	/**
+	 * @brief Check if the log has grown enough to be compacted
+	 *
+	 * @return true if snapshot() should be called
+	 */
+	bool needs_snapshot() const;
+
+	/**
+	 * @brief Write a snapshot of the table and start a new log
+	 *
+	 * @param table - the routing table with all appended operations applied
+	 * @note Throws std::system_error if the snapshot could not be written.
+	 */
+	void snapshot(const routing_table &table);
+
+	/**
+	 * @brief Get the generation of the last snapshot
+	 *
+	 * @return uint64_t - the generation, 0 before the first snapshot
+	 */
+	uint64_t generation() const
+	{
+		return this->gen;
+	}
+
+	/**
+	 * @brief Get the size of the log
+	 *
+	 * @return size_t - the committed size of the log in bytes
+	 */
+	size_t wal_size() const
+	{
+		return this->wal_bytes;
+	}
+
+	/**
+	 * @brief Get the number of operations replayed from the log by open()
+	 *
+	 * @return size_t - the number of replayed operations
+	 */
+	size_t num_replayed() const
+	{
+		return this->replayed;
+	}
+
+private:
+	void load_snapshot(routing_table &table);
+	void replay_wal(routing_table &table);
+	void reset_wal();
+	void sync_dir();
+
+	std::string dir;
+	size_t snapshot_threshold;
+	int wal_fd = -1;
+	uint64_t gen = 0;
+	size_t wal_bytes = 0;       // committed log size
+	size_t snapshot_bytes = 0;  // size of the last snapshot
+	size_t replayed = 0;
+	std::vector<uint8_t> pending;  // records appended since the last commit
+	std::vector<uint8_t> scratch;  // message buffer of append()
+};
+
+}  // namespace RTM
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) client subscriptions.
+ *
+ * A client may restrict the part of the routing table it receives by a list
+ * of filters. An entry is delivered to a client if it matches any of its
+ * filters; a client without filters receives the whole table.
+ *
+ *  | Filter          | Matches                                      |
+ *  |-----------------|----------------------------------------------|
+ *  | 10.0.0.0/8      | all routes inside of 10.0.0.0/8              |
+ *  | 0.0.0.0/0 eth1  | all routes out of eth1                       |
+ *  | 10.1.0.0/16 eth0| routes inside of 10.1.0.0/16 out of eth0     |
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <unordered_map>
+
+#include <routing_table.hpp>
+#include <prefix_trie.hpp>
+
+namespace RTM {
+
+/**
+ * @brief Subscription Filter Structure
+ *
+ */
+struct subscription_filter
+{
+	uint8_t prefix[4] = {0, 0, 0, 0};  // IPv4 prefix in dotted decimal format
+	uint8_t prefix_len = 0;            // CIDR notation, 0 matches any destination
+	std::string oif;                   // Output Interface, empty matches any OIF
+
+	/**
+	 * @brief Check if a routing table entry matches the filter
+	 *
+	 * @param entry - the routing table entry to check
+	 * @return true if the entry lies in the prefix range and goes out of the
+	 * filter OIF, false otherwise
+	 */
+	bool matches(const routing_table_entry& entry) const;
+
+	/**
+	 * @brief Check if a routing table entry matches a list of filters
+	 *
+	 * @param filters - the filters of a subscriber
+	 * @param entry - the routing table entry to check
+	 * @return true if any filter matches or the list is empty, false otherwise
+	 */
+	static bool matches(const std::vector<subscription_filter>& filters,
+			    const routing_table_entry& entry);
+
+	/**
+	 * @brief Check if a list of filters matches every routing table entry
+	 *
+	 * @param filters - the filters of a subscriber
+	 * @return true if the list is empty or has a filter without prefix
+	 * and OIF, false otherwise
+	 */
+	static bool matches_all(const std::vector<subscription_filter>& filters);
+
+	/**
+	 * @brief Parse a filter from its string representation
+	 *
+	 * @param str - the filter string "a.b.c.d/len[,oif]" or ",oif"
+	 * @param filter - the filter to populate
+	 * @return true if the string is a valid filter, false otherwise
+	 */
+	static bool from_string(const std::string& str, subscription_filter& filter);
+
+	bool operator==(const subscription_filter& other) const;
+
+	/**
+	 * @brief Serialize a list of filters
+	 *
+	 * Serialization format:
+	 * 	<num_filters>
+	 * 	<prefix><prefix_len><oif_bytes><oif> ... for each filter
+	 * @note: num_filters and oif_bytes are 32 bit unsigned integers, prefix
+	 * is 4 bytes and prefix_len is a single byte
+	 *
+	 * @param filters - the filters to serialize
+	 * @param buffer - the buffer to append the serialized data to
+	 * @return size_t - the number of bytes appended to the buffer
+	 */
+	static size_t serialize(const std::vector<subscription_filter>& filters,
+				std::vector<uint8_t>& buffer);
+
+	/**
+	 * @brief Deserialize a list of filters
+	 *
+	 * @param buffer - the buffer containing the serialized filters
+	 * @param filters - the filters to populate
+	 * @return size_t - the number of bytes read or 0 if the buffer is malformed
+	 */
+	static size_t deserialize(std::span<const uint8_t> buffer,
+				  std::vector<subscription_filter>& filters);
+};
+
+
+/**
+ * @brief Subscription Index Class
+ *
+ * Indexes the filters of all subscribers in a prefix trie, so finding the
+ * subscribers of an entry costs one walk along the entry destination bits
+ * instead of testing the filters of each subscriber.
+ *
+ */
+class subscription_index {
+public:
+	subscription_index() {};
+	~subscription_index() {};
+
+	/**
+	 * @brief Register the filters of a subscriber
+	 *
+	 * @param subscriber - the subscriber id (e.g. client socket)
+	 * @param filters - the subscriber filters, empty list subscribes to all
+	 * @note Filters of an already known subscriber are replaced.
+	 */
+	void subscribe(uint32_t subscriber,
+		       const std::vector<subscription_filter>& filters);
+
+	/**
+	 * @brief Remove a subscriber and all of its filters
+	 *
+	 * @param subscriber - the subscriber id
+	 */
+	void unsubscribe(uint32_t subscriber);
+
+	/**
+	 * @brief Find all subscribers interested in a routing table entry
+	 *
+	 * @param entry - the routing table entry
+	 * @param subscribers - cleared and filled with the sorted subscriber ids
+	 */
+	void match(const routing_table_entry& entry,
+		   std::vector<uint32_t>& subscribers) const;
+
+	/**
+	 * @brief Check if a subscriber is interested in a routing table entry
+	 *
+	 * @param subscriber - the subscriber id
+	 * @param entry - the routing table entry
+	 * @return true if the entry matches the subscriber filters
+	 */
+	bool matches(uint32_t subscriber, const routing_table_entry& entry) const;
+
+	/**
+	 * @brief Get the number of subscribers
+	 *
+	 * @return size_t - the number of subscribers
+	 */
+	size_t size() const
+	{
+		return this->filters.size();
+	}
+
+private:
+	struct bucket {
+		std::vector<uint32_t> any_oif;  // subscribers of the prefix
+		std::unordered_map<std::string, std::vector<uint32_t>> by_oif;
+
+		bool empty() const
+		{
+			return any_oif.empty() && by_oif.empty();
+		}
+	};
+
+	prefix_trie<bucket> trie;
+	std::unordered_map<uint32_t, std::vector<subscription_filter>> filters;
+};
+
+}  // namespace RTM
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Lock-free single-producer/single-consumer queue.
+ *
+ * Unbounded queue of fixed size segments: the producer appends a new segment
+ * once the last one is full, the consumer frees the segments it consumed.
+ * push() and pop() never block and never wait for the other side, so two
+ * threads exchanging messages in both directions cannot deadlock.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace RTM {
+
+template <typename T, size_t SEGMENT_SIZE = 1024>
+class spsc_queue {
+public:
+	spsc_queue() :
+		head(new segment()), tail(head)
+	{
+	}
+
+	~spsc_queue()
+	{
+		while (this->head != nullptr) {
+			auto *next = this->head->next.load(std::memory_order_relaxed);
+			delete this->head;
+			this->head = next;
+		}
+	}
+
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	/**
+	 * @brief Append an item (producer thread only)
+	 *
+	 * @param item - the item to append
+	 */
+	void push(T item)
+	{
+		if (this->tail_index == SEGMENT_SIZE) {
+			auto *next = new segment();
+			this->tail->next.store(next, std::memory_order_release);
+			this->tail = next;
+			this->tail_index = 0;
+		}
+		this->tail->items[this->tail_index] = std::move(item);
+		this->tail->written.store(++this->tail_index, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Remove the oldest item (consumer thread only)
+	 *
+	 * @param item - the item to populate
+	 * @return true if an item was removed, false if the queue is empty
+	 */
+	bool pop(T &item)
+	{
+		if (this->head_index == SEGMENT_SIZE) {
+			auto *next = this->head->next.load(std::memory_order_acquire);
+			if (next == nullptr) {
+				return false;
+			}
+			delete this->head;
+			this->head = next;
+			this->head_index = 0;
+		}
+		if (this->head_index == this->head->written.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = std::move(this->head->items[this->head_index]);
+		// Release the item resources in the consumer
+		this->head->items[this->head_index++] = T();
+
+		return true;
+	}
+
+private:
+	struct segment {
+		T items[SEGMENT_SIZE];
+		std::atomic<size_t> written = 0;  // items published by the producer
+		std::atomic<segment*> next = nullptr;
+	};
+
+	// Consumer side
+	alignas(64) segment *head;
+	size_t head_index = 0;
+
+	// Producer side
+	alignas(64) segment *tail;
+	size_t tail_index = 0;
+};
+
+}  // namespace RTM
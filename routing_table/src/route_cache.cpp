@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) route cache implementation
+ */
+
+#include <algorithm>
+#include <bit>
+
+#include <route_cache.hpp>
+
+
+using namespace RTM;
+
+route_cache::route_cache(size_t num_slots) :
+	slots(std::bit_ceil(std::max<size_t>(num_slots, 2))),
+	index_shift(32 - std::countr_zero(this->slots.size()))
+{
+}
+
+size_t route_cache::index_of(uint32_t addr) const
+{
+	// Fibonacci hashing: neighbour addresses spread over the slots
+	return static_cast<uint32_t>(addr * 2654435769u) >> this->index_shift;
+}
+
+const routing_table_entry* route_cache::lookup(const routing_table &table,
+					       uint32_t addr)
+{
+	auto &s = this->slots[this->index_of(addr)];
+
+	if (s.generation == this->generation && s.addr == addr) {
+		this->num_hits++;
+		return s.entry;
+	}
+
+	this->num_misses++;
+	s.addr = addr;
+	s.generation = this->generation;
+	s.entry = table.lookup(addr);
+
+	return s.entry;
+}
+
+void route_cache::invalidate(uint32_t prefix, uint8_t len)
+{
+	len = std::min<uint8_t>(len, 32);
+	if ((uint64_t(1) << (32 - len)) > this->slots.size()) {
+		this->clear();
+		return;
+	}
+
+	const uint32_t first = prefix & (~uint32_t(0) << (32 - len));
+	const uint32_t last = first | ((uint32_t(1) << (32 - len)) - 1);
+	for (uint32_t addr = first; ; ++addr) {
+		auto &s = this->slots[this->index_of(addr)];
+		if (s.addr == addr) {
+			s.generation = 0;
+		}
+		if (addr == last) {
+			break;
+		}
+	}
+}
+
+void route_cache::invalidate(const routing_table_entry &entry)
+{
+	this->invalidate(routing_table_entry::ip2host(entry.destination_ip),
+			 entry.destination_mask);
+}
+
+void route_cache::clear()
+{
+	this->num_flushes++;
+	if (++this->generation == 0) {
+		// Wrapped around: slots of an old generation would become valid
+		std::fill(this->slots.begin(), this->slots.end(), slot());
+		this->generation = 1;
+	}
+}
+
+void route_cache::reset_stats()
+{
+	this->num_hits = 0;
+	this->num_misses = 0;
+	this->num_flushes = 0;
+}
@@ -1,18 +1,295 @@
-#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
 
 #include <routing_table.hpp>
-#include <iomanip>
+#include <routing_table6.hpp>
 
 
 /**
- * @note All serializations used are based on simple casting. This is done for
- * sake of simplicitay of this teaching project. The serialization shall use
- * an architecture inedependent approach in case  of productve applications.
- *
+ * @note The serializations use the little-endian field codecs of rtm_codec.hpp.
  */
 
 using namespace RTM;
 
+static_assert(routing_table_entry_codec::min_size ==
+	      5 * sizeof(uint32_t) + sizeof(routing_table_entry::destination_ip) +
+	      sizeof(routing_table_entry::gateway_ip) +
+	      sizeof(routing_table_entry::destination_mask));
+
+/**
+ * @brief Get the prefix length of an entry
+ *
+ * @param entry - the routing table entry
+ * @return uint8_t - the destination mask, at most Family::bits
+ */
+template <typename Family, typename Entry>
+static uint8_t prefix_len(const Entry &entry)
+{
+	return std::min(entry.destination_mask, Family::bits);
+}
+
+/**
+ * @brief Get the destination prefix of an entry with the host bits cleared
+ *
+ * @param entry - the routing table entry
+ * @return Family::address - the prefix in host order
+ */
+template <typename Family, typename Entry>
+static typename Family::address prefix_of(const Entry &entry)
+{
+	return Family::load(entry.destination_ip) &
+	       Family::mask(prefix_len<Family>(entry));
+}
+
+static constexpr std::string_view TEXT_HEADER =
+	"Key\t | Destination IP/Mask\t | Gateway IP\t | OIF\n";
+static constexpr size_t DUMP_CHUNK_SIZE = 64 * 1024;
+static constexpr size_t MAX_TEXT_LINE = 192;  // without the OIF, fits IPv6
+
+static char* put_uint(char *out, uint32_t value)
+{
+	char digits[10];
+	size_t n = 0;
+
+	do {
+		digits[n++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	while (n > 0) {
+		*out++ = digits[--n];
+	}
+
+	return out;
+}
+
+static char* put_ip(char *out, const uint8_t (&ip)[4])
+{
+	for (size_t i = 0; i < sizeof(ip); ++i) {
+		if (i != 0) {
+			*out++ = '.';
+		}
+		out = put_uint(out, ip[i]);
+	}
+
+	return out;
+}
+
+static char* put_ip(char *out, const uint8_t (&ip)[16])
+{
+	inet_ntop(AF_INET6, ip, out, INET6_ADDRSTRLEN);
+
+	return out + std::strlen(out);
+}
+
+static char* put_hex(char *out, uint32_t value)
+{
+	static constexpr char digits[] = "0123456789abcdef";
+
+	*out++ = '0';
+	*out++ = 'x';
+	for (int shift = 28; shift >= 0; shift -= 4) {
+		*out++ = digits[(value >> shift) & 0xf];
+	}
+
+	return out;
+}
+
+static char* put_str(char *out, std::string_view str)
+{
+	std::memcpy(out, str.data(), str.size());
+
+	return out + str.size();
+}
+
+/**
+ * @brief Append the text line of an entry, see routing_table::to_string()
+ *
+ * @param out - the buffer to append to
+ * @param entry - the routing table entry
+ */
+static void append_text(std::string &out, const routing_table_entry &entry)
+{
+	static constexpr std::string_view delim = "\t | ";
+	char line[MAX_TEXT_LINE];
+	char *p = line;
+
+	p = put_ip(p, entry.destination_ip);
+	p = put_str(p, delim);
+	p = put_ip(p, entry.destination_ip);
+	p = put_str(p, " (");
+	p = put_hex(p, entry.destination_ip_u32);
+	p = put_str(p, ")/");
+	p = put_uint(p, entry.destination_mask);
+	p = put_str(p, delim);
+	p = put_ip(p, entry.gateway_ip);
+	p = put_str(p, " (");
+	p = put_hex(p, entry.gateway_ip_u32);
+	p = put_str(p, ")");
+	p = put_str(p, delim);
+
+	out.append(line, p - line);
+	out += entry.oif;
+	out += '\n';
+}
+
+static void append_text(std::string &out, const routing_table6_entry &entry)
+{
+	static constexpr std::string_view delim = "\t | ";
+	char line[MAX_TEXT_LINE];
+	char *p = line;
+
+	p = put_ip(p, entry.destination_ip);
+	p = put_str(p, delim);
+	p = put_ip(p, entry.destination_ip);
+	p = put_str(p, "/");
+	p = put_uint(p, entry.destination_mask);
+	p = put_str(p, delim);
+	p = put_ip(p, entry.gateway_ip);
+	p = put_str(p, delim);
+
+	out.append(line, p - line);
+	out += entry.oif;
+	out += '\n';
+}
+
+static void write_all(int fd, std::string_view data)
+{
+	while (!data.empty()) {
+		const ssize_t written = write(fd, data.data(), data.size());
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), "write");
+		}
+		data.remove_prefix(written);
+	}
+}
+
+static bool is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static void skip_blanks(std::string_view &str)
+{
+	while (!str.empty() && is_blank(str.front())) {
+		str.remove_prefix(1);
+	}
+}
+
+static bool parse_uint(std::string_view &str, uint32_t max, uint32_t &value)
+{
+	size_t n = 0;
+
+	value = 0;
+	while (n < str.size() && str[n] >= '0' && str[n] <= '9') {
+		value = value * 10 + (str[n] - '0');
+		if (value > max) {
+			return false;
+		}
+		n++;
+	}
+	str.remove_prefix(n);
+
+	return n > 0;
+}
+
+static bool parse_ip(std::string_view &str, uint8_t (&ip)[4])
+{
+	for (size_t i = 0; i < sizeof(ip); ++i) {
+		uint32_t octet;
+		if (i != 0) {
+			if (str.empty() || str.front() != '.') {
+				return false;
+			}
+			str.remove_prefix(1);
+		}
+		if (!parse_uint(str, 255, octet)) {
+			return false;
+		}
+		ip[i] = static_cast<uint8_t>(octet);
+	}
+
+	return true;
+}
+
+static bool parse_ip(std::string_view &str, uint8_t (&ip)[16])
+{
+	char text[INET6_ADDRSTRLEN];
+	size_t n = 0;
+
+	while (n < str.size() && n < sizeof(text) - 1 &&
+	       (std::isxdigit(static_cast<unsigned char>(str[n])) || str[n] == ':' ||
+		str[n] == '.')) {
+		text[n] = str[n];
+		n++;
+	}
+	text[n] = '\0';
+	if (inet_pton(AF_INET6, text, ip) != 1) {
+		return false;
+	}
+	str.remove_prefix(n);
+
+	return true;
+}
+
+enum parse_result {LINE_ENTRY, LINE_EMPTY, LINE_INVALID};
+
+/**
+ * @brief Parse a "<destination>/<mask> <gateway> <oif>" line
+ *
+ * @param line - the line without the line break
+ * @param entry - the routing table entry to populate
+ * @return parse_result - LINE_EMPTY for empty and comment lines
+ */
+template <typename Entry>
+static parse_result parse_line(std::string_view line, Entry &entry)
+{
+	uint32_t mask;
+
+	skip_blanks(line);
+	if (line.empty() || line.front() == '#') {
+		return LINE_EMPTY;
+	}
+	if (!parse_ip(line, entry.destination_ip) || line.empty() ||
+	    line.front() != '/') {
+		return LINE_INVALID;
+	}
+	line.remove_prefix(1);
+	if (!parse_uint(line, sizeof(entry.destination_ip) * 8, mask) || line.empty() || !is_blank(line.front())) {
+		return LINE_INVALID;
+	}
+	entry.destination_mask = static_cast<uint8_t>(mask);
+
+	skip_blanks(line);
+	if (!parse_ip(line, entry.gateway_ip) || line.empty() ||
+	    !is_blank(line.front())) {
+		return LINE_INVALID;
+	}
+
+	skip_blanks(line);
+	size_t oif_len = 0;
+	while (oif_len < line.size() && !is_blank(line[oif_len])) {
+		oif_len++;
+	}
+	if (oif_len == 0) {
+		return LINE_INVALID;
+	}
+	entry.oif.assign(line.substr(0, oif_len));
+	line.remove_prefix(oif_len);
+	skip_blanks(line);
+
+	return line.empty() ? LINE_ENTRY : LINE_INVALID;
+}
+
 size_t routing_table_entry::size() const
 {
 	return sizeof(this->destination_ip_u32) +
@@ -47,223 +324,438 @@ std::string routing_table_entry::destination_ip2str(
 	return str;
 }
 
+bool routing_table_entry::str2ip(const std::string& str, uint8_t (&ip)[4])
+{
+	size_t pos = 0;
+	for (size_t i = 0; i < sizeof(ip); ++i) {
+		unsigned int octet = 0;
+		size_t digits = 0;
+		while (pos < str.size() && str[pos] >= '0' && str[pos] <= '9' &&
+		       digits < 3) {
+			octet = octet * 10 + (str[pos] - '0');
+			digits++;
+			pos++;
+		}
+		if (digits == 0 || octet > 255) {
+			return false;
+		}
+		if (i != sizeof(ip) - 1) {
+			if (pos >= str.size() || str[pos] != '.') {
+				return false;
+			}
+			pos++;
+		}
+		ip[i] = static_cast<uint8_t>(octet);
+	}
+	return pos == str.size();
+}
+
 size_t routing_table_entry::serialize(const routing_table_entry &entry,
 				      std::vector<uint8_t>& buffer)
 {
-	const uint32_t total_bytes = entry.size() + 5 * sizeof(uint32_t);
+	buffer.resize(entry.serialized_size(), 0);
 
-	size_t offset = 0;
-	uint32_t size_tmp = 0;
+	return serialize(entry, buffer.data());
+}
 
-	buffer.resize(total_bytes, 0);
-	buffer.clear();
+size_t routing_table_entry::serialize(const routing_table_entry &entry,
+				      uint8_t *out)
+{
+	return routing_table_entry_codec::encode(entry, out) - out;
+}
 
-	std::memcpy(buffer.data() + offset, &total_bytes, sizeof(total_bytes));
-	offset += sizeof(total_bytes);
+size_t routing_table_entry::deserialize(const std::vector<uint8_t>& buffer,
+					routing_table_entry &entry)
+{
+	return deserialize(std::span<const uint8_t>(buffer.data(), buffer.size()),
+			   entry);
+}
 
-	// Serialize destination IP:
-	size_tmp = sizeof(entry.destination_ip_u32);
-	std::memcpy(buffer.data() + offset, &size_tmp, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
-	std::memcpy(buffer.data() + offset, &entry.destination_ip_u32,
-			sizeof(entry.destination_ip_u32));
-	offset += sizeof(entry.destination_ip_u32);
+size_t routing_table_entry::deserialize(std::span<const uint8_t> buffer,
+					routing_table_entry &entry)
+{
+	return wire::read<routing_table_entry_codec>(buffer, entry);
+}
 
-	// Serialize gateway IP:
-	size_tmp = sizeof(entry.gateway_ip_u32);
-	std::memcpy(buffer.data() + offset, &size_tmp, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
-	std::memcpy(buffer.data() + offset, &entry.gateway_ip_u32,
-			sizeof(entry.gateway_ip_u32));
-	offset += sizeof(entry.gateway_ip_u32);
+size_t routing_table_entry::delta_size(uint32_t fields) const
+{
+	return routing_table_delta_codec<const routing_table_entry>::size({this, fields});
+}
 
-	// Serialize mask:
-	size_tmp = sizeof(entry.destination_mask);
-	std::memcpy(buffer.data() + offset, &size_tmp, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
-	std::memcpy(buffer.data() + offset, &entry.destination_mask,
-			sizeof(entry.destination_mask));
-	offset += sizeof(entry.destination_mask);
+size_t routing_table_entry::serialize_delta(const routing_table_entry &entry,
+					    uint32_t fields, uint8_t *out)
+{
+	const routing_table_delta<const routing_table_entry> delta = {
+		&entry, fields & RTM_FIELD_ALL};
 
-	// Serialize OIF:
-	size_tmp = entry.oif.size();
-	std::memcpy(buffer.data() + offset, &size_tmp, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
-	std::memcpy(buffer.data() + offset, entry.oif.c_str(),
-			entry.oif.size());
-	offset += entry.oif.size();
+	return routing_table_delta_codec<const routing_table_entry>::encode(delta, out) - out;
+}
 
-	assert(offset == total_bytes);
+size_t routing_table_entry::deserialize_delta(std::span<const uint8_t> buffer,
+					      routing_table_entry &entry,
+					      uint32_t &fields)
+{
+	routing_table_delta<routing_table_entry> delta = {&entry, 0};
 
-	return total_bytes;
+	const size_t size = wire::read<routing_table_delta_codec<routing_table_entry>>(
+		buffer, delta);
+	fields = delta.fields;
+
+	return (fields & ~RTM_FIELD_ALL) ? 0 : size;
 }
 
-size_t routing_table_entry::deserialize(const std::vector<uint8_t>& buffer,
-					routing_table_entry &entry)
+template <typename Family>
+void basic_routing_table<Family>::create_entry(const entry_type &entry)
 {
-	size_t offset = 0;
-	uint32_t size_tmp = 0;
-	uint32_t total_size = 0;
+	auto [it, inserted] = this->table.try_emplace(routing_family<Family>::key(entry),
+						      entry);
+	if (!inserted) {
+		// The prefix length may change with the replacement
+		this->unindex_entry(it->second);
+		it->second = entry;
+	}
+	if (this->indexed) {
+		this->index_entry(entry);
+	}
+}
 
-	std::memcpy(&total_size, buffer.data() + offset, sizeof(total_size));
-	offset += sizeof(total_size);
+template <typename Family>
+void basic_routing_table<Family>::bulk_load(std::vector<entry_type> &entries)
+{
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const entry_type &a, const entry_type &b) {
+			return routing_family<Family>::key(a) < routing_family<Family>::key(b);
+		});
+
+	auto hint = this->table.begin();
+	for (auto &entry : entries) {
+		hint = std::next(this->insert_entry(hint, std::move(entry)));
+	}
+}
 
-	std::memcpy(&size_tmp, buffer.data() + offset, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
+template <typename Family>
+auto basic_routing_table<Family>::insert_entry(table_iterator hint, entry_type &&entry)
+	-> table_iterator
+{
+	const auto size = this->table.size();
+	const auto it = this->table.try_emplace(hint, routing_family<Family>::key(entry),
+						std::move(entry));
+
+	if (this->table.size() == size) {
+		// Replacement of an existing entry
+		this->unindex_entry(it->second);
+		it->second = std::move(entry);
+	}
+	if (this->indexed) {
+		this->index_entry(it->second);
+	}
 
-	std::memcpy(entry.destination_ip, buffer.data() + offset,
-			size_tmp);
-	offset += sizeof(destination_ip);
+	return it;
+}
+
+template <typename Family>
+bool basic_routing_table<Family>::update_entry(const entry_type &entry, uint32_t fields)
+{
+	const auto it = this->table.find(routing_family<Family>::key(entry));
+	if (it == this->table.end()) {
+		return false;
+	}
+	auto &stored = it->second;
+
+	if (fields & RTM_FIELD_GATEWAY) {
+		std::copy(std::begin(entry.gateway_ip), std::end(entry.gateway_ip),
+			  stored.gateway_ip);
+	}
+	if (fields & RTM_FIELD_OIF) {
+		stored.oif = entry.oif;
+	}
+	if ((fields & RTM_FIELD_MASK) &&
+	    stored.destination_mask != entry.destination_mask) {
+		// The entry moves to another prefix
+		this->unindex_entry(stored);
+		stored.destination_mask = entry.destination_mask;
+		if (this->indexed) {
+			this->index_entry(stored);
+		}
+	} else if (fields & (RTM_FIELD_GATEWAY | RTM_FIELD_OIF)) {
+		this->update_fib(prefix_of<Family>(stored), prefix_len<Family>(stored));
+	}
 
-	std::memcpy(&size_tmp, buffer.data() + offset, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
+	return true;
+}
 
-	std::memcpy(entry.gateway_ip, buffer.data() + offset,
-			size_tmp);
-	offset += sizeof(gateway_ip);
+template <typename Family>
+void basic_routing_table<Family>::delete_entry(const entry_type &entry)
+{
+	const auto it = this->table.find(routing_family<Family>::key(entry));
+	if (it != this->table.end()) {
+		this->unindex_entry(it->second);
+		this->table.erase(it);
+	}
+}
 
-	std::memcpy(&size_tmp, buffer.data() + offset, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
+template <typename Family>
+auto basic_routing_table<Family>::lookup(address addr) const -> const entry_type*
+{
+	this->build_index();
 
-	std::memcpy(&entry.destination_mask, buffer.data() + offset,
-			size_tmp);
-	offset += sizeof(destination_mask);
+	const auto *keys = this->prefixes.lookup(addr);
+	if (keys == nullptr) {
+		return nullptr;
+	}
 
-	std::memcpy(&size_tmp, buffer.data() + offset, sizeof(size_tmp));
-	offset += sizeof(size_tmp);
+	return &this->table.at(keys->front());
+}
 
-	entry.oif.resize(size_tmp);
-	std::memcpy(&entry.oif[0], buffer.data() + offset, size_tmp);
-	offset += size_tmp;
+template <typename Family>
+void basic_routing_table<Family>::set_aggregation(bool enable)
+{
+	if (!enable) {
+		this->fib.reset();
+		return;
+	}
+	if (this->fib) {
+		return;
+	}
 
-	assert(total_size == offset);
+	this->build_index();
+	this->fib.emplace();
+	for (const auto &[key, entry] : this->table) {
+		this->update_fib(prefix_of<Family>(entry), prefix_len<Family>(entry));
+	}
+}
 
-	return total_size;
+template <typename Family>
+void basic_routing_table<Family>::build_index() const
+{
+	if (!this->indexed) {
+		for (const auto &[key, entry] : this->table) {
+			this->index_entry(entry);
+		}
+		this->indexed = true;
+	}
 }
 
-void routing_table::create_entry(const routing_table_entry &entry)
+template <typename Family>
+void basic_routing_table<Family>::index_entry(const entry_type &entry) const
 {
-	this->table[entry.destination_ip_u32] = entry;
+	const uint8_t len = prefix_len<Family>(entry);
+	const address prefix = prefix_of<Family>(entry);
+
+	this->prefixes.insert(prefix, len).push_back(routing_family<Family>::key(entry));
+	this->update_fib(prefix, len);
 }
 
-void routing_table::update_entry(const routing_table_entry &entry)
+template <typename Family>
+void basic_routing_table<Family>::update_fib(address prefix, uint8_t len) const
 {
+	if (!this->fib) {
+		return;
+	}
+
+	// The first entry of a prefix is the one lookup() returns
+	const auto *keys = this->prefixes.find(prefix, len);
+	if (keys == nullptr) {
+		this->fib->erase(prefix, len);
+		return;
+	}
+	const auto &entry = this->table.at(keys->front());
+	this->fib->insert(prefix, len, routing_family<Family>::next_hop(entry));
 }
 
-void routing_table::delete_entry(const routing_table_entry &entry)
+template <typename Family>
+void basic_routing_table<Family>::unindex_entry(const entry_type &entry)
 {
-	this->table.erase(entry.destination_ip_u32);
+	const uint8_t len = prefix_len<Family>(entry);
+	const address prefix = prefix_of<Family>(entry);
+
+	if (!this->indexed) {
+		return;
+	}
+	auto *keys = this->prefixes.find(prefix, len);
+	if (keys == nullptr) {
+		return;
+	}
+	keys->erase(std::remove(keys->begin(), keys->end(), routing_family<Family>::key(entry)),
+		    keys->end());
+	if (keys->empty()) {
+		this->prefixes.erase(prefix, len);
+	}
+	this->update_fib(prefix, len);
 }
 
-size_t routing_table::serialize(routing_table &table, std::vector<uint8_t> &buffer)
+template <typename Family>
+size_t basic_routing_table<Family>::serialize(const basic_routing_table &table,
+					      std::vector<uint8_t> &buffer)
 {
-	// Total size consists of:
-	// - 4 bytes for total size
-	// - 4 bytes for number of entries
-	// - size of each serialized entry (will be calculated later)
-	uint32_t total_size = 4 + 4;
-	size_t offset = 4;  // buffer offset in bytes - start with number of entries
+	// @note: it is not necessary to serialize the keys, since they are
+	// already included in each entry
+	routing_table_header hdr = {routing_table_header_codec::min_size,
+				    static_cast<uint32_t>(table.size())};
 
-	const uint32_t num_entries = static_cast<uint32_t>(table.size());
-	std::memcpy(buffer.data() + offset, &num_entries, sizeof(num_entries));
-	offset += sizeof(num_entries);
+	for (const auto& [key, entry] : table.table) {
+		hdr.total_size += routing_entry_codec<entry_type>::size(entry);
+	}
+	if (buffer.size() < hdr.total_size) {
+		buffer.resize(hdr.total_size);
+	}
 
-	std::vector<uint8_t> entry_buffer;
+	uint8_t *out = routing_table_header_codec::encode(hdr, buffer.data());
 	for (const auto& [key, entry] : table.table) {
-		// @note: it is not necessary to serialize the keys, since they
-		// are already included in each entry
-		const auto bytes_written = routing_table_entry::serialize(entry, entry_buffer);
-		std::memcpy(buffer.data() + offset, entry_buffer.data(),
-				bytes_written);
-		total_size += bytes_written;
-		offset += bytes_written;
+		out = routing_entry_codec<entry_type>::encode(entry, out);
 	}
-	std::memcpy(buffer.data(), &total_size, sizeof(total_size));
 
-	return static_cast<size_t>(total_size);
+	return static_cast<size_t>(hdr.total_size);
 }
 
-size_t routing_table::deserialize(const std::vector<uint8_t>& buffer,
-				  routing_table &table)
+template <typename Family>
+size_t basic_routing_table<Family>::deserialize(const std::vector<uint8_t>& buffer,
+						basic_routing_table &table)
 {
-	uint32_t total_size = 0;
-	uint32_t num_entries = 0;
-	size_t offset = 0;
+	return deserialize(std::span<const uint8_t>(buffer.data(), buffer.size()),
+			   table);
+}
 
-	std::memcpy(&total_size, buffer.data() + offset, sizeof(total_size));
-	offset += sizeof(total_size);
+template <typename Family>
+size_t basic_routing_table<Family>::deserialize(std::span<const uint8_t> buffer,
+						basic_routing_table &table)
+{
+	routing_table_header hdr;
 
-	std::memcpy(&num_entries, buffer.data() + offset, sizeof(num_entries));
-	offset += sizeof(num_entries);
+	if (wire::read<routing_table_header_codec>(buffer, hdr) == 0 ||
+	    hdr.total_size > buffer.size()) {
+		throw std::invalid_argument("truncated routing table");
+	}
 
-	routing_table_entry entry;
-	uint32_t entry_cnt = 0;
-	uint32_t entry_size = 0;
-	std::vector<uint8_t> entry_buffer;
-	while(entry_cnt < num_entries) {
-		entry_buffer.clear();
-		std::memcpy(&entry_size, buffer.data() + offset, sizeof(entry_size));
-		entry_buffer.resize(entry_size, 0);
-		std::memcpy(entry_buffer.data(), buffer.data() + offset, entry_size);
+	const uint8_t *in = buffer.data() + routing_table_header_codec::min_size;
+	const uint8_t *end = buffer.data() + hdr.total_size;
+	entry_type entry;
+	auto hint = table.table.begin();
+	for (uint32_t i = 0; i < hdr.num_entries; ++i) {
+		// Entries are read in place, each one has to fit into the table
+		in = routing_entry_codec<entry_type>::decode(entry, in, end);
+		if (in == nullptr) {
+			throw std::invalid_argument("invalid routing table entry");
+		}
+		// The entries are serialized in key order
+		hint = std::next(table.insert_entry(hint, std::move(entry)));
+	}
 
-		const auto bytes_read =
-			routing_table_entry::deserialize(entry_buffer, entry);
-		table.create_entry(entry);
+	return static_cast<size_t>(in - buffer.data());
+}
 
-		offset += bytes_read;
-		entry_cnt++;
-	}
+template <typename Family>
+std::string basic_routing_table<Family>::to_string() const
+{
+	std::string str;
+
+	this->dump(str);
 
-	return static_cast<size_t>(offset);
+	return str;
 }
 
-bool routing_table::operator==(const routing_table& other) const
+template <typename Family>
+void basic_routing_table<Family>::dump(std::string &out) const
 {
-	if (this->size() != other.size()) {
-		return false;
+	out += TEXT_HEADER;
+	for (const auto& [key, entry] : this->table) {
+		append_text(out, entry);
 	}
+}
 
-	for(size_t i = 0; i < this->size(); ++i) {
-		const auto& entry = this->table.begin()->second;
-		const auto& other_entry = other.table.begin()->second;
-		if (entry != other_entry) {
-			return false;
+template <typename Family>
+void basic_routing_table<Family>::dump(int fd) const
+{
+	std::string buffer;
+
+	buffer.reserve(DUMP_CHUNK_SIZE + MAX_TEXT_LINE);
+	buffer += TEXT_HEADER;
+	for (const auto& [key, entry] : this->table) {
+		append_text(buffer, entry);
+		if (buffer.size() >= DUMP_CHUNK_SIZE) {
+			write_all(fd, buffer);
+			buffer.clear();
 		}
 	}
+	write_all(fd, buffer);
+}
 
-	return true;
+template <typename Family>
+size_t basic_routing_table<Family>::load_text(std::string_view text)
+{
+	std::vector<entry_type> entries;
+	size_t line_num = 0;
+
+	while (!text.empty()) {
+		const auto eol = text.find('\n');
+		const auto line = text.substr(0, eol);
+		text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+		line_num++;
+
+		entry_type entry;
+		switch (parse_line(line, entry)) {
+		case LINE_ENTRY:
+			entries.push_back(std::move(entry));
+			break;
+		case LINE_EMPTY:
+			break;
+		case LINE_INVALID:
+			throw std::invalid_argument("invalid route in line " +
+						    std::to_string(line_num) + ": " +
+						    std::string(line));
+		}
+	}
+	this->bulk_load(entries);
+
+	return entries.size();
 }
 
-std::string routing_table::to_string() const
+template <typename Family>
+size_t basic_routing_table<Family>::load_text(int fd)
 {
-	// This function is still under development and may not be complete.
-	std::string delim = "\t | ";
-	std::string str = "Key" + delim + "Destination IP/Mask" + delim +
-			  "Gateway IP"+ delim + "OIF\n";
-	for (const auto& [key, entry] : this->table) {
-		std::stringstream ss1;
-		ss1 << std::hex << std::setw(8) << std::setfill('0')
-		    << entry.destination_ip_u32;
-		const auto destination_ip_str =
-			std::to_string(entry.destination_ip[0]) + "." +
-			std::to_string(entry.destination_ip[1]) + "." +
-			std::to_string(entry.destination_ip[2]) + "." +
-			std::to_string(entry.destination_ip[3]) +
-			" (" + "0x" + ss1.str() + ")";
-		std::stringstream ss2;
-		ss2 << std::hex << std::setw(8) << std::setfill('0')
-		    << entry.gateway_ip_u32;
-		const auto gateway_ip_str = \
-			std::to_string(entry.gateway_ip[0]) + "." +
-			std::to_string(entry.gateway_ip[1]) + "." +
-			std::to_string(entry.gateway_ip[2]) + "." +
-			std::to_string(entry.gateway_ip[3]) +
-			" (" + "0x" + ss2.str() + ")";
-
-		const auto& key_str = entry.destination_ip2str(entry);
-		str += key_str + delim + destination_ip_str + "/" +
-			std::to_string(entry.destination_mask) + delim +
-			gateway_ip_str + delim + entry.oif + "\n";
+	struct stat st;
+
+	if (fstat(fd, &st) < 0) {
+		throw std::system_error(errno, std::generic_category(), "fstat");
 	}
-	return str;
+	if (S_ISREG(st.st_mode) && st.st_size > 0) {
+		// Parse the page cache in place
+		const size_t size = static_cast<size_t>(st.st_size);
+		void *mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mem == MAP_FAILED) {
+			throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+		madvise(mem, size, MADV_SEQUENTIAL);
+		try {
+			const auto num_entries = this->load_text(
+				std::string_view(static_cast<const char*>(mem), size));
+			munmap(mem, size);
+			return num_entries;
+		} catch (...) {
+			munmap(mem, size);
+			throw;
+		}
+	}
+
+	// Pipes and other streams
+	std::string text;
+	char buf[DUMP_CHUNK_SIZE];
+	while (true) {
+		const ssize_t len = read(fd, buf, sizeof(buf));
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), "read");
+		}
+		if (len == 0) {
+			break;
+		}
+		text.append(buf, len);
+	}
+
+	return this->load_text(text);
 }
+
+template class RTM::basic_routing_table<inet4>;
+template class RTM::basic_routing_table<inet6>;
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief IPv6 Routing Table Entry implementation, the table is the one of
+ * routing_table.cpp
+ */
+
+#include <routing_table6.hpp>
+
+
+using namespace RTM;
+
+size_t routing_table6_entry::serialized_size() const
+{
+	return routing_table6_entry_codec::size(*this);
+}
+
+size_t routing_table6_entry::delta_size(uint32_t fields) const
+{
+	return routing_table_delta_codec<const routing_table6_entry>::size({this, fields});
+}
+
+size_t routing_table6_entry::serialize(const routing_table6_entry &entry, uint8_t *out)
+{
+	return routing_table6_entry_codec::encode(entry, out) - out;
+}
+
+size_t routing_table6_entry::deserialize(std::span<const uint8_t> buffer,
+					 routing_table6_entry &entry)
+{
+	return wire::read<routing_table6_entry_codec>(buffer, entry);
+}
+
+size_t routing_table6_entry::serialize_delta(const routing_table6_entry &entry,
+					     uint32_t fields, uint8_t *out)
+{
+	const routing_table_delta<const routing_table6_entry> delta = {
+		&entry, fields & RTM_FIELD_ALL};
+
+	return routing_table_delta_codec<const routing_table6_entry>::encode(delta, out) - out;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) aggregated forwarding table implementation
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <rtm_fib.hpp>
+
+
+using namespace RTM;
+
+template <typename Family, typename NextHop>
+basic_rtm_fib<Family, NextHop>::basic_rtm_fib(const basic_rtm_fib &other) :
+	root(clone(*other.root)), fib(other.fib), routes(other.routes),
+	next_hops(other.next_hops), free_ids(other.free_ids), ids(other.ids)
+{
+}
+
+template <typename Family, typename NextHop>
+auto basic_rtm_fib<Family, NextHop>::operator=(const basic_rtm_fib &other)
+	-> basic_rtm_fib&
+{
+	if (this != &other) {
+		this->root = clone(*other.root);
+		this->fib = other.fib;
+		this->routes = other.routes;
+		this->next_hops = other.next_hops;
+		this->free_ids = other.free_ids;
+		this->ids = other.ids;
+	}
+	return *this;
+}
+
+template <typename Family, typename NextHop>
+auto basic_rtm_fib<Family, NextHop>::clone(const node &n) -> std::unique_ptr<node>
+{
+	auto copy = std::make_unique<node>();
+
+	copy->route = n.route;
+	copy->uniform = n.uniform;
+	copy->aggregated = n.aggregated;
+	for (unsigned i = 0; i < 2; ++i) {
+		if (n.child[i]) {
+			copy->child[i] = clone(*n.child[i]);
+		}
+	}
+	return copy;
+}
+
+template <typename Family, typename NextHop>
+uint32_t basic_rtm_fib<Family, NextHop>::uniform_of(const node &n)
+{
+	if (!n.child[0] && !n.child[1]) {
+		return n.route;
+	}
+
+	// The route of this prefix applies to the addresses not covered below
+	uint32_t half[2];
+	for (unsigned i = 0; i < 2; ++i) {
+		const uint32_t uniform = n.child[i] ? n.child[i]->uniform : NO_ROUTE;
+		half[i] = uniform == NO_ROUTE ? n.route : uniform;
+	}
+	return half[0] == half[1] ? half[0] : MIXED;
+}
+
+template <typename Family, typename NextHop>
+uint32_t basic_rtm_fib<Family, NextHop>::acquire(const next_hop &nh)
+{
+	auto [it, inserted] = this->ids.try_emplace(nh, NO_ROUTE);
+
+	if (inserted) {
+		if (this->free_ids.empty()) {
+			this->next_hops.push_back({nh, 0});
+			it->second = static_cast<uint32_t>(this->next_hops.size());
+		} else {
+			it->second = this->free_ids.back();
+			this->free_ids.pop_back();
+			this->next_hops[it->second - 1].nh = nh;
+		}
+	}
+	this->next_hops[it->second - 1].refs++;
+
+	return it->second;
+}
+
+template <typename Family, typename NextHop>
+void basic_rtm_fib<Family, NextHop>::release(uint32_t id)
+{
+	auto &slot = this->next_hops[id - 1];
+
+	if (--slot.refs == 0) {
+		this->ids.erase(slot.nh);
+		this->free_ids.push_back(id);
+	}
+}
+
+template <typename Family, typename NextHop>
+void basic_rtm_fib<Family, NextHop>::insert(address prefix, uint8_t len, const next_hop &nh)
+{
+	len = std::min(len, Family::bits);
+
+	const uint32_t id = this->acquire(nh);
+	node *n = this->root.get();
+	for (uint8_t depth = 0; depth < len; ++depth) {
+		auto &child = n->child[bit(prefix, depth)];
+		if (!child) {
+			child = std::make_unique<node>();
+		}
+		n = child.get();
+	}
+
+	const uint32_t old = n->route;
+	this->update(prefix & Family::mask(len), len, id);
+	if (old == NO_ROUTE) {
+		this->routes++;
+	} else {
+		this->release(old);
+	}
+}
+
+template <typename Family, typename NextHop>
+bool basic_rtm_fib<Family, NextHop>::erase(address prefix, uint8_t len)
+{
+	len = std::min(len, Family::bits);
+
+	const node *n = this->root.get();
+	for (uint8_t depth = 0; n && depth < len; ++depth) {
+		n = n->child[bit(prefix, depth)].get();
+	}
+	if (n == nullptr || n->route == NO_ROUTE) {
+		return false;
+	}
+
+	const uint32_t old = n->route;
+	this->update(prefix & Family::mask(len), len, NO_ROUTE);
+	this->release(old);
+	this->routes--;
+
+	return true;
+}
+
+template <typename Family, typename NextHop>
+void basic_rtm_fib<Family, NextHop>::update(address prefix, uint8_t len, uint32_t route)
+{
+	node *path[Family::bits + 1];
+
+	path[0] = this->root.get();
+	for (uint8_t depth = 0; depth < len; ++depth) {
+		path[depth + 1] = path[depth]->child[bit(prefix, depth)].get();
+	}
+	if (path[len]->route == route) {
+		return;
+	}
+	path[len]->route = route;
+
+	// The prefixes above can only change if their address space was or
+	// becomes uniform
+	int top = len;
+	for (int depth = len; depth >= 0; --depth) {
+		const uint32_t uniform = uniform_of(*path[depth]);
+		if (depth < len && uniform == path[depth]->uniform) {
+			break;
+		}
+		path[depth]->uniform = uniform;
+		top = depth;
+	}
+
+	// Nothing below a uniform prefix is aggregated, so its unchanged
+	// aggregate hides the change
+	uint32_t covering = NO_ROUTE;
+	bool visible = true;
+	for (int depth = 0; depth < top && visible; ++depth) {
+		visible = path[depth]->uniform == MIXED;
+		if (path[depth]->route != NO_ROUTE) {
+			covering = path[depth]->route;
+		}
+	}
+	if (visible) {
+		this->aggregate(*path[top], prefix & Family::mask(top), top, covering, true);
+	}
+
+	// Prune the nodes without routes below, they are never aggregated
+	for (int depth = len; depth > 0; --depth) {
+		const node &n = *path[depth];
+		if (n.route != NO_ROUTE || n.child[0] || n.child[1]) {
+			break;
+		}
+		assert(n.aggregated == NO_ROUTE);
+		path[depth - 1]->child[bit(prefix, depth - 1)].reset();
+	}
+}
+
+template <typename Family, typename NextHop>
+void basic_rtm_fib<Family, NextHop>::aggregate(node &n, address prefix, uint8_t depth,
+						 uint32_t covering, bool visible)
+{
+	uint32_t aggregated = NO_ROUTE;
+
+	if (visible) {
+		if (n.uniform != MIXED) {
+			// One prefix for the whole address space, none below
+			if (n.uniform != NO_ROUTE && n.uniform != covering) {
+				aggregated = n.uniform;
+			}
+			visible = false;
+		} else if (n.route != NO_ROUTE) {
+			if (n.route != covering) {
+				aggregated = n.route;
+			}
+			covering = n.route;
+		}
+	}
+
+	if (aggregated != n.aggregated) {
+		if (n.aggregated != NO_ROUTE) {
+			this->fib.erase(prefix, depth);
+		}
+		if (aggregated != NO_ROUTE) {
+			this->fib.insert(prefix, depth) = aggregated;
+		}
+		n.aggregated = aggregated;
+	}
+
+	for (unsigned i = 0; i < 2; ++i) {
+		if (n.child[i]) {
+			this->aggregate(*n.child[i], child_prefix(prefix, depth, i),
+					depth + 1, covering, visible);
+		}
+	}
+}
+
+template <typename Family, typename NextHop>
+auto basic_rtm_fib<Family, NextHop>::lookup(address addr) const -> const next_hop*
+{
+	uint8_t len;
+
+	return this->lookup(addr, len);
+}
+
+template <typename Family, typename NextHop>
+auto basic_rtm_fib<Family, NextHop>::lookup(address addr, uint8_t &len) const -> const next_hop*
+{
+	uint32_t id = NO_ROUTE;
+
+	// The matches are visited from the shortest to the longest prefix
+	len = 0;
+	this->fib.for_each_match(addr, Family::bits, [&](uint8_t match_len, uint32_t match) {
+		id = match;
+		len = match_len;
+	});
+
+	return id != NO_ROUTE ? &this->next_hops[id - 1].nh : nullptr;
+}
+
+template <typename Family, typename NextHop>
+void basic_rtm_fib<Family, NextHop>::clear()
+{
+	this->root = std::make_unique<node>();
+	this->fib.clear();
+	this->routes = 0;
+	this->next_hops.clear();
+	this->free_ids.clear();
+	this->ids.clear();
+}
+
+template class RTM::basic_rtm_fib<inet4, rtm_next_hop>;
+template class RTM::basic_rtm_fib<inet6, rtm_next_hop6>;
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) messages implementation
+ */
+
+#include <stdexcept>
+
+#include <rtm_message.hpp>
+
+
+using namespace RTM;
+
+/**
+ * @brief Read the header of a message under construction
+ *
+ * @param buffer - the buffer holding a message started with init()
+ * @return rtm_msg_hdr - the header
+ * @note Throws std::invalid_argument if the buffer holds no header.
+ */
+static rtm_msg_hdr read_header(const std::vector<uint8_t>& buffer)
+{
+	rtm_msg_hdr hdr{};
+
+	if (!rtm_msg_hdr_codec::decode(hdr, buffer.data(),
+				       buffer.data() + buffer.size())) {
+		throw std::invalid_argument("no RTM message header");
+	}
+	return hdr;
+}
+
+/**
+ * @brief Increment the record count in the header of a message
+ *
+ * @param buffer - the buffer holding a message started with init()
+ */
+static void add_record(std::vector<uint8_t>& buffer)
+{
+	auto hdr = read_header(buffer);
+
+	hdr.count++;
+	rtm_msg_hdr_codec::encode(hdr, buffer.data());
+}
+
+void rtm_message::init(std::vector<uint8_t>& buffer, cud_opcode_t opcode)
+{
+	const rtm_msg_hdr hdr = {static_cast<uint32_t>(opcode), 0};
+
+	buffer.resize(rtm_msg_hdr_codec::min_size);
+	rtm_msg_hdr_codec::encode(hdr, buffer.data());
+}
+
+/**
+ * @brief Append a routing table entry of any address family to a message
+ */
+template <typename Entry>
+static size_t append_record(std::vector<uint8_t>& buffer, const Entry& entry)
+{
+	const size_t offset = buffer.size();
+
+	// Serialized in place, without an intermediate buffer
+	buffer.resize(offset + entry.serialized_size());
+	Entry::serialize(entry, buffer.data() + offset);
+
+	add_record(buffer);
+
+	return buffer.size() - offset;
+}
+
+template <typename Entry>
+static std::vector<uint8_t> make_record(cud_opcode_t opcode, const Entry& entry)
+{
+	std::vector<uint8_t> buffer;
+
+	buffer.reserve(rtm_msg_hdr_codec::min_size + entry.serialized_size());
+	rtm_message::init(buffer, opcode);
+	append_record(buffer, entry);
+
+	return buffer;
+}
+
+/**
+ * @brief Append an update delta of any address family to a message
+ */
+template <typename Entry>
+static size_t append_delta_record(std::vector<uint8_t>& buffer, const Entry& entry,
+				  uint32_t fields)
+{
+	const size_t offset = buffer.size();
+
+	buffer.resize(offset + entry.delta_size(fields));
+	Entry::serialize_delta(entry, fields, buffer.data() + offset);
+
+	add_record(buffer);
+
+	return buffer.size() - offset;
+}
+
+template <typename Entry>
+static std::vector<uint8_t> make_delta_record(cud_opcode_t opcode, const Entry& entry,
+					      uint32_t fields)
+{
+	std::vector<uint8_t> buffer;
+
+	buffer.reserve(rtm_msg_hdr_codec::min_size + entry.delta_size(fields));
+	rtm_message::init(buffer, opcode);
+	append_delta_record(buffer, entry, fields);
+
+	return buffer;
+}
+
+size_t rtm_message::append_entry(std::vector<uint8_t>& buffer,
+				 const routing_table_entry& entry)
+{
+	return append_record(buffer, entry);
+}
+
+std::vector<uint8_t> rtm_message::make(cud_opcode_t opcode,
+				       const routing_table_entry& entry)
+{
+	return make_record(opcode, entry);
+}
+
+size_t rtm_message::append_entry(std::vector<uint8_t>& buffer,
+				 const routing_table6_entry& entry)
+{
+	return append_record(buffer, entry);
+}
+
+std::vector<uint8_t> rtm_message::make(cud_opcode_t opcode,
+				       const routing_table6_entry& entry)
+{
+	return make_record(opcode, entry);
+}
+
+size_t rtm_message::append_delta(std::vector<uint8_t>& buffer,
+				 const routing_table_entry& entry, uint32_t fields)
+{
+	return append_delta_record(buffer, entry, fields);
+}
+
+std::vector<uint8_t> rtm_message::make_update(const routing_table_entry& entry,
+					      uint32_t fields)
+{
+	return make_delta_record(RTM_UPDATE, entry, fields);
+}
+
+size_t rtm_message::append_delta(std::vector<uint8_t>& buffer,
+				 const routing_table6_entry& entry, uint32_t fields)
+{
+	return append_delta_record(buffer, entry, fields);
+}
+
+std::vector<uint8_t> rtm_message::make_update(const routing_table6_entry& entry,
+					      uint32_t fields)
+{
+	return make_delta_record(RTM_UPDATE6, entry, fields);
+}
+
+void rtm_message::make_lookup(std::vector<uint8_t>& buffer, uint32_t id,
+			      std::span<const uint32_t> addrs)
+{
+	const rtm_msg_hdr hdr = {RTM_LOOKUP, static_cast<uint32_t>(addrs.size())};
+
+	buffer.resize(rtm_msg_hdr_codec::min_size + rtm_lookup_codec::min_size +
+		      addrs.size() * sizeof(uint32_t));
+
+	uint8_t *out = rtm_msg_hdr_codec::encode(hdr, buffer.data());
+	out = rtm_lookup_codec::encode({id}, out);
+	for (const uint32_t addr : addrs) {
+		wire::store_le(out, addr);
+		out += sizeof(addr);
+	}
+}
+
+bool rtm_message::make_lookup_reply(std::vector<uint8_t>& buffer, uint32_t id,
+				    std::span<const rtm_fib::next_hop* const> next_hops,
+				    std::span<const rtm_lookup_result> results)
+{
+	size_t size = rtm_msg_hdr_codec::min_size + rtm_lookup_reply_codec::min_size +
+		      results.size() * rtm_lookup_result_codec::min_size;
+
+	for (const auto *nh : next_hops) {
+		size += rtm_next_hop_codec::size(*nh);
+	}
+	if (size > RTM_MAX_MSG_SIZE) {
+		// Too many or too long OIFs: the client retries with smaller batches
+		buffer.resize(rtm_msg_hdr_codec::min_size + rtm_lookup_reply_codec::min_size);
+		rtm_lookup_reply_codec::encode({id, 0}, rtm_msg_hdr_codec::encode(
+			{RTM_LOOKUP_REPLY, 0}, buffer.data()));
+		return false;
+	}
+	buffer.resize(size);
+
+	const rtm_msg_hdr hdr = {RTM_LOOKUP_REPLY, static_cast<uint32_t>(results.size())};
+	const rtm_lookup_reply reply = {id, static_cast<uint32_t>(next_hops.size())};
+	uint8_t *out = rtm_msg_hdr_codec::encode(hdr, buffer.data());
+	out = rtm_lookup_reply_codec::encode(reply, out);
+	for (const auto *nh : next_hops) {
+		out = rtm_next_hop_codec::encode(*nh, out);
+	}
+	for (const auto &result : results) {
+		out = rtm_lookup_result_codec::encode(result, out);
+	}
+
+	return true;
+}
+
+bool rtm_message::parse_lookup_reply(const rtm_msg_hdr& hdr,
+				     std::span<const uint8_t> payload,
+				     rtm_lookup_reply& reply,
+				     std::vector<rtm_fib::next_hop>& next_hops,
+				     std::vector<rtm_lookup_result>& results)
+{
+	const uint8_t *in = payload.data();
+	const uint8_t *end = payload.data() + payload.size();
+
+	in = rtm_lookup_reply_codec::decode(reply, in, end);
+	if (in == nullptr || hdr.count > RTM_MAX_LOOKUP_BATCH ||
+	    reply.num_next_hops > hdr.count) {
+		return false;
+	}
+
+	next_hops.resize(reply.num_next_hops);
+	for (auto &nh : next_hops) {
+		in = rtm_next_hop_codec::decode(nh, in, end);
+		if (in == nullptr) {
+			return false;
+		}
+	}
+
+	if (static_cast<size_t>(end - in) != hdr.count * rtm_lookup_result_codec::min_size) {
+		return false;
+	}
+	results.resize(hdr.count);
+	for (auto &result : results) {
+		in = rtm_lookup_result_codec::decode(result, in, end);
+		if (result.next_hop > reply.num_next_hops) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t rtm_message::count(const std::vector<uint8_t>& buffer)
+{
+	return read_header(buffer).count;
+}
+
+bool rtm_message::parse(std::span<const uint8_t> packet, rtm_msg_hdr& hdr,
+			std::span<const uint8_t>& payload)
+{
+	if (wire::read<rtm_msg_hdr_codec>(packet, hdr) == 0) {
+		return false;
+	}
+	payload = packet.subspan(rtm_msg_hdr_codec::min_size);
+
+	return hdr.opcode <= RTM_DELETE6;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) pre-encoded table state implementation
+ */
+
+#include <iterator>
+
+#include <rtm_pages.hpp>
+
+
+using namespace RTM;
+
+rtm_pages::rtm_pages(size_t page_size) : page_size(page_size)
+{
+	this->clear();
+}
+
+void rtm_pages::invalidate(uint32_t key)
+{
+	// The first page starts at key 0, so each key has a page
+	auto &page = std::prev(this->pages.upper_bound(key))->second;
+	if (page) {
+		page.reset();
+		this->changed = true;
+	}
+}
+
+void rtm_pages::clear()
+{
+	this->pages.clear();
+	this->pages.emplace(0, nullptr);
+	this->changed = true;
+}
+
+const std::vector<rtm_pages::page_ptr>& rtm_pages::get(const routing_table &table)
+{
+	if (!this->changed) {
+		return this->valid;
+	}
+
+	auto it = this->pages.begin();
+	while (it != this->pages.end()) {
+		if (it->second) {
+			++it;
+			continue;
+		}
+
+		// Adjacent invalid pages are encoded as one range, so pages
+		// shrunk by deletes are merged again
+		auto next = std::next(it);
+		while (next != this->pages.end() && !next->second) {
+			++next;
+		}
+		const uint32_t first = it->first;
+		it = this->pages.erase(it, next);
+		this->encode(table, first, next);
+	}
+
+	this->valid.clear();
+	for (const auto &[key, page] : this->pages) {
+		if (page->size() > sizeof(rtm_msg_hdr)) {
+			this->valid.push_back(page);
+		}
+	}
+	this->changed = false;
+
+	return this->valid;
+}
+
+void rtm_pages::encode(const routing_table &table, uint32_t first, page_iterator next)
+{
+	const bool bounded = next != this->pages.end();
+	const uint32_t last = bounded ? next->first : 0;
+	std::vector<uint8_t> msg;
+	uint32_t page_key = first;
+
+	rtm_message::init(msg, RTM_CREATE);
+	msg.reserve(this->page_size);
+	table.for_each_from(first, [&](const routing_table_entry &entry) {
+		const uint32_t key = entry.destination_ip_u32;
+		if (bounded && key >= last) {
+			return false;
+		}
+		if (msg.size() + entry.serialized_size() > this->page_size &&
+		    msg.size() > sizeof(rtm_msg_hdr)) {
+			this->pages.emplace_hint(next, page_key,
+				std::make_shared<const std::vector<uint8_t>>(std::move(msg)));
+			rtm_message::init(msg, RTM_CREATE);
+			msg.reserve(this->page_size);
+			page_key = key;
+		}
+		rtm_message::append_entry(msg, entry);
+		this->encoded++;
+		return true;
+	});
+
+	// The last page covers the rest of the range, even if it is empty
+	msg.shrink_to_fit();
+	this->pages.emplace_hint(next, page_key,
+		std::make_shared<const std::vector<uint8_t>>(std::move(msg)));
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) shared memory ring implementation
+ */
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <rtm_ring.hpp>
+
+
+using namespace RTM;
+
+static constexpr uint32_t RING_MAGIC = 0x52544d52;  // "RTMR"
+static constexpr uint32_t RING_VERSION = 1;
+static constexpr uint32_t RING_WRAP = ~uint32_t(0);
+static constexpr size_t RECORD_HDR_SIZE = 2 * sizeof(uint32_t);
+static constexpr size_t CACHE_LINE = 64;
+
+struct ring_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+	uint32_t max_consumers;
+	alignas(CACHE_LINE) std::atomic<uint64_t> reserve;
+	alignas(CACHE_LINE) std::atomic<uint64_t> head;
+};
+
+struct alignas(CACHE_LINE) ring_consumer {
+	std::atomic<uint32_t> need_wakeup;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+	      "the ring requires address-free 64 bit atomics");
+
+static size_t align_up(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static ring_header& hdr_of(uint8_t *mem)
+{
+	return *reinterpret_cast<ring_header*>(mem);
+}
+
+static size_t data_offset(uint32_t max_consumers)
+{
+	const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+	return align_up(align_up(sizeof(ring_header), CACHE_LINE) +
+			max_consumers * sizeof(ring_consumer), page_size);
+}
+
+std::unique_ptr<rtm_ring> rtm_ring::create(size_t size, uint32_t max_consumers)
+{
+	if (size < 4096 || (size & (size - 1)) != 0) {
+		throw std::invalid_argument("ring size must be a power of two");
+	}
+
+	const int fd = memfd_create("rtm_ring", MFD_CLOEXEC);
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "memfd_create");
+	}
+
+	const size_t mem_size = data_offset(max_consumers) + size;
+	if (ftruncate(fd, static_cast<off_t>(mem_size)) < 0) {
+		const auto err = errno;
+		close(fd);
+		throw std::system_error(err, std::generic_category(), "ftruncate");
+	}
+	void *mem = mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		const auto err = errno;
+		close(fd);
+		throw std::system_error(err, std::generic_category(), "mmap");
+	}
+
+	// The file is zero filled: no records and no sleeping consumers
+	auto *hdr = new (mem) ring_header;
+	hdr->magic = RING_MAGIC;
+	hdr->version = RING_VERSION;
+	hdr->size = size;
+	hdr->max_consumers = max_consumers;
+	hdr->reserve.store(0, std::memory_order_relaxed);
+	hdr->head.store(0, std::memory_order_release);
+
+	return std::unique_ptr<rtm_ring>(new rtm_ring(fd, static_cast<uint8_t*>(mem),
+						      mem_size));
+}
+
+std::unique_ptr<rtm_ring> rtm_ring::attach(int fd)
+{
+	struct stat st = {};
+
+	if (fstat(fd, &st) < 0) {
+		const auto err = errno;
+		close(fd);
+		throw std::system_error(err, std::generic_category(), "fstat");
+	}
+	const auto mem_size = static_cast<size_t>(st.st_size);
+	if (mem_size < sizeof(ring_header)) {
+		close(fd);
+		throw std::invalid_argument("not an RTM ring");
+	}
+	void *mem = mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		const auto err = errno;
+		close(fd);
+		throw std::system_error(err, std::generic_category(), "mmap");
+	}
+
+	// Owns fd and mem from here on
+	std::unique_ptr<rtm_ring> ring(new rtm_ring(fd, static_cast<uint8_t*>(mem),
+						     mem_size));
+	const auto &hdr = hdr_of(ring->mem);
+	if (hdr.magic != RING_MAGIC || hdr.version != RING_VERSION ||
+	    hdr.size < 4096 || (hdr.size & (hdr.size - 1)) != 0 ||
+	    data_offset(hdr.max_consumers) + hdr.size != mem_size) {
+		throw std::invalid_argument("not an RTM ring");
+	}
+
+	return ring;
+}
+
+rtm_ring::rtm_ring(int fd, uint8_t *mem, size_t mem_size) :
+	mem_fd(fd), mem(mem), mem_size(mem_size)
+{
+	const auto &hdr = hdr_of(this->mem);
+
+	if (hdr.magic == RING_MAGIC) {
+		this->data = mem + data_offset(hdr.max_consumers);
+		this->size = hdr.size;
+	}
+}
+
+rtm_ring::~rtm_ring()
+{
+	munmap(this->mem, this->mem_size);
+	close(this->mem_fd);
+}
+
+std::atomic<uint32_t>& rtm_ring::need_wakeup(uint32_t consumer) const
+{
+	if (consumer >= hdr_of(this->mem).max_consumers) {
+		throw std::out_of_range("invalid ring consumer");
+	}
+	auto *consumers = reinterpret_cast<ring_consumer*>(
+		this->mem + align_up(sizeof(ring_header), CACHE_LINE));
+
+	return consumers[consumer].need_wakeup;
+}
+
+uint32_t rtm_ring::max_consumers() const
+{
+	return hdr_of(this->mem).max_consumers;
+}
+
+uint64_t rtm_ring::head() const
+{
+	return hdr_of(this->mem).head.load(std::memory_order_acquire);
+}
+
+void rtm_ring::publish(std::span<const uint8_t> msg)
+{
+	auto &hdr = hdr_of(this->mem);
+	const size_t record_size = RECORD_HDR_SIZE + align_up(msg.size(), 8);
+
+	if (record_size > this->size / 4) {
+		throw std::invalid_argument("message does not fit into the ring");
+	}
+
+	uint64_t position = hdr.head.load(std::memory_order_relaxed);
+	size_t offset = position & (this->size - 1);
+	const bool wrap = this->size - offset < record_size;
+	const uint64_t record_position = wrap ? position + (this->size - offset) :
+					 position;
+	const uint64_t new_head = record_position + record_size;
+
+	// Announce the overwritten range before touching it
+	hdr.reserve.store(new_head, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const uint32_t length = static_cast<uint32_t>(msg.size());
+	if (wrap) {
+		std::memcpy(this->data + offset, &RING_WRAP, sizeof(RING_WRAP));
+		offset = 0;
+	}
+	std::memcpy(this->data + offset, &length, sizeof(length));
+	std::memcpy(this->data + offset + RECORD_HDR_SIZE, msg.data(), msg.size());
+
+	// Release the record, sequentially consistent against take_wakeup()
+	hdr.head.store(new_head, std::memory_order_seq_cst);
+}
+
+rtm_ring::read_status rtm_ring::read(uint64_t &position,
+				     std::vector<uint8_t> &msg) const
+{
+	auto &hdr = hdr_of(this->mem);
+
+	while (true) {
+		const uint64_t head = hdr.head.load(std::memory_order_acquire);
+		if (position == head) {
+			return RING_EMPTY;
+		}
+		if (head - position > this->size || (position & 7) != 0) {
+			return RING_OVERRUN;
+		}
+
+		const size_t offset = position & (this->size - 1);
+		uint32_t length;
+		std::memcpy(&length, this->data + offset, sizeof(length));
+
+		uint64_t next;
+		bool valid = true;
+		if (length == RING_WRAP) {
+			next = position + (this->size - offset);
+		} else if (RECORD_HDR_SIZE + align_up(length, 8) > this->size - offset) {
+			// Torn record, checked against reserve below
+			valid = false;
+			next = position;
+		} else {
+			msg.assign(this->data + offset + RECORD_HDR_SIZE,
+				   this->data + offset + RECORD_HDR_SIZE + length);
+			next = position + RECORD_HDR_SIZE + align_up(length, 8);
+		}
+
+		// Was the record overwritten while copying it?
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t reserve = hdr.reserve.load(std::memory_order_relaxed);
+		if (reserve - position > this->size || !valid) {
+			return RING_OVERRUN;
+		}
+
+		position = next;
+		if (length != RING_WRAP) {
+			return RING_OK;
+		}
+	}
+}
+
+bool rtm_ring::arm_wakeup(uint32_t consumer, uint64_t position)
+{
+	this->need_wakeup(consumer).store(1, std::memory_order_seq_cst);
+
+	return hdr_of(this->mem).head.load(std::memory_order_seq_cst) == position;
+}
+
+bool rtm_ring::take_wakeup(uint32_t consumer)
+{
+	auto &flag = this->need_wakeup(consumer);
+
+	// Read first, the flag cache line is shared with the consumer
+	if (flag.load(std::memory_order_seq_cst) == 0) {
+		return false;
+	}
+
+	return flag.exchange(0, std::memory_order_seq_cst) != 0;
+}
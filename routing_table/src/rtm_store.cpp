@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) persistent store implementation
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <rtm_store.hpp>
+
+
+using namespace RTM;
+
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x534d5452;  // "RTMS"
+static constexpr uint32_t WAL_MAGIC = 0x574d5452;       // "RTMW"
+static constexpr uint32_t SNAPSHOT_VERSION = 1;
+// 2: RTM_UPDATE records hold update deltas instead of entries
+static constexpr uint32_t WAL_VERSION = 2;
+
+struct snapshot_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t generation;
+	uint64_t size;       // size of the serialized table
+	uint32_t checksum;   // of the serialized table
+	uint32_t reserved;
+};
+
+struct wal_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t generation;  // of the snapshot the log continues
+};
+
+struct wal_record {
+	uint32_t size;      // size of the message
+	uint32_t checksum;  // of the message
+};
+
+/**
+ * @brief Compute the FNV-1a hash of a memory region
+ *
+ * @param data - the memory region
+ * @return uint32_t - the checksum
+ */
+static uint32_t checksum(std::span<const uint8_t> data)
+{
+	uint32_t hash = 2166136261u;
+
+	for (const uint8_t byte : data) {
+		hash = (hash ^ byte) * 16777619u;
+	}
+
+	return hash;
+}
+
+static void write_all(int fd, const void *data, size_t size, const char *what)
+{
+	const auto *bytes = static_cast<const uint8_t*>(data);
+
+	while (size > 0) {
+		const ssize_t written = write(fd, bytes, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+		bytes += written;
+		size -= written;
+	}
+}
+
+/**
+ * @brief Map a whole file read-only
+ *
+ * @param fd - the file
+ * @param size - the file size, must not be 0
+ * @return const uint8_t* - the mapping, to be released by munmap()
+ */
+static const uint8_t* map_file(int fd, size_t size)
+{
+	void *mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (mem == MAP_FAILED) {
+		throw std::system_error(errno, std::generic_category(), "mmap");
+	}
+	// Read once front to back
+	madvise(mem, size, MADV_SEQUENTIAL);
+
+	return static_cast<const uint8_t*>(mem);
+}
+
+rtm_store::rtm_store(const std::string &dir, size_t snapshot_threshold) :
+	dir(dir), snapshot_threshold(snapshot_threshold)
+{
+}
+
+rtm_store::~rtm_store()
+{
+	try {
+		this->close();
+	} catch (const std::exception&) {
+		// The appended operations since the last commit are lost
+	}
+}
+
+void rtm_store::open(routing_table &table)
+{
+	this->close();
+	this->pending.clear();
+	this->replayed = 0;
+
+	this->load_snapshot(table);
+	this->replay_wal(table);
+}
+
+void rtm_store::close()
+{
+	if (this->wal_fd < 0) {
+		return;
+	}
+	try {
+		this->commit();
+	} catch (...) {
+		::close(this->wal_fd);
+		this->wal_fd = -1;
+		throw;
+	}
+	::close(this->wal_fd);
+	this->wal_fd = -1;
+}
+
+void rtm_store::append(cud_opcode_t opcode, const routing_table_entry &entry,
+		       uint32_t fields)
+{
+	rtm_message::init(this->scratch, opcode);
+	if (opcode == RTM_UPDATE) {
+		rtm_message::append_delta(this->scratch, entry, fields);
+	} else {
+		rtm_message::append_entry(this->scratch, entry);
+	}
+
+	const wal_record record = {static_cast<uint32_t>(this->scratch.size()),
+				   checksum(this->scratch)};
+	const auto *record_bytes = reinterpret_cast<const uint8_t*>(&record);
+	this->pending.insert(this->pending.end(), record_bytes,
+			     record_bytes + sizeof(record));
+	this->pending.insert(this->pending.end(), this->scratch.begin(),
+			     this->scratch.end());
+}
+
+void rtm_store::commit()
+{
+	if (this->pending.empty()) {
+		return;
+	}
+	if (this->wal_fd < 0) {
+		throw std::logic_error("RTM store is not open");
+	}
+
+	try {
+		write_all(this->wal_fd, this->pending.data(), this->pending.size(),
+			  "write");
+		if (fdatasync(this->wal_fd) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"fdatasync");
+		}
+	} catch (...) {
+		// Drop a partial write, records behind it would not be replayed
+		if (ftruncate(this->wal_fd, this->wal_bytes) == 0) {
+			lseek(this->wal_fd, this->wal_bytes, SEEK_SET);
+		}
+		throw;
+	}
+	this->wal_bytes += this->pending.size();
+	this->pending.clear();
+}
+
+bool rtm_store::needs_snapshot() const
+{
+	return this->wal_fd >= 0 &&
+	       this->wal_bytes >= std::max(this->snapshot_threshold,
+					   this->snapshot_bytes);
+}
+
+void rtm_store::snapshot(const routing_table &table)
+{
+	std::vector<uint8_t> payload;
+
+	this->commit();
+
+	const size_t size = routing_table::serialize(table, payload);
+	const snapshot_header hdr = {
+		SNAPSHOT_MAGIC, SNAPSHOT_VERSION, this->gen + 1, size,
+		checksum(std::span<const uint8_t>(payload.data(), size)), 0};
+
+	const auto tmp_path = this->dir + "/rtm.snapshot.tmp";
+	const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC |
+			      O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "open");
+	}
+	try {
+		write_all(fd, &hdr, sizeof(hdr), "write");
+		write_all(fd, payload.data(), size, "write");
+		if (fdatasync(fd) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"fdatasync");
+		}
+	} catch (...) {
+		::close(fd);
+		unlink(tmp_path.c_str());
+		throw;
+	}
+	::close(fd);
+
+	// The new snapshot replaces the old one and the log at once: a log of
+	// an older generation is discarded by open()
+	const auto path = this->dir + "/rtm.snapshot";
+	if (rename(tmp_path.c_str(), path.c_str()) < 0) {
+		const auto err = errno;
+		unlink(tmp_path.c_str());
+		throw std::system_error(err, std::generic_category(), "rename");
+	}
+	this->sync_dir();
+	this->gen = hdr.generation;
+	this->snapshot_bytes = sizeof(hdr) + size;
+
+	this->reset_wal();
+}
+
+void rtm_store::load_snapshot(routing_table &table)
+{
+	const auto path = this->dir + "/rtm.snapshot";
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	this->gen = 0;
+	this->snapshot_bytes = 0;
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			// No snapshot yet: the log holds all operations
+			return;
+		}
+		throw std::system_error(errno, std::generic_category(), "open");
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		const auto err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "fstat");
+	}
+	const size_t size = static_cast<size_t>(st.st_size);
+	if (size < sizeof(snapshot_header)) {
+		::close(fd);
+		throw std::runtime_error("truncated RTM snapshot: " + path);
+	}
+	const uint8_t *mem;
+	try {
+		mem = map_file(fd, size);
+	} catch (...) {
+		::close(fd);
+		throw;
+	}
+	::close(fd);
+
+	snapshot_header hdr;
+	std::memcpy(&hdr, mem, sizeof(hdr));
+	const std::span<const uint8_t> payload(mem + sizeof(hdr), size - sizeof(hdr));
+	try {
+		if (hdr.magic != SNAPSHOT_MAGIC || hdr.version != SNAPSHOT_VERSION ||
+		    hdr.size != payload.size() || hdr.checksum != checksum(payload)) {
+			throw std::runtime_error("corrupt RTM snapshot: " + path);
+		}
+		// The entries are read in place from the mapping
+		routing_table::deserialize(payload, table);
+	} catch (const std::invalid_argument&) {
+		munmap(const_cast<uint8_t*>(mem), size);
+		throw std::runtime_error("corrupt RTM snapshot: " + path);
+	} catch (...) {
+		munmap(const_cast<uint8_t*>(mem), size);
+		throw;
+	}
+	munmap(const_cast<uint8_t*>(mem), size);
+
+	this->gen = hdr.generation;
+	this->snapshot_bytes = size;
+}
+
+void rtm_store::replay_wal(routing_table &table)
+{
+	const auto path = this->dir + "/rtm.wal";
+	const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			this->reset_wal();
+			return;
+		}
+		throw std::system_error(errno, std::generic_category(), "open");
+	}
+
+	struct stat st;
+	wal_header hdr = {};
+	if (fstat(fd, &st) < 0) {
+		const auto err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "fstat");
+	}
+	const ssize_t hdr_len = pread(fd, &hdr, sizeof(hdr), 0);
+	if (hdr_len < 0) {
+		const auto err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "pread");
+	}
+	if (hdr_len != static_cast<ssize_t>(sizeof(hdr))) {
+		::close(fd);
+		throw std::runtime_error("truncated RTM log: " + path);
+	}
+	if (hdr.magic != WAL_MAGIC || hdr.version == 0 || hdr.version > WAL_VERSION) {
+		::close(fd);
+		throw std::runtime_error("corrupt RTM log: " + path);
+	}
+	if (hdr.generation < this->gen) {
+		// Crashed between a snapshot and the log reset: the log is
+		// part of the snapshot already
+		::close(fd);
+		this->reset_wal();
+		return;
+	}
+	if (hdr.generation > this->gen) {
+		::close(fd);
+		throw std::runtime_error("RTM log is newer than the snapshot: " + path);
+	}
+
+	const size_t size = static_cast<size_t>(st.st_size);
+	size_t offset = sizeof(hdr);
+	if (size > offset) {
+		const uint8_t *mem;
+		try {
+			mem = map_file(fd, size);
+		} catch (...) {
+			::close(fd);
+			throw;
+		}
+
+		// Replay up to the first incomplete or corrupt record
+		wal_record record;
+		while (size - offset >= sizeof(record)) {
+			std::memcpy(&record, mem + offset, sizeof(record));
+			if (record.size > size - offset - sizeof(record)) {
+				break;
+			}
+			const std::span<const uint8_t> msg(mem + offset + sizeof(record),
+							   record.size);
+			rtm_msg_hdr msg_hdr;
+			std::span<const uint8_t> msg_payload;
+			if (checksum(msg) != record.checksum ||
+			    !rtm_message::parse(msg, msg_hdr, msg_payload) ||
+			    msg_hdr.opcode > RTM_DELETE) {
+				break;
+			}
+			bool ok;
+			if (msg_hdr.opcode == RTM_UPDATE && hdr.version >= 2) {
+				ok = rtm_message::for_each_delta(msg_hdr, msg_payload,
+					[&](const routing_table_entry &delta, uint32_t fields) {
+						table.update_entry(delta, fields);
+					});
+			} else {
+				ok = rtm_message::for_each_entry(msg_hdr, msg_payload,
+					[&](const routing_table_entry &entry) {
+						if (msg_hdr.opcode == RTM_DELETE) {
+							table.delete_entry(entry);
+						} else {
+							// Version 1 updates replace the entry
+							table.create_entry(entry);
+						}
+					});
+			}
+			if (!ok) {
+				break;
+			}
+			this->replayed++;
+			offset += sizeof(record) + record.size;
+		}
+		munmap(const_cast<uint8_t*>(mem), size);
+	}
+
+	if (offset < size && (ftruncate(fd, offset) < 0 || fdatasync(fd) < 0)) {
+		const auto err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "ftruncate");
+	}
+	lseek(fd, offset, SEEK_SET);
+	this->wal_fd = fd;
+	this->wal_bytes = offset;
+
+	if (hdr.version < WAL_VERSION) {
+		// Appended records would be replayed in the old format
+		this->snapshot(table);
+	}
+}
+
+void rtm_store::reset_wal()
+{
+	const wal_header hdr = {WAL_MAGIC, WAL_VERSION, this->gen};
+	const auto tmp_path = this->dir + "/rtm.wal.tmp";
+	const auto path = this->dir + "/rtm.wal";
+
+	const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC |
+			      O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "open");
+	}
+	try {
+		write_all(fd, &hdr, sizeof(hdr), "write");
+		if (fdatasync(fd) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"fdatasync");
+		}
+		if (rename(tmp_path.c_str(), path.c_str()) < 0) {
+			throw std::system_error(errno, std::generic_category(),
+						"rename");
+		}
+	} catch (...) {
+		::close(fd);
+		unlink(tmp_path.c_str());
+		throw;
+	}
+	this->sync_dir();
+
+	if (this->wal_fd >= 0) {
+		::close(this->wal_fd);
+	}
+	this->wal_fd = fd;
+	this->wal_bytes = sizeof(hdr);
+}
+
+void rtm_store::sync_dir()
+{
+	const int fd = ::open(this->dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "open");
+	}
+	const int ret = fsync(fd);
+	const auto err = errno;
+	::close(fd);
+	if (ret < 0) {
+		throw std::system_error(err, std::generic_category(), "fsync");
+	}
+}
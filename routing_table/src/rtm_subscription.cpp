@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) client subscriptions implementation
+ */
+
+#include <algorithm>
+
+#include <rtm_subscription.hpp>
+
+
+using namespace RTM;
+
+static uint32_t prefix_mask(uint8_t len)
+{
+	return len == 0 ? 0 : ~uint32_t(0) << (32 - len);
+}
+
+static void remove_subscriber(std::vector<uint32_t>& subscribers,
+			      uint32_t subscriber)
+{
+	subscribers.erase(std::remove(subscribers.begin(), subscribers.end(),
+				      subscriber),
+			  subscribers.end());
+}
+
+bool subscription_filter::matches(const routing_table_entry& entry) const
+{
+	const auto mask = prefix_mask(this->prefix_len);
+	const auto dest = routing_table_entry::ip2host(entry.destination_ip);
+
+	return entry.destination_mask >= this->prefix_len &&
+	       (dest & mask) == (routing_table_entry::ip2host(this->prefix) & mask) &&
+	       (this->oif.empty() || this->oif == entry.oif);
+}
+
+bool subscription_filter::matches(const std::vector<subscription_filter>& filters,
+				  const routing_table_entry& entry)
+{
+	return filters.empty() ||
+	       std::any_of(filters.begin(), filters.end(),
+			   [&entry](const subscription_filter& filter) {
+				   return filter.matches(entry);
+			   });
+}
+
+bool subscription_filter::matches_all(const std::vector<subscription_filter>& filters)
+{
+	return filters.empty() ||
+	       std::any_of(filters.begin(), filters.end(),
+			   [](const subscription_filter& filter) {
+				   return filter.prefix_len == 0 && filter.oif.empty();
+			   });
+}
+
+bool subscription_filter::from_string(const std::string& str,
+				      subscription_filter& filter)
+{
+	const auto comma = str.find(',');
+	const auto prefix_str = str.substr(0, comma);
+
+	filter = subscription_filter();
+	if (comma != std::string::npos) {
+		filter.oif = str.substr(comma + 1);
+		if (filter.oif.empty()) {
+			return false;
+		}
+	}
+	if (prefix_str.empty()) {
+		return comma != std::string::npos;
+	}
+
+	const auto slash = prefix_str.find('/');
+	if (slash == std::string::npos || slash + 1 == prefix_str.size() ||
+	    !routing_table_entry::str2ip(prefix_str.substr(0, slash), filter.prefix)) {
+		return false;
+	}
+
+	unsigned int len = 0;
+	for (size_t i = slash + 1; i < prefix_str.size(); ++i) {
+		if (prefix_str[i] < '0' || prefix_str[i] > '9' || len > 32) {
+			return false;
+		}
+		len = len * 10 + (prefix_str[i] - '0');
+	}
+	if (len > 32) {
+		return false;
+	}
+	filter.prefix_len = static_cast<uint8_t>(len);
+
+	return true;
+}
+
+bool subscription_filter::operator==(const subscription_filter& other) const
+{
+	return std::memcmp(this->prefix, other.prefix, sizeof(this->prefix)) == 0 &&
+	       this->prefix_len == other.prefix_len &&
+	       this->oif == other.oif;
+}
+
+using filter_codec = wire::codec<subscription_filter,
+	wire::bytes_field<&subscription_filter::prefix>,
+	wire::uint_field<&subscription_filter::prefix_len>,
+	wire::string_field<&subscription_filter::oif>>;
+
+size_t subscription_filter::serialize(const std::vector<subscription_filter>& filters,
+				      std::vector<uint8_t>& buffer)
+{
+	const size_t start = buffer.size();
+	size_t size = sizeof(uint32_t);
+
+	for (const auto& filter : filters) {
+		size += filter_codec::size(filter);
+	}
+	buffer.resize(start + size);
+
+	uint8_t *out = buffer.data() + start;
+	wire::store_le(out, static_cast<uint32_t>(filters.size()));
+	out += sizeof(uint32_t);
+	for (const auto& filter : filters) {
+		out = filter_codec::encode(filter, out);
+	}
+
+	return size;
+}
+
+size_t subscription_filter::deserialize(std::span<const uint8_t> buffer,
+					std::vector<subscription_filter>& filters)
+{
+	const uint8_t *in = buffer.data();
+	const uint8_t *end = buffer.data() + buffer.size();
+
+	filters.clear();
+	if (buffer.size() < sizeof(uint32_t)) {
+		return 0;
+	}
+	const uint32_t num_filters = wire::load_le<uint32_t>(in);
+	in += sizeof(uint32_t);
+
+	for (uint32_t i = 0; i < num_filters; ++i) {
+		subscription_filter filter;
+		in = filter_codec::decode(filter, in, end);
+		if (in == nullptr || filter.prefix_len > 32) {
+			filters.clear();
+			return 0;
+		}
+		filters.push_back(std::move(filter));
+	}
+
+	return static_cast<size_t>(in - buffer.data());
+}
+
+void subscription_index::subscribe(uint32_t subscriber,
+				   const std::vector<subscription_filter>& filters)
+{
+	this->unsubscribe(subscriber);
+
+	auto &stored = this->filters[subscriber];
+	stored = filters;
+	if (stored.empty()) {
+		// No filters: subscribe to 0.0.0.0/0 out of any OIF
+		stored.emplace_back();
+	}
+
+	for (const auto& filter : stored) {
+		const auto prefix = routing_table_entry::ip2host(filter.prefix) &
+				    prefix_mask(filter.prefix_len);
+		auto &bucket = this->trie.insert(prefix, filter.prefix_len);
+		auto &subscribers = filter.oif.empty() ? bucket.any_oif :
+						       bucket.by_oif[filter.oif];
+		if (std::find(subscribers.begin(), subscribers.end(), subscriber) ==
+		    subscribers.end()) {
+			subscribers.push_back(subscriber);
+		}
+	}
+}
+
+void subscription_index::unsubscribe(uint32_t subscriber)
+{
+	const auto it = this->filters.find(subscriber);
+	if (it == this->filters.end()) {
+		return;
+	}
+
+	for (const auto& filter : it->second) {
+		const auto prefix = routing_table_entry::ip2host(filter.prefix) &
+				    prefix_mask(filter.prefix_len);
+		auto *bucket = this->trie.find(prefix, filter.prefix_len);
+		if (!bucket) {
+			continue;
+		}
+		if (filter.oif.empty()) {
+			remove_subscriber(bucket->any_oif, subscriber);
+		} else if (auto oif_it = bucket->by_oif.find(filter.oif);
+			   oif_it != bucket->by_oif.end()) {
+			remove_subscriber(oif_it->second, subscriber);
+			if (oif_it->second.empty()) {
+				bucket->by_oif.erase(oif_it);
+			}
+		}
+		if (bucket->empty()) {
+			this->trie.erase(prefix, filter.prefix_len);
+		}
+	}
+	this->filters.erase(it);
+}
+
+void subscription_index::match(const routing_table_entry& entry,
+			       std::vector<uint32_t>& subscribers) const
+{
+	const auto dest = routing_table_entry::ip2host(entry.destination_ip);
+
+	subscribers.clear();
+	// Filters longer than the entry mask do not contain the whole route:
+	this->trie.for_each_match(dest, entry.destination_mask,
+		[&](uint8_t, const bucket& b) {
+			subscribers.insert(subscribers.end(), b.any_oif.begin(),
+					   b.any_oif.end());
+			if (!b.by_oif.empty()) {
+				const auto it = b.by_oif.find(entry.oif);
+				if (it != b.by_oif.end()) {
+					subscribers.insert(subscribers.end(),
+							   it->second.begin(),
+							   it->second.end());
+				}
+			}
+		});
+
+	// A subscriber with overlapping filters could be found more than once:
+	std::sort(subscribers.begin(), subscribers.end());
+	subscribers.erase(std::unique(subscribers.begin(), subscribers.end()),
+			  subscribers.end());
+}
+
+bool subscription_index::matches(uint32_t subscriber,
+				 const routing_table_entry& entry) const
+{
+	const auto it = this->filters.find(subscriber);
+	if (it == this->filters.end()) {
+		return false;
+	}
+
+	return std::any_of(it->second.begin(), it->second.end(),
+			   [&entry](const subscription_filter& filter) {
+				   return filter.matches(entry);
+			   });
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routig Table Unit-Tests helpers shared by the test files
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <routing_table.hpp>
+#include <routing_table6.hpp>
+
+namespace RTM {
+
+/**
+ * @brief Build the key of an IPv4 address (destination_ip_u32)
+ *
+ * @param a - the first byte of the address
+ * @param b - the second byte of the address
+ * @param c - the third byte of the address
+ * @param d - the last byte of the address
+ * @return uint32_t - the address as stored in destination_ip_u32
+ */
+inline uint32_t make_key(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+	const uint8_t ip[4] = {a, b, c, d};
+	uint32_t key;
+
+	std::memcpy(&key, ip, sizeof(key));
+	return key;
+}
+
+/**
+ * @brief Build an IPv4 routing table entry
+ *
+ * @param key - the destination address as stored in destination_ip_u32
+ * @param mask - the destination mask
+ * @param oif - the outgoing interface
+ * @param gateway - the gateway address as stored in gateway_ip_u32
+ * @return routing_table_entry - the entry
+ */
+inline routing_table_entry make_entry(uint32_t key, uint8_t mask,
+				      const std::string &oif = "ens0",
+				      uint32_t gateway = 0)
+{
+	routing_table_entry entry;
+
+	entry.destination_ip_u32 = key;
+	entry.destination_mask = mask;
+	entry.gateway_ip_u32 = gateway;
+	entry.oif = oif;
+	return entry;
+}
+
+/**
+ * @brief Build an IPv4 routing table entry from a dotted destination address
+ *
+ * @param dest - the destination address, e.g. "10.1.2.0"
+ * @param mask - the destination mask
+ * @param oif - the outgoing interface
+ * @param gateway - the gateway address as stored in gateway_ip_u32
+ * @return routing_table_entry - the entry
+ */
+inline routing_table_entry make_entry(const std::string &dest, uint8_t mask,
+				      const std::string &oif = "ens0",
+				      uint32_t gateway = 0)
+{
+	auto entry = make_entry(uint32_t(0), mask, oif, gateway);
+
+	EXPECT_TRUE(routing_table_entry::str2ip(dest, entry.destination_ip)) << dest;
+	return entry;
+}
+
+/**
+ * @brief Build an IPv6 routing table entry
+ *
+ * @param dest - the destination address, e.g. "2001:db8::"
+ * @param mask - the destination prefix length
+ * @param gw - the gateway address
+ * @param oif - the outgoing interface
+ * @return routing_table6_entry - the entry
+ */
+inline routing_table6_entry make_entry6(const std::string &dest, uint8_t mask,
+					const std::string &gw, const std::string &oif)
+{
+	routing_table6_entry entry;
+
+	EXPECT_TRUE(routing_table6_entry::str2ip(dest, entry.destination_ip)) << dest;
+	EXPECT_TRUE(routing_table6_entry::str2ip(gw, entry.gateway_ip)) << gw;
+	entry.destination_mask = mask;
+	entry.oif = oif;
+	return entry;
+}
+
+}  // namespace RTM
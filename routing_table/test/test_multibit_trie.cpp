@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Multibit Trie Unit-Tests
+ */
+
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <multibit_trie.hpp>
+
+
+using namespace RTM;
+
+
+/**
+ * @brief Prefixes and their values, looked up by testing all of them
+ */
+template <typename Family>
+struct reference_table {
+	using address = typename Family::address;
+
+	std::vector<std::tuple<address, uint8_t, int>> prefixes;
+
+	const int* lookup(address addr) const
+	{
+		const int *value = nullptr;
+		int longest = -1;
+
+		for (const auto &[prefix, len, v] : this->prefixes) {
+			if (((addr ^ prefix) & Family::mask(len)) == 0 && len > longest) {
+				value = &v;
+				longest = len;
+			}
+		}
+		return value;
+	}
+};
+
+/**
+ * @brief Insert random prefixes, erase some and compare random lookups
+ */
+template <typename Family>
+static void check_random(std::mt19937_64 &rng, uint8_t min_len, uint8_t max_len,
+			 size_t num_prefixes)
+{
+	using address = typename Family::address;
+	multibit_trie<int, Family> trie;
+	reference_table<Family> reference;
+
+	auto random_address = [&rng]() {
+		address addr = static_cast<address>(rng());
+		if constexpr (Family::bits > 64) {
+			addr = (addr << 64) | rng();
+		}
+		// Keep the prefixes close to each other, so they nest: 4 direct
+		// slots, 4 values of the bits after them
+		const address top = ((rng() % 4) << 20) | (rng() % 4);
+		return (addr & ~Family::mask(24)) | (top << (Family::bits - 24));
+	};
+
+	for (size_t i = 0; i < num_prefixes; ++i) {
+		const uint8_t len = min_len + rng() % (max_len - min_len + 1);
+		const address prefix = random_address() & Family::mask(len);
+		if (trie.find(prefix, len) == nullptr) {
+			trie.insert(prefix, len) = static_cast<int>(i);
+			reference.prefixes.emplace_back(prefix, len, static_cast<int>(i));
+		}
+	}
+	// A default route and a host route
+	trie.insert(0, 0) = -1;
+	reference.prefixes.emplace_back(0, 0, -1);
+	const address host = random_address();
+	if (trie.find(host, Family::bits) == nullptr) {
+		trie.insert(host, Family::bits) = -2;
+		reference.prefixes.emplace_back(host, Family::bits, -2);
+	}
+
+	auto check = [&]() {
+		EXPECT_EQ(*trie.lookup(host), *reference.lookup(host));
+		for (const auto &[prefix, len, v] : reference.prefixes) {
+			// The prefix itself and an address at its end
+			for (const address addr : {prefix, prefix | ~Family::mask(len)}) {
+				const int *expected = reference.lookup(addr);
+				const int *found = trie.lookup(addr);
+				ASSERT_EQ(found == nullptr, expected == nullptr);
+				if (found) {
+					ASSERT_EQ(*found, *expected);
+				}
+			}
+		}
+		for (int i = 0; i < 1000; ++i) {
+			const address addr = random_address();
+			const int *expected = reference.lookup(addr);
+			const int *found = trie.lookup(addr);
+			ASSERT_EQ(found == nullptr, expected == nullptr);
+			if (found) {
+				ASSERT_EQ(*found, *expected);
+			}
+		}
+	};
+	check();
+
+	// Erase every third prefix, the nodes of their slots are rebuilt
+	std::vector<std::tuple<address, uint8_t, int>> kept;
+	for (size_t i = 0; i < reference.prefixes.size(); ++i) {
+		const auto [prefix, len, v] = reference.prefixes[i];
+		if (i % 3 == 0) {
+			EXPECT_TRUE(trie.erase(prefix, len));
+		} else {
+			kept.push_back(reference.prefixes[i]);
+		}
+	}
+	reference.prefixes = std::move(kept);
+	EXPECT_EQ(trie.size(), reference.prefixes.size());
+	check();
+
+	// A copy refers to its own values
+	const multibit_trie<int, Family> copy = trie;
+	trie.clear();
+	EXPECT_EQ(trie.lookup(host), nullptr);
+	EXPECT_TRUE(trie.empty());
+	for (int i = 0; i < 100; ++i) {
+		const address addr = random_address();
+		const int *expected = reference.lookup(addr);
+		const int *found = copy.lookup(addr);
+		ASSERT_EQ(found == nullptr, expected == nullptr);
+		if (found) {
+			ASSERT_EQ(*found, *expected);
+		}
+	}
+}
+
+TEST(multibit_trie_test, inet4)
+{
+	multibit_trie<int> trie;
+
+	EXPECT_EQ(trie.lookup(0x0a010203), nullptr);
+
+	trie.insert(0x0a000000, 8) = 8;
+	trie.insert(0x0a010000, 16) = 16;
+	trie.insert(0x0a010200, 24) = 24;
+	trie.insert(0x0a010203, 32) = 32;
+	EXPECT_EQ(*trie.lookup(0x0a010203), 32);
+	EXPECT_EQ(*trie.lookup(0x0a010204), 24);
+	EXPECT_EQ(*trie.lookup(0x0a010304), 16);
+	EXPECT_EQ(*trie.lookup(0x0a020304), 8);
+	EXPECT_EQ(trie.lookup(0x0b000000), nullptr);
+
+	// Bits beyond the prefix length are ignored
+	EXPECT_EQ(*trie.find(0x0a0102ff, 24), 24);
+	EXPECT_TRUE(trie.erase(0x0a0102ff, 24));
+	EXPECT_FALSE(trie.erase(0x0a010200, 24));
+	EXPECT_EQ(*trie.lookup(0x0a010204), 16);
+	EXPECT_EQ(*trie.lookup(0x0a010203), 32);
+
+	std::mt19937_64 rng(1);
+	check_random<inet4>(rng, 1, 32, 2000);
+}
+
+TEST(multibit_trie_test, lazy_slots)
+{
+	multibit_trie<int> trie;
+
+	// The direct array is allocated by the first lookup of prefixes
+	EXPECT_EQ(trie.memory_usage(), 0);
+	EXPECT_EQ(trie.lookup(0x0a010203), nullptr);
+	EXPECT_EQ(trie.memory_usage(), 0);
+	trie.insert(0x0a000000, 8) = 8;
+	trie.insert(0x0a010200, 24) = 24;
+	EXPECT_EQ(trie.memory_usage(), 0);
+
+	const multibit_trie<int> copy = trie;
+	EXPECT_EQ(*trie.lookup(0x0a010203), 24);
+	EXPECT_GE(trie.memory_usage(), (size_t(1) << 16) * sizeof(void*));
+	EXPECT_EQ(copy.memory_usage(), 0);
+	EXPECT_EQ(*copy.lookup(0x0a020304), 8);
+	EXPECT_EQ(*copy.lookup(0x0a010203), 24);
+
+	// Changes after the first lookup are looked up as well
+	trie.insert(0x0a010203, 32) = 32;
+	EXPECT_EQ(*trie.lookup(0x0a010203), 32);
+
+	trie.clear();
+	EXPECT_EQ(trie.memory_usage(), 0);
+	EXPECT_EQ(trie.lookup(0x0a010203), nullptr);
+}
+
+TEST(multibit_trie_test, inet6)
+{
+	using address = inet6::address;
+	multibit_trie<int, inet6> trie;
+	const address prefix = address(0x20010db8) << 96;
+
+	trie.insert(prefix, 32) = 32;
+	trie.insert(prefix | (address(0x0001) << 80), 48) = 48;
+	trie.insert(prefix | (address(0x00010002) << 64), 64) = 64;
+	EXPECT_EQ(*trie.lookup(prefix | (address(0x00010002) << 64) | 1), 64);
+	EXPECT_EQ(*trie.lookup(prefix | (address(0x00010003) << 64)), 48);
+	EXPECT_EQ(*trie.lookup(prefix | (address(0x0002) << 80)), 32);
+	EXPECT_EQ(trie.lookup(address(0x20010db9) << 96), nullptr);
+
+	// The prefixes take the direct array and 6 nodes
+	EXPECT_LE(trie.memory_usage(), (size_t(1) << 16) * 24 + 2048);
+
+	std::mt19937_64 rng(2);
+	check_random<inet6>(rng, 1, 128, 2000);
+	check_random<inet6>(rng, 20, 64, 5000);
+}
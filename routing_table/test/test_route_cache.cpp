@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Route Cache Unit-Tests
+ */
+
+#include <gtest/gtest.h>
+#include <route_cache.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+static uint32_t make_addr(const std::string& ip)
+{
+	uint8_t addr[4];
+
+	EXPECT_TRUE(routing_table_entry::str2ip(ip, addr)) << ip;
+
+	return routing_table_entry::ip2host(addr);
+}
+
+TEST(route_cache, hit_miss)
+{
+	routing_table table;
+	route_cache cache(100);
+
+	EXPECT_EQ(cache.capacity(), 128);
+
+	table.create_entry(make_entry("10.0.0.0", 8, "ens1"));
+	const auto addr = make_addr("10.1.2.3");
+
+	ASSERT_NE(cache.lookup(table, addr), nullptr);
+	EXPECT_EQ(cache.lookup(table, addr)->oif, "ens1");
+	EXPECT_EQ(cache.misses(), 1);
+	EXPECT_EQ(cache.hits(), 1);
+
+	// No route is cached as well:
+	EXPECT_EQ(cache.lookup(table, make_addr("11.1.2.3")), nullptr);
+	EXPECT_EQ(cache.lookup(table, make_addr("11.1.2.3")), nullptr);
+	EXPECT_EQ(cache.misses(), 2);
+	EXPECT_EQ(cache.hits(), 2);
+
+	cache.reset_stats();
+	EXPECT_EQ(cache.hits(), 0);
+	EXPECT_EQ(cache.misses(), 0);
+}
+
+TEST(route_cache, invalidate_prefix)
+{
+	routing_table table;
+	route_cache cache(1024);
+	const auto addr = make_addr("10.1.2.3");
+	const auto other_addr = make_addr("10.2.0.1");
+
+	table.create_entry(make_entry("10.0.0.0", 8, "ens1"));
+	cache.lookup(table, addr);
+	cache.lookup(table, other_addr);
+
+	// A /24 is invalidated address by address:
+	const auto entry = make_entry("10.1.2.0", 24, "ens2");
+	table.create_entry(entry);
+	cache.invalidate(entry);
+	EXPECT_EQ(cache.flushes(), 0);
+
+	EXPECT_EQ(cache.lookup(table, addr)->oif, "ens2");
+	EXPECT_EQ(cache.lookup(table, other_addr)->oif, "ens1");
+	EXPECT_EQ(cache.misses(), 3);
+	EXPECT_EQ(cache.hits(), 1);
+
+	table.delete_entry(entry);
+	cache.invalidate(entry);
+	EXPECT_EQ(cache.lookup(table, addr)->oif, "ens1");
+	EXPECT_EQ(cache.misses(), 4);
+}
+
+TEST(route_cache, invalidate_generation)
+{
+	routing_table table;
+	route_cache cache(16);
+	const auto addr = make_addr("10.1.2.3");
+
+	table.create_entry(make_entry("10.0.0.0", 8, "ens1"));
+	cache.lookup(table, addr);
+
+	// A /16 covers more addresses than the cache has slots:
+	const auto entry = make_entry("10.1.0.0", 16, "ens2");
+	table.create_entry(entry);
+	cache.invalidate(entry);
+	EXPECT_EQ(cache.flushes(), 1);
+	EXPECT_EQ(cache.lookup(table, addr)->oif, "ens2");
+	EXPECT_EQ(cache.misses(), 2);
+
+	table.clear();
+	cache.clear();
+	EXPECT_EQ(cache.flushes(), 2);
+	EXPECT_EQ(cache.lookup(table, addr), nullptr);
+}
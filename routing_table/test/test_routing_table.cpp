@@ -5,7 +5,10 @@
  */
 
 #include <iostream>
+#include <memory_resource>
 #include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <routing_table.hpp>
 
 
@@ -152,6 +155,14 @@ TEST_F(routing_table_test, comparson_operator)
 		rt_other.create_entry(entry);
 	}
 	EXPECT_NE(rt, rt_other);
+
+	// Tables differ only after their first entry
+	routing_table rt_last = rt;
+	rt.for_each([&entry](const routing_table_entry &e) { entry = e; });
+	entry.oif = "other";
+	rt_last.create_entry(entry);
+	EXPECT_EQ(rt_last.size(), rt.size());
+	EXPECT_NE(rt, rt_last);
 }
 
 TEST_F(routing_table_test, serialize_deserialize)
@@ -203,3 +214,269 @@ TEST_F(routing_table_test, serialize_deserialize)
 	EXPECT_EQ(rt == rt_deserialized, true);
 	EXPECT_EQ(rt, rt_deserialized);
 }
+
+TEST_F(routing_table_test, lookup)
+{
+	routing_table_entry entry;
+	uint8_t addr[4];
+
+	entry.gateway_ip_u32 = 0;
+	entry.oif = "ens1";
+
+	EXPECT_TRUE(routing_table_entry::str2ip("10.0.0.0", entry.destination_ip));
+	entry.destination_mask = 8;
+	rt.create_entry(entry);
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.0.0", entry.destination_ip));
+	entry.destination_mask = 16;
+	entry.oif = "ens2";
+	rt.create_entry(entry);
+
+	// Tables never looked up take no lookup memory:
+	EXPECT_EQ(routing_table().lookup_memory_usage(), 0);
+	EXPECT_EQ(rt.lookup_memory_usage(), 0);
+
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.2.3", addr));
+	ASSERT_NE(rt.lookup(routing_table_entry::ip2host(addr)), nullptr);
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens2");
+	EXPECT_TRUE(routing_table_entry::str2ip("10.2.0.1", addr));
+	ASSERT_NE(rt.lookup(routing_table_entry::ip2host(addr)), nullptr);
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens1");
+	EXPECT_TRUE(routing_table_entry::str2ip("11.1.2.3", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr)), nullptr);
+	EXPECT_GT(rt.lookup_memory_usage(), 0);
+	EXPECT_EQ(routing_table(rt).lookup_memory_usage(), 0);
+
+	// A replacement with another prefix length moves the entry:
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.0.0", entry.destination_ip));
+	entry.destination_mask = 24;
+	rt.create_entry(entry);
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.2.3", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens1");
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.0.3", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens2");
+
+	rt.delete_entry(entry);
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens1");
+
+	// The default route matches all addresses:
+	EXPECT_TRUE(routing_table_entry::str2ip("0.0.0.0", entry.destination_ip));
+	entry.destination_mask = 0;
+	entry.oif = "ens0";
+	rt.create_entry(entry);
+	EXPECT_TRUE(routing_table_entry::str2ip("11.1.2.3", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr))->oif, "ens0");
+
+	rt.clear();
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr)), nullptr);
+}
+
+TEST_F(routing_table_test, update_entry)
+{
+	routing_table_entry entry;
+	routing_table_entry delta;
+	uint8_t addr[4];
+
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.0.0", entry.destination_ip));
+	EXPECT_TRUE(routing_table_entry::str2ip("192.168.0.1", entry.gateway_ip));
+	entry.destination_mask = 16;
+	entry.oif = "ens1";
+	rt.create_entry(entry);
+	const auto *stored = rt.find(entry.destination_ip_u32);
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.2.3", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr)), stored);
+
+	// Only the given fields change, in place
+	delta.destination_ip_u32 = entry.destination_ip_u32;
+	EXPECT_TRUE(routing_table_entry::str2ip("192.168.0.2", delta.gateway_ip));
+	delta.destination_mask = 8;
+	delta.oif = "ens2";
+	EXPECT_TRUE(rt.update_entry(delta, RTM_FIELD_GATEWAY));
+	EXPECT_EQ(rt.find(entry.destination_ip_u32), stored);
+	EXPECT_EQ(stored->gateway_ip_u32, delta.gateway_ip_u32);
+	EXPECT_EQ(stored->destination_mask, 16);
+	EXPECT_EQ(stored->oif, "ens1");
+
+	EXPECT_TRUE(rt.update_entry(delta, RTM_FIELD_OIF));
+	EXPECT_EQ(stored->oif, "ens2");
+
+	// A mask change moves the entry to another prefix
+	EXPECT_TRUE(routing_table_entry::str2ip("10.2.0.1", addr));
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr)), nullptr);
+	EXPECT_TRUE(rt.update_entry(delta, RTM_FIELD_MASK));
+	EXPECT_EQ(stored->destination_mask, 8);
+	EXPECT_EQ(rt.lookup(routing_table_entry::ip2host(addr)), stored);
+
+	EXPECT_TRUE(routing_table_entry::str2ip("10.3.0.0", delta.destination_ip));
+	EXPECT_FALSE(rt.update_entry(delta));
+	EXPECT_EQ(rt.size(), 1);
+}
+
+TEST_F(routing_table_test, for_each_from)
+{
+	routing_table_entry entry;
+	std::vector<uint32_t> keys;
+
+	entry.destination_mask = 32;
+	entry.oif = "ens0";
+	for (uint32_t key : {10, 20, 30}) {
+		entry.destination_ip_u32 = key;
+		rt.create_entry(entry);
+	}
+
+	// The first key need not exist
+	rt.for_each_from(15, [&](const routing_table_entry &entry) {
+		keys.push_back(entry.destination_ip_u32);
+		return true;
+	});
+	EXPECT_EQ(keys, std::vector<uint32_t>({20, 30}));
+
+	keys.clear();
+	rt.for_each_from(10, [&](const routing_table_entry &entry) {
+		keys.push_back(entry.destination_ip_u32);
+		return keys.size() < 2;
+	});
+	EXPECT_EQ(keys, std::vector<uint32_t>({10, 20}));
+}
+
+TEST_F(routing_table_test, to_string)
+{
+	routing_table_entry entry;
+
+	EXPECT_TRUE(routing_table_entry::str2ip("10.1.0.0", entry.destination_ip));
+	EXPECT_TRUE(routing_table_entry::str2ip("192.168.0.1", entry.gateway_ip));
+	entry.destination_mask = 16;
+	entry.oif = "eth0";
+	rt.create_entry(entry);
+
+	EXPECT_EQ(rt.to_string(),
+		  "Key\t | Destination IP/Mask\t | Gateway IP\t | OIF\n"
+		  "10.1.0.0\t | 10.1.0.0 (0x0000010a)/16\t | "
+		  "192.168.0.1 (0x0100a8c0)\t | eth0\n");
+}
+
+TEST_F(routing_table_test, dump_load_text)
+{
+	const auto num_entries = 100'000;
+	for (size_t i = 0; i < num_entries; ++i) {
+		routing_table_entry entry;
+		entry.destination_ip[0] = 10;
+		entry.destination_ip[1] = static_cast<uint8_t>(i >> 16);
+		entry.destination_ip[2] = static_cast<uint8_t>(i >> 8);
+		entry.destination_ip[3] = static_cast<uint8_t>(i);
+		entry.gateway_ip_u32 = static_cast<uint32_t>(i * 2654435761u);
+		entry.destination_mask = static_cast<uint8_t>(i % 33);
+		entry.oif = "ens" + std::to_string(i % 16);
+		rt.create_entry(entry);
+	}
+
+	const int fd = memfd_create("rtm_dump", MFD_CLOEXEC);
+	ASSERT_GE(fd, 0);
+	rt.dump(fd);
+
+	// The streamed dump equals the string representation:
+	const auto str = rt.to_string();
+	std::string dumped(str.size() + 1, '\0');
+	EXPECT_EQ(pread(fd, dumped.data(), dumped.size(), 0),
+		  static_cast<ssize_t>(str.size()));
+	dumped.resize(str.size());
+	EXPECT_EQ(dumped, str);
+	close(fd);
+
+	// Reload the routes in text form:
+	std::string text = "# destination gateway oif\n\n";
+	rt.for_each([&text](const routing_table_entry &entry) {
+		text += routing_table_entry::destination_ip2str(entry) + "/" +
+			std::to_string(entry.destination_mask) + " " +
+			std::to_string(entry.gateway_ip[0]) + "." +
+			std::to_string(entry.gateway_ip[1]) + "." +
+			std::to_string(entry.gateway_ip[2]) + "." +
+			std::to_string(entry.gateway_ip[3]) + "\t" + entry.oif + "\r\n";
+	});
+	const int text_fd = memfd_create("rtm_text", MFD_CLOEXEC);
+	ASSERT_GE(text_fd, 0);
+	ASSERT_EQ(write(text_fd, text.data(), text.size()),
+		  static_cast<ssize_t>(text.size()));
+	lseek(text_fd, 0, SEEK_SET);
+
+	routing_table loaded;
+	EXPECT_EQ(loaded.load_text(text_fd), num_entries);
+	EXPECT_EQ(loaded, rt);
+	close(text_fd);
+}
+
+TEST_F(routing_table_test, load_text)
+{
+	EXPECT_EQ(rt.load_text("10.0.0.0/8 1.1.1.1 eth0\n"
+			       "  10.1.0.0/16   1.1.1.2 eth1  \n"
+			       "10.0.0.0/8 1.1.1.3 eth2"), 3);
+	EXPECT_EQ(rt.size(), 2);
+
+	// A later line replaces an earlier one with the same key:
+	uint8_t key[4] = {10, 0, 0, 0};
+	const auto &entry = rt.at(*reinterpret_cast<const uint32_t*>(key));
+	EXPECT_EQ(entry.oif, "eth2");
+	EXPECT_EQ(entry.gateway_ip[3], 3);
+
+	for (const auto *line : {"10.0.0.0 1.1.1.1 eth0", "10.0.0.0/33 1.1.1.1 eth0",
+				 "10.0.0.256/8 1.1.1.1 eth0", "10.0.0.0/8 1.1.1 eth0",
+				 "10.0.0.0/8 1.1.1.1", "10.0.0.0/8 1.1.1.1 eth0 x"}) {
+		EXPECT_THROW(rt.load_text(line), std::invalid_argument) << line;
+	}
+	EXPECT_EQ(rt.size(), 2);
+}
+
+TEST_F(routing_table_test, memory_resource)
+{
+	// Counts the entry allocations of a table
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		size_t allocations = 0;
+		size_t deallocations = 0;
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			allocations++;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void *p, size_t bytes, size_t alignment) override
+		{
+			deallocations++;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+		{
+			return this == &other;
+		}
+	} counting;
+	routing_table table(&counting);
+	routing_table_entry entry;
+
+	EXPECT_EQ(table.get_memory_resource(), &counting);
+	EXPECT_EQ(rt.get_memory_resource(), std::pmr::get_default_resource());
+
+	entry.gateway_ip_u32 = 0;
+	entry.destination_mask = 32;
+	entry.oif = "enp0s31f6.4094";  // the longest OIF fits into std::string
+	for (uint32_t i = 0; i < 1000; ++i) {
+		entry.destination_ip_u32 = i;
+		table.create_entry(entry);
+	}
+	EXPECT_EQ(counting.allocations, 1000);
+
+	table.clear();
+	EXPECT_EQ(counting.deallocations, 1000);
+
+	// Pooled entries are carved out of few chunks
+	std::pmr::unsynchronized_pool_resource pool(&counting);
+	routing_table pooled(&pool);
+	counting.allocations = 0;
+	for (uint32_t i = 0; i < 100'000; ++i) {
+		entry.destination_ip_u32 = i;
+		pooled.create_entry(entry);
+	}
+	EXPECT_LT(counting.allocations, 100);
+
+	// A copy compares equal, wherever its entries are
+	const routing_table copy(pooled);
+	EXPECT_EQ(copy, pooled);
+}
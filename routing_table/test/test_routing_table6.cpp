@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief IPv6 Routing Table Unit-Tests
+ */
+
+#include <memory_resource>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <routing_table6.hpp>
+#include <rtm_message.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+static inet6::address addr6(const std::string &str)
+{
+	uint8_t ip[16];
+
+	EXPECT_TRUE(inet6::parse(str, ip));
+	return inet6::load(ip);
+}
+
+TEST(routing_table6_test, str2ip)
+{
+	const auto entry = make_entry6("2001:db8:1::", 48, "fe80::1", "eth0");
+
+	EXPECT_EQ(entry.destination_ip[0], 0x20);
+	EXPECT_EQ(entry.destination_ip[5], 0x01);
+	EXPECT_EQ(routing_table6_entry::ip2str(entry.destination_ip), "2001:db8:1::");
+	EXPECT_EQ(routing_table6_entry::ip2str(entry.gateway_ip), "fe80::1");
+	EXPECT_EQ(entry.key(), addr6("2001:db8:1::"));
+
+	uint8_t ip[16];
+	EXPECT_FALSE(routing_table6_entry::str2ip("10.0.0.1", ip));
+}
+
+TEST(routing_table6_test, create_update_delete)
+{
+	routing_table6 table;
+	const auto e32 = make_entry6("2001:db8::", 32, "fe80::1", "eth0");
+	const auto e48 = make_entry6("2001:db8:1::", 48, "fe80::2", "eth1");
+	const auto e64 = make_entry6("2001:db8:1:2::", 64, "fe80::3", "eth2");
+
+	EXPECT_EQ(table.lookup(addr6("2001:db8::1")), nullptr);
+
+	table.create_entry(e32);
+	table.create_entry(e48);
+	table.create_entry(e64);
+	EXPECT_EQ(table.size(), 3);
+	// Tables never looked up take no lookup memory
+	EXPECT_EQ(table.lookup_memory_usage(), 0);
+	EXPECT_EQ(routing_table6(table).lookup_memory_usage(), 0);
+	EXPECT_EQ(*table.find(e48.key()), e48);
+
+	EXPECT_EQ(*table.lookup(addr6("2001:db8:1:2::1")), e64);
+	EXPECT_EQ(*table.lookup(addr6("2001:db8:1:3::1")), e48);
+	EXPECT_EQ(*table.lookup(addr6("2001:db8:2::1")), e32);
+	EXPECT_EQ(table.lookup(addr6("2001:db9::1")), nullptr);
+
+	// A shorter mask makes the /64 cover the /48
+	auto update = e64;
+	update.destination_mask = 16;
+	update.oif = "eth3";
+	EXPECT_TRUE(table.update_entry(update, RTM_FIELD_MASK));
+	EXPECT_EQ(table.find(e64.key())->oif, "eth2");
+	EXPECT_EQ(*table.lookup(addr6("2001:db8:1:2::1")), e48);
+	EXPECT_EQ(table.lookup(addr6("2001:db9::1"))->destination_mask, 16);
+
+	EXPECT_TRUE(table.update_entry(update, RTM_FIELD_OIF));
+	EXPECT_EQ(table.lookup(addr6("2001:db9::1"))->oif, "eth3");
+	EXPECT_FALSE(table.update_entry(make_entry6("2001:db8:5::", 48, "::", "")));
+
+	table.delete_entry(e48);
+	EXPECT_EQ(table.find(e48.key()), nullptr);
+	EXPECT_EQ(*table.lookup(addr6("2001:db8:1:3::1")), e32);
+
+	// Replacing an entry moves it to its new prefix
+	table.create_entry(make_entry6("2001:db8::", 24, "fe80::1", "eth0"));
+	EXPECT_EQ(table.size(), 2);
+	EXPECT_EQ(table.lookup(addr6("2001:db8:1::1"))->destination_mask, 24);
+
+	table.clear();
+	EXPECT_TRUE(table.empty());
+	EXPECT_EQ(table.lookup(addr6("2001:db8:1::1")), nullptr);
+}
+
+TEST(routing_table6_test, serialize)
+{
+	routing_table6 table;
+	std::vector<uint8_t> buffer;
+
+	for (int i = 0; i < 100; ++i) {
+		auto entry = make_entry6("2001:db8::", 48, "fe80::1", "eth" + std::to_string(i));
+		entry.destination_ip[4] = static_cast<uint8_t>(i);
+		table.create_entry(entry);
+	}
+
+	const size_t size = routing_table6::serialize(table, buffer);
+	routing_table6 copy;
+	EXPECT_EQ(routing_table6::deserialize(std::span(buffer).first(size), copy), size);
+	EXPECT_EQ(copy, table);
+	EXPECT_EQ(*copy.lookup(addr6("2001:db8:4200::1")), *table.find(addr6("2001:db8:4200::")));
+
+	EXPECT_THROW(routing_table6::deserialize(std::span(buffer).first(size - 1), copy),
+		     std::invalid_argument);
+}
+
+TEST(routing_table6_test, dump_load_text)
+{
+	routing_table6 table;
+
+	EXPECT_EQ(table.load_text("2001:db8::/32 fe80::1 eth0\n"
+				  "# comment\n"
+				  "\n"
+				  "2001:db8:1::/48 fe80::2 eth1\n"
+				  "::/0 fe80::3 eth2\n"), 3);
+	EXPECT_EQ(*table.find(addr6("2001:db8:1::")),
+		  make_entry6("2001:db8:1::", 48, "fe80::2", "eth1"));
+	EXPECT_EQ(table.lookup(addr6("2001:db9::1"))->oif, "eth2");
+
+	std::string dumped;
+	table.dump(dumped);
+	EXPECT_EQ(dumped, table.to_string());
+	EXPECT_NE(dumped.find("2001:db8:1::\t | 2001:db8:1::/48\t | fe80::2\t | eth1\n"),
+		  std::string::npos);
+
+	// Reload the routes in text form:
+	std::string text;
+	table.for_each([&text](const routing_table6_entry &entry) {
+		text += routing_table6_entry::ip2str(entry.destination_ip) + "/" +
+			std::to_string(entry.destination_mask) + "\t" +
+			routing_table6_entry::ip2str(entry.gateway_ip) + " " + entry.oif + "\n";
+	});
+	routing_table6 loaded;
+	EXPECT_EQ(loaded.load_text(text), 3);
+	EXPECT_EQ(loaded, table);
+
+	EXPECT_THROW(table.load_text("2001:db8::/129 fe80::1 eth0"), std::invalid_argument);
+	EXPECT_THROW(table.load_text("10.0.0.0/8 fe80::1 eth0"), std::invalid_argument);
+	EXPECT_THROW(table.load_text("2001:db8::/32 fe80::1"), std::invalid_argument);
+	EXPECT_EQ(table.size(), 3);
+}
+
+TEST(routing_table6_test, bulk_load_and_for_each_from)
+{
+	std::pmr::unsynchronized_pool_resource pool;
+	routing_table6 table(&pool);
+	std::vector<routing_table6_entry> entries;
+
+	EXPECT_EQ(table.get_memory_resource(), &pool);
+	for (int i = 9; i >= 0; --i) {
+		auto entry = make_entry6("2001:db8::", 48, "fe80::1", "eth" + std::to_string(i));
+		entry.destination_ip[4] = static_cast<uint8_t>(i);
+		entries.push_back(entry);
+	}
+	// A later entry replaces an earlier one with the same key
+	entries.push_back(make_entry6("2001:db8::", 32, "fe80::1", "eth9"));
+	table.bulk_load(entries);
+	EXPECT_EQ(table.size(), 10);
+	EXPECT_EQ(table.find(addr6("2001:db8::"))->destination_mask, 32);
+
+	std::vector<std::string> oifs;
+	table.for_each_from(addr6("2001:db8:700::"), [&](const routing_table6_entry &entry) {
+		oifs.push_back(entry.oif);
+		return oifs.size() < 2;
+	});
+	EXPECT_EQ(oifs, (std::vector<std::string>{"eth7", "eth8"}));
+}
+
+TEST(routing_table6_test, aggregation)
+{
+	routing_table6 table;
+
+	table.create_entry(make_entry6("2001:db8::", 32, "fe80::1", "eth0"));
+	table.create_entry(make_entry6("2001:db8:1::", 48, "fe80::1", "eth0"));
+	table.create_entry(make_entry6("2001:db8:2::", 48, "fe80::2", "eth1"));
+	table.set_aggregation(true);
+
+	// The /48 with the next hop of its covering /32 is merged into it
+	const auto *fib = table.get_fib();
+	ASSERT_NE(fib, nullptr);
+	EXPECT_EQ(fib->num_routes(), 3);
+	EXPECT_EQ(fib->size(), 2);
+	for (const char *addr : {"2001:db8:1::1", "2001:db8:2::1", "2001:db8:3::1"}) {
+		const auto *route = table.lookup(addr6(addr));
+		const auto *nh = fib->lookup(addr6(addr));
+		ASSERT_NE(nh, nullptr) << addr;
+		EXPECT_EQ(nh->oif, route->oif) << addr;
+		EXPECT_TRUE(std::equal(std::begin(nh->gateway_ip), std::end(nh->gateway_ip),
+				       route->gateway_ip)) << addr;
+	}
+	EXPECT_EQ(fib->lookup(addr6("2001:db9::1")), nullptr);
+
+	// Changes are applied to the FIB
+	auto update = make_entry6("2001:db8:2::", 48, "fe80::1", "eth0");
+	EXPECT_TRUE(table.update_entry(update, RTM_FIELD_GATEWAY | RTM_FIELD_OIF));
+	EXPECT_EQ(fib->size(), 1);
+	table.delete_entry(make_entry6("2001:db8::", 32, "::", ""));
+	EXPECT_EQ(fib->size(), 2);
+	EXPECT_EQ(fib->lookup(addr6("2001:db8:3::1")), nullptr);
+}
+
+TEST(routing_table6_test, messages)
+{
+	const auto entry = make_entry6("2001:db8:1::", 48, "fe80::2", "eth1");
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	const auto msg = rtm_message::make(RTM_CREATE6, entry);
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_EQ(hdr.opcode, RTM_CREATE6);
+
+	std::vector<routing_table6_entry> entries;
+	EXPECT_TRUE(rtm_message::for_each_entry<routing_table6_entry>(hdr, payload,
+		[&](const routing_table6_entry &e) { entries.push_back(e); }));
+	ASSERT_EQ(entries.size(), 1);
+	EXPECT_EQ(entries[0], entry);
+
+	// The address sizes tell the IPv4 and IPv6 entries apart
+	EXPECT_FALSE(rtm_message::for_each_entry(hdr, payload,
+		[](const routing_table_entry&) {}));
+	routing_table_entry entry4;
+	entry4.oif = "eth0";
+	const auto msg4 = rtm_message::make(RTM_CREATE, entry4);
+	ASSERT_TRUE(rtm_message::parse(msg4, hdr, payload));
+	EXPECT_FALSE(rtm_message::for_each_entry<routing_table6_entry>(hdr, payload,
+		[](const routing_table6_entry&) {}));
+
+	auto update = entry;
+	update.oif = "eth9";
+	const auto delta = rtm_message::make_update(update, RTM_FIELD_OIF);
+	ASSERT_TRUE(rtm_message::parse(delta, hdr, payload));
+	EXPECT_EQ(hdr.opcode, RTM_UPDATE6);
+
+	routing_table6 table;
+	table.create_entry(entry);
+	EXPECT_TRUE(rtm_message::for_each_delta<routing_table6_entry>(hdr, payload,
+		[&](const routing_table6_entry &e, uint32_t fields) {
+			EXPECT_EQ(fields, RTM_FIELD_OIF);
+			EXPECT_TRUE(table.update_entry(e, fields));
+		}));
+	EXPECT_EQ(*table.find(entry.key()), update);
+}
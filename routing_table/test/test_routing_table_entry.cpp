@@ -213,3 +213,46 @@ TEST(routing_table_entry, deserialize)
 
 	EXPECT_EQ(entry1, entry2);
 }
+
+TEST(routing_table_entry, serialize_delta)
+{
+	routing_table_entry entry1;
+	routing_table_entry entry2;
+	uint32_t fields = 0;
+	std::vector<uint8_t> buffer;
+
+	EXPECT_TRUE(routing_table_entry::str2ip("17.91.123.0", entry1.destination_ip));
+	EXPECT_TRUE(routing_table_entry::str2ip("21.22.33.44", entry1.gateway_ip));
+	entry1.destination_mask = 24;
+	entry1.oif = "foo_eth0";
+	entry2.destination_mask = 16;
+	entry2.oif = "bar_eth1";
+
+	// A gateway change: key, fields and gateway only
+	buffer.resize(entry1.delta_size(RTM_FIELD_GATEWAY));
+	EXPECT_EQ(buffer.size(), 12);
+	EXPECT_EQ(routing_table_entry::serialize_delta(entry1, RTM_FIELD_GATEWAY,
+						       buffer.data()), buffer.size());
+	EXPECT_EQ(routing_table_entry::deserialize_delta(buffer, entry2, fields),
+		  buffer.size());
+	EXPECT_EQ(fields, RTM_FIELD_GATEWAY);
+	EXPECT_EQ(entry2.destination_ip_u32, entry1.destination_ip_u32);
+	EXPECT_EQ(entry2.gateway_ip_u32, entry1.gateway_ip_u32);
+	EXPECT_EQ(entry2.destination_mask, 16);
+	EXPECT_EQ(entry2.oif, "bar_eth1");
+
+	buffer.resize(entry1.delta_size(RTM_FIELD_ALL));
+	EXPECT_EQ(routing_table_entry::serialize_delta(entry1, RTM_FIELD_ALL,
+						       buffer.data()), buffer.size());
+	EXPECT_EQ(routing_table_entry::deserialize_delta(buffer, entry2, fields),
+		  buffer.size());
+	EXPECT_EQ(fields, RTM_FIELD_ALL);
+	EXPECT_EQ(entry2, entry1);
+
+	// Truncated deltas and unknown fields are malformed
+	EXPECT_EQ(routing_table_entry::deserialize_delta(
+			std::span<const uint8_t>(buffer).first(buffer.size() - 1),
+			entry2, fields), 0);
+	buffer[4] = 0x08;
+	EXPECT_EQ(routing_table_entry::deserialize_delta(buffer, entry2, fields), 0);
+}
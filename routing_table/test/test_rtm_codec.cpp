@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Wire Codec Unit-Tests
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <rtm_message.hpp>
+#include <rtm_subscription.hpp>
+
+
+using namespace RTM;
+
+struct point {
+	uint16_t x;
+	uint32_t y;
+	std::string name;
+};
+
+using point_codec = wire::codec<point,
+	wire::uint_field<&point::x>,
+	wire::uint_field<&point::y>,
+	wire::string_field<&point::name>>;
+
+static_assert(rtm_msg_hdr_codec::fixed && rtm_msg_hdr_codec::min_size == 8);
+static_assert(rtm_sync_done_codec::fixed && rtm_sync_done_codec::min_size == 8);
+static_assert(!point_codec::fixed && point_codec::min_size == 10);
+static_assert(routing_table_entry_codec::min_size == 4 + 8 + 8 + 5 + 4);
+
+TEST(rtm_codec_test, little_endian)
+{
+	const point p = {0x0102, 0x03040506, "ab"};
+	std::vector<uint8_t> buffer;
+
+	EXPECT_EQ(wire::append<point_codec>(buffer, p), point_codec::size(p));
+	EXPECT_EQ(buffer, (std::vector<uint8_t>{0x02, 0x01, 0x06, 0x05, 0x04, 0x03,
+						2, 0, 0, 0, 'a', 'b'}));
+
+	point q = {};
+	EXPECT_EQ(wire::read<point_codec>(buffer, q), buffer.size());
+	EXPECT_EQ(q.x, p.x);
+	EXPECT_EQ(q.y, p.y);
+	EXPECT_EQ(q.name, p.name);
+
+	// Truncated anywhere
+	for (size_t size = 0; size < buffer.size(); ++size) {
+		EXPECT_EQ(wire::read<point_codec>(std::span(buffer).first(size), q), 0);
+	}
+}
+
+TEST(rtm_codec_test, messages)
+{
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	const auto msg = rtm_message::make<rtm_sync_done_codec>(RTM_SYNC_DONE,
+								{0x1122334455667788});
+	ASSERT_EQ(msg.size(), 16);
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_EQ(hdr.opcode, RTM_SYNC_DONE);
+	EXPECT_EQ(hdr.count, 0);
+
+	rtm_sync_done sync_done;
+	ASSERT_TRUE(rtm_message::parse<rtm_sync_done_codec>(payload, sync_done));
+	EXPECT_EQ(sync_done.ring_position, 0x1122334455667788);
+	EXPECT_FALSE(rtm_message::parse<rtm_sync_done_codec>(payload.first(7), sync_done));
+
+	rtm_ring_info info;
+	EXPECT_FALSE(rtm_message::parse<rtm_ring_info_codec>(payload, info));
+}
+
+TEST(rtm_codec_test, malformed_entries)
+{
+	routing_table_entry entry;
+	entry.gateway_ip_u32 = 0x0a000001;
+	entry.destination_mask = 24;
+	entry.oif = "eth0";
+
+	std::vector<uint8_t> msg;
+	rtm_message::init(msg, RTM_CREATE);
+	rtm_message::append_entry(msg, entry);
+
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_TRUE(rtm_message::for_each_entry(hdr, payload,
+						[](const routing_table_entry&) {}));
+
+	// A wrong field size, a total size beyond the record and an OIF beyond it
+	for (const size_t offset : {sizeof(uint32_t), size_t(0), size_t(25)}) {
+		auto bad = msg;
+		bad[sizeof(rtm_msg_hdr) + offset]++;
+		ASSERT_TRUE(rtm_message::parse(bad, hdr, payload));
+		EXPECT_FALSE(rtm_message::for_each_entry(hdr, payload,
+							 [](const routing_table_entry&) {}));
+	}
+}
+
+TEST(rtm_codec_test, subscription_filters)
+{
+	std::vector<subscription_filter> filters(2), parsed;
+	ASSERT_TRUE(subscription_filter::from_string("10.0.0.0/8", filters[0]));
+	ASSERT_TRUE(subscription_filter::from_string(",eth1", filters[1]));
+
+	std::vector<uint8_t> buffer;
+	const size_t size = subscription_filter::serialize(filters, buffer);
+	EXPECT_EQ(size, 4 + 9 + 9 + 4);
+	EXPECT_EQ(subscription_filter::deserialize(buffer, parsed), size);
+	EXPECT_EQ(parsed, filters);
+
+	buffer[4 + 4] = 33;
+	EXPECT_EQ(subscription_filter::deserialize(buffer, parsed), 0);
+	EXPECT_TRUE(parsed.empty());
+}
+
+TEST(rtm_codec_test, lookup_messages)
+{
+	const std::vector<uint32_t> addrs = {0x0a000001, 0x0a000002, 0x0b000001};
+	std::vector<uint8_t> msg;
+	rtm_msg_hdr hdr;
+	std::span<const uint8_t> payload;
+
+	rtm_message::make_lookup(msg, 7, addrs);
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_EQ(hdr.opcode, RTM_LOOKUP);
+
+	rtm_lookup lookup;
+	std::vector<uint32_t> parsed;
+	EXPECT_TRUE(rtm_message::for_each_address(hdr, payload, lookup,
+						  [&](uint32_t addr) { parsed.push_back(addr); }));
+	EXPECT_EQ(lookup.id, 7);
+	EXPECT_EQ(parsed, addrs);
+	EXPECT_FALSE(rtm_message::for_each_address(hdr, payload.first(payload.size() - 1),
+						   lookup, [](uint32_t) {}));
+
+	// Two addresses via the same next hop
+	const rtm_fib::next_hop nh = {0x0100000a, "eth0"};
+	const rtm_fib::next_hop *next_hops[] = {&nh};
+	const rtm_lookup_result results[] = {{24, 1}, {24, 1}, {0, 0}};
+	ASSERT_TRUE(rtm_message::make_lookup_reply(msg, 7, next_hops, results));
+	EXPECT_EQ(msg.size(), 8 + 8 + 4 + 4 + 4 + 3 * 3);
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_EQ(hdr.opcode, RTM_LOOKUP_REPLY);
+
+	rtm_lookup_reply reply;
+	std::vector<rtm_fib::next_hop> parsed_next_hops;
+	std::vector<rtm_lookup_result> parsed_results;
+	ASSERT_TRUE(rtm_message::parse_lookup_reply(hdr, payload, reply, parsed_next_hops,
+						    parsed_results));
+	EXPECT_EQ(reply.id, 7);
+	ASSERT_EQ(parsed_next_hops.size(), 1);
+	EXPECT_EQ(parsed_next_hops[0], nh);
+	ASSERT_EQ(parsed_results.size(), 3);
+	EXPECT_EQ(parsed_results[1].prefix_len, 24);
+	EXPECT_EQ(parsed_results[1].next_hop, 1);
+	EXPECT_EQ(parsed_results[2].next_hop, 0);
+
+	// A route referring to a next hop not in the reply
+	msg.back() = 2;
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_FALSE(rtm_message::parse_lookup_reply(hdr, payload, reply, parsed_next_hops,
+						     parsed_results));
+
+	// A reply exceeding the message size is sent empty
+	const rtm_fib::next_hop long_nh = {1, std::string(RTM_MAX_MSG_SIZE, 'x')};
+	const rtm_fib::next_hop *long_next_hops[] = {&long_nh};
+	EXPECT_FALSE(rtm_message::make_lookup_reply(msg, 8, long_next_hops, results));
+	ASSERT_TRUE(rtm_message::parse(msg, hdr, payload));
+	EXPECT_EQ(hdr.count, 0);
+}
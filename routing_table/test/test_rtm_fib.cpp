@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Aggregated FIB Unit-Tests
+ */
+
+#include <array>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <routing_table.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+static std::vector<std::tuple<uint32_t, uint8_t, rtm_fib::next_hop>>
+fib_prefixes(const rtm_fib &fib)
+{
+	std::vector<std::tuple<uint32_t, uint8_t, rtm_fib::next_hop>> prefixes;
+
+	fib.for_each([&](uint32_t prefix, uint8_t len, const rtm_fib::next_hop &nh) {
+		prefixes.emplace_back(prefix, len, nh);
+	});
+	return prefixes;
+}
+
+TEST(rtm_fib_test, merge)
+{
+	rtm_fib fib;
+
+	// Siblings with the same next hop
+	fib.insert(0x0a000000, 25, {1, "ens0"});
+	fib.insert(0x0a000080, 25, {1, "ens0"});
+	EXPECT_EQ(fib.num_routes(), 2);
+	ASSERT_EQ(fib.size(), 1);
+	EXPECT_EQ(std::get<0>(fib_prefixes(fib).front()), 0x0a000000);
+	EXPECT_EQ(std::get<1>(fib_prefixes(fib).front()), 24);
+
+	// Children with the next hop of the covering route
+	fib.insert(0x0a000000, 8, {1, "ens0"});
+	fib.insert(0x0a010000, 16, {1, "ens0"});
+	EXPECT_EQ(fib.size(), 1);
+	EXPECT_EQ(std::get<1>(fib_prefixes(fib).front()), 8);
+
+	// A different next hop splits the aggregate
+	fib.insert(0x0a000005, 32, {2, "ens1"});
+	EXPECT_EQ(fib.size(), 2);
+	EXPECT_EQ(fib.num_next_hops(), 2);
+	EXPECT_EQ(fib.lookup(0x0a000005)->gateway_ip_u32, 2);
+	EXPECT_EQ(fib.lookup(0x0a000004)->gateway_ip_u32, 1);
+	EXPECT_EQ(fib.lookup(0x0b000000), nullptr);
+
+	uint8_t len;
+	EXPECT_EQ(fib.lookup(0x0a000005, len)->gateway_ip_u32, 2);
+	EXPECT_EQ(len, 32);
+	EXPECT_EQ(fib.lookup(0x0a000004, len)->gateway_ip_u32, 1);
+	EXPECT_EQ(len, 8);
+
+	// The same next hop with another OIF is another next hop
+	fib.insert(0x0a000080, 25, {1, "ens1"});
+	EXPECT_EQ(fib.lookup(0x0a000081)->oif, "ens1");
+	EXPECT_EQ(fib.lookup(0x0a000001)->oif, "ens0");
+
+	EXPECT_TRUE(fib.erase(0x0a000005, 32));
+	EXPECT_TRUE(fib.erase(0x0a000080, 25));
+	EXPECT_FALSE(fib.erase(0x0a000080, 25));
+	EXPECT_EQ(fib.size(), 1);
+	EXPECT_EQ(fib.num_next_hops(), 1);
+
+	fib.clear();
+	EXPECT_EQ(fib.size(), 0);
+	EXPECT_EQ(fib.lookup(0x0a000001), nullptr);
+}
+
+TEST(rtm_fib_test, routing_table_churn)
+{
+	std::mt19937 rng(7);
+	routing_table table;
+	std::vector<routing_table_entry> entries;
+
+	// Nested and adjacent prefixes of 10.0.0.0/16 with few next hops
+	table.set_aggregation(true);
+	for (int i = 0; i < 4000; ++i) {
+		const uint8_t ip[4] = {10, 0, static_cast<uint8_t>(rng() % 8),
+				       static_cast<uint8_t>(rng())};
+		const uint8_t mask = std::array<uint8_t, 6>{0, 16, 20, 24, 25, 32}[rng() % 6];
+		const uint32_t gateway = rng() % 3;
+		const auto entry = make_entry(make_key(ip[0], ip[1], ip[2], ip[3]), mask,
+					      rng() % 4 ? "ens0" : "ens1", gateway);
+
+		const auto op = rng() % 8;
+		if (op < 2 && !entries.empty()) {
+			const auto victim = entries[rng() % entries.size()];
+			table.delete_entry(victim);
+		} else if (op < 4 && !entries.empty()) {
+			auto delta = entries[rng() % entries.size()];
+			delta.gateway_ip_u32 = rng() % 3;
+			delta.destination_mask = mask;
+			table.update_entry(delta, op == 2 ? RTM_FIELD_GATEWAY :
+						  RTM_FIELD_MASK | RTM_FIELD_GATEWAY);
+		} else {
+			table.create_entry(entry);
+			entries.push_back(entry);
+		}
+
+		for (int j = 0; j < 8; ++j) {
+			const uint32_t addr = 0x0a000000 | (rng() & 0x7ff);
+			const auto *route = table.lookup(addr);
+			const auto *nh = table.get_fib()->lookup(addr);
+			ASSERT_EQ(route == nullptr, nh == nullptr);
+			if (route != nullptr) {
+				ASSERT_EQ(route->gateway_ip_u32, nh->gateway_ip_u32);
+				ASSERT_EQ(route->oif, nh->oif);
+			}
+		}
+	}
+
+	// Maintained incrementally like built at once
+	routing_table copy = table;
+	EXPECT_EQ(fib_prefixes(*copy.get_fib()), fib_prefixes(*table.get_fib()));
+	copy.set_aggregation(false);
+	copy.set_aggregation(true);
+	EXPECT_EQ(fib_prefixes(*copy.get_fib()), fib_prefixes(*table.get_fib()));
+	EXPECT_LT(table.get_fib()->size(), table.get_fib()->num_routes());
+
+	table.clear();
+	EXPECT_EQ(table.get_fib()->size(), 0);
+	table.create_entry(entries.front());
+	EXPECT_EQ(table.get_fib()->num_routes(), 1);
+
+	table.set_aggregation(false);
+	EXPECT_EQ(table.get_fib(), nullptr);
+}
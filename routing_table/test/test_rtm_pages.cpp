@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Pre-encoded Table State Unit-Tests
+ */
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <rtm_pages.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+/**
+ * @brief Decode the pages into a table, checking each page on the way
+ */
+static routing_table decode_pages(const std::vector<rtm_pages::page_ptr> &pages,
+				  size_t page_size)
+{
+	routing_table table;
+	std::optional<uint32_t> last_key;
+
+	for (const auto &page : pages) {
+		rtm_msg_hdr hdr;
+		std::span<const uint8_t> payload;
+
+		EXPECT_TRUE(rtm_message::parse(*page, hdr, payload));
+		EXPECT_EQ(hdr.opcode, RTM_CREATE);
+		EXPECT_GT(hdr.count, 0);
+		EXPECT_TRUE(hdr.count == 1 || page->size() <= page_size);
+		EXPECT_TRUE(rtm_message::for_each_entry(hdr, payload,
+							[&](const routing_table_entry &entry) {
+			// Key order across all pages
+			EXPECT_TRUE(!last_key || *last_key < entry.destination_ip_u32);
+			last_key = entry.destination_ip_u32;
+			table.create_entry(entry);
+		}));
+	}
+	return table;
+}
+
+TEST(rtm_pages_test, encode)
+{
+	constexpr size_t page_size = 1024;
+	routing_table table;
+	rtm_pages pages(page_size);
+
+	EXPECT_TRUE(pages.get(table).empty());
+
+	// The first and last keys of the key space
+	table.create_entry(make_entry(0, 32, "ens0", 1));
+	table.create_entry(make_entry(~uint32_t(0), 32, "ens0", 2));
+	for (uint32_t i = 1; i <= 1000; ++i) {
+		table.create_entry(make_entry(i * 4096, 32, "eth" + std::to_string(i % 8), i));
+	}
+	pages.clear();
+
+	const auto &encoded = pages.get(table);
+	EXPECT_GT(encoded.size(), 1);
+	EXPECT_EQ(pages.num_encoded(), table.size());
+	EXPECT_EQ(decode_pages(encoded, page_size), table);
+
+	// Nothing changed, nothing encoded
+	EXPECT_EQ(&pages.get(table), &encoded);
+	EXPECT_EQ(pages.num_encoded(), table.size());
+}
+
+TEST(rtm_pages_test, invalidate)
+{
+	constexpr size_t page_size = 1024;
+	routing_table table;
+	rtm_pages pages(page_size);
+
+	for (uint32_t i = 1; i <= 1000; ++i) {
+		table.create_entry(make_entry(i * 4096, 32, "ens0", i));
+	}
+	const auto before = pages.get(table);
+	const size_t num_encoded = pages.num_encoded();
+
+	// An update re-encodes the page of its entry only
+	auto entry = make_entry(500 * 4096, 32, "eth1", 7);
+	table.update_entry(entry);
+	pages.invalidate(entry.destination_ip_u32);
+
+	const auto after = pages.get(table);
+	const size_t per_page = page_size / entry.serialized_size();
+	EXPECT_LE(pages.num_encoded() - num_encoded, per_page);
+	EXPECT_EQ(decode_pages(after, page_size), table);
+
+	const std::set<rtm_pages::page_ptr> old_pages(before.begin(), before.end());
+	size_t num_reused = 0;
+	for (const auto &page : after) {
+		num_reused += old_pages.count(page);
+	}
+	EXPECT_EQ(num_reused, before.size() - 1);
+
+	// Entries created before the first and after the last one
+	table.create_entry(make_entry(1, 32, "ens0", 1));
+	pages.invalidate(1);
+	table.create_entry(make_entry(~uint32_t(0), 32, "ens0", 1));
+	pages.invalidate(~uint32_t(0));
+	EXPECT_EQ(decode_pages(pages.get(table), page_size), table);
+
+	// Deleting all entries leaves no pages
+	std::vector<routing_table_entry> entries;
+	table.for_each([&](const routing_table_entry &entry) {
+		entries.push_back(entry);
+	});
+	for (const auto &entry : entries) {
+		table.delete_entry(entry);
+		pages.invalidate(entry.destination_ip_u32);
+	}
+	EXPECT_TRUE(pages.get(table).empty());
+}
+
+TEST(rtm_pages_test, random_operations)
+{
+	constexpr size_t page_size = 512;
+	std::mt19937 rng(7);
+	routing_table table;
+	rtm_pages pages(page_size);
+
+	for (int round = 0; round < 50; ++round) {
+		for (int i = 0; i < 20; ++i) {
+			const uint32_t key = rng() % 2048 * 0x200000;
+			auto entry = make_entry(key, 32, "eth" + std::to_string(rng() % 4), rng());
+			switch (rng() % 3) {
+			case 0:
+				table.create_entry(entry);
+				break;
+			case 1:
+				table.update_entry(entry, RTM_FIELD_GATEWAY);
+				break;
+			default:
+				table.delete_entry(entry);
+				break;
+			}
+			pages.invalidate(key);
+		}
+		ASSERT_EQ(decode_pages(pages.get(table), page_size), table);
+	}
+}
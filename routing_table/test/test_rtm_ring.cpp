@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Shared Memory Ring Unit-Tests
+ */
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <rtm_ring.hpp>
+
+
+using namespace RTM;
+
+
+static std::vector<uint8_t> make_msg(uint32_t seq, size_t size)
+{
+	std::vector<uint8_t> msg(size);
+
+	for (size_t i = 0; i < size; ++i) {
+		msg[i] = static_cast<uint8_t>(seq + i);
+	}
+
+	return msg;
+}
+
+TEST(rtm_ring, publish_read)
+{
+	auto ring = rtm_ring::create(4096, 4);
+	std::vector<uint8_t> msg;
+	uint64_t position = 0;
+
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_EMPTY);
+
+	ring->publish(make_msg(1, 13));
+	ring->publish(make_msg(2, 64));
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_OK);
+	EXPECT_EQ(msg, make_msg(1, 13));
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_OK);
+	EXPECT_EQ(msg, make_msg(2, 64));
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_EMPTY);
+	EXPECT_EQ(position, ring->head());
+
+	// Larger than a quarter of the ring:
+	EXPECT_THROW(ring->publish(make_msg(3, 1024)), std::invalid_argument);
+}
+
+TEST(rtm_ring, wrap_around)
+{
+	auto ring = rtm_ring::create(4096, 4);
+	std::vector<uint8_t> msg;
+	uint64_t position = 0;
+
+	// Odd sized messages do not fit the end of the data area exactly
+	for (uint32_t i = 0; i < 1000; ++i) {
+		ring->publish(make_msg(i, 100 + i % 7));
+		EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_OK);
+		EXPECT_EQ(msg, make_msg(i, 100 + i % 7));
+	}
+	EXPECT_GT(position, ring->capacity() * 10);
+}
+
+TEST(rtm_ring, overrun)
+{
+	auto ring = rtm_ring::create(4096, 4);
+	std::vector<uint8_t> msg;
+	uint64_t position = 0;
+
+	ring->publish(make_msg(0, 100));
+	for (uint32_t i = 1; i < 100; ++i) {
+		ring->publish(make_msg(i, 100));
+	}
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_OVERRUN);
+
+	// A consumer starting at the head follows again
+	position = ring->head();
+	ring->publish(make_msg(100, 100));
+	EXPECT_EQ(ring->read(position, msg), rtm_ring::RING_OK);
+	EXPECT_EQ(msg, make_msg(100, 100));
+}
+
+TEST(rtm_ring, attach)
+{
+	auto ring = rtm_ring::create(8192, 4);
+	auto consumer = rtm_ring::attach(dup(ring->fd()));
+	std::vector<uint8_t> msg;
+	uint64_t position = consumer->head();
+
+	EXPECT_EQ(consumer->capacity(), 8192);
+	EXPECT_EQ(consumer->max_consumers(), 4);
+
+	ring->publish(make_msg(7, 33));
+	EXPECT_EQ(consumer->read(position, msg), rtm_ring::RING_OK);
+	EXPECT_EQ(msg, make_msg(7, 33));
+
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	close(fds[1]);
+	EXPECT_THROW(rtm_ring::attach(fds[0]), std::exception);
+}
+
+TEST(rtm_ring, wakeup)
+{
+	auto ring = rtm_ring::create(4096, 4);
+	uint64_t position = ring->head();
+
+	EXPECT_FALSE(ring->take_wakeup(1));
+	EXPECT_TRUE(ring->arm_wakeup(1, position));
+	EXPECT_TRUE(ring->take_wakeup(1));
+	EXPECT_FALSE(ring->take_wakeup(1));
+
+	// Messages published meanwhile: the consumer must not sleep
+	ring->publish(make_msg(1, 8));
+	EXPECT_FALSE(ring->arm_wakeup(2, position));
+
+	EXPECT_THROW(ring->arm_wakeup(4, position), std::out_of_range);
+}
+
+TEST(rtm_ring, concurrent_consumer)
+{
+	auto ring = rtm_ring::create(64 * 1024, 4);
+	std::atomic<bool> done = false;
+	constexpr uint32_t NUM_MSGS = 100000;
+
+	// The consumer sees every message in order or detects the overrun
+	std::thread consumer([&]() {
+		std::vector<uint8_t> msg;
+		uint64_t position = 0;
+		uint32_t expected = 0;
+		bool resync = false;
+		while (expected < NUM_MSGS) {
+			const auto status = ring->read(position, msg);
+			if (status == rtm_ring::RING_EMPTY) {
+				if (done) {
+					break;
+				}
+				continue;
+			}
+			if (status == rtm_ring::RING_OVERRUN) {
+				position = ring->head();
+				resync = true;
+				continue;
+			}
+			uint32_t seq;
+			ASSERT_EQ(msg.size(), 64);
+			std::memcpy(&seq, msg.data(), sizeof(seq));
+			// No gaps, except after a resynchronization
+			if (!resync) {
+				ASSERT_EQ(seq, expected);
+			}
+			resync = false;
+			for (size_t i = sizeof(seq); i < msg.size(); ++i) {
+				ASSERT_EQ(msg[i], static_cast<uint8_t>(seq));
+			}
+			expected = seq + 1;
+		}
+	});
+
+	std::vector<uint8_t> msg(64);
+	for (uint32_t seq = 0; seq < NUM_MSGS; ++seq) {
+		std::memset(msg.data(), static_cast<uint8_t>(seq), msg.size());
+		std::memcpy(msg.data(), &seq, sizeof(seq));
+		ring->publish(msg);
+	}
+	done = true;
+	consumer.join();
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Persistent Store Unit-Tests
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+#include <rtm_store.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+// Entry i of the test tables: 10.<i>/<mask> via gateway i and ens<i % 8>
+static routing_table_entry numbered_entry(uint32_t i, uint8_t mask)
+{
+	return make_entry(make_key(10, i >> 16, i >> 8, i), mask,
+			  "ens" + std::to_string(i % 8), i);
+}
+
+class rtm_store_test : public ::testing::Test {
+public:
+	std::string dir;
+protected:
+	void SetUp() override
+	{
+		char tmpl[] = "/tmp/rtm_store_XXXXXX";
+		ASSERT_NE(mkdtemp(tmpl), nullptr);
+		dir = tmpl;
+	}
+	void TearDown() override
+	{
+		std::filesystem::remove_all(dir);
+	}
+};
+
+
+TEST_F(rtm_store_test, replay_wal)
+{
+	routing_table table;
+	{
+		rtm_store store(dir);
+		store.open(table);
+		EXPECT_EQ(store.generation(), 0);
+
+		for (uint32_t i = 0; i < 100; ++i) {
+			table.create_entry(numbered_entry(i, 32));
+			store.append(RTM_CREATE, numbered_entry(i, 32));
+		}
+		store.commit();
+		table.create_entry(numbered_entry(5, 24));
+		store.append(RTM_UPDATE, numbered_entry(5, 24));
+		table.delete_entry(numbered_entry(7, 32));
+		store.append(RTM_DELETE, numbered_entry(7, 32));
+		// A gateway change is logged as a delta
+		auto delta = numbered_entry(8, 16);
+		delta.gateway_ip_u32 = 42;
+		table.update_entry(delta, RTM_FIELD_GATEWAY);
+		store.append(RTM_UPDATE, delta, RTM_FIELD_GATEWAY);
+		// Committed by close()
+	}
+
+	routing_table restored;
+	rtm_store store(dir);
+	store.open(restored);
+	EXPECT_EQ(store.num_replayed(), 103);
+	EXPECT_EQ(restored, table);
+	EXPECT_EQ(restored.at(numbered_entry(5, 24).destination_ip_u32).destination_mask, 24);
+	EXPECT_EQ(restored.at(numbered_entry(8, 32).destination_ip_u32).gateway_ip_u32, 42);
+	EXPECT_EQ(restored.at(numbered_entry(8, 32).destination_ip_u32).destination_mask, 32);
+}
+
+TEST_F(rtm_store_test, snapshot)
+{
+	routing_table table;
+	rtm_store store(dir, 1024);
+
+	store.open(table);
+	for (uint32_t i = 0; !store.needs_snapshot(); ++i) {
+		table.create_entry(numbered_entry(i, 32));
+		store.append(RTM_CREATE, numbered_entry(i, 32));
+		store.commit();
+	}
+	store.snapshot(table);
+	EXPECT_EQ(store.generation(), 1);
+	EXPECT_FALSE(store.needs_snapshot());
+
+	// The log continues the snapshot:
+	table.delete_entry(numbered_entry(0, 32));
+	store.append(RTM_DELETE, numbered_entry(0, 32));
+	table.create_entry(numbered_entry(1000, 16));
+	store.append(RTM_CREATE, numbered_entry(1000, 16));
+	store.close();
+
+	routing_table restored;
+	store.open(restored);
+	EXPECT_EQ(store.generation(), 1);
+	EXPECT_EQ(store.num_replayed(), 2);
+	EXPECT_EQ(restored, table);
+}
+
+TEST_F(rtm_store_test, torn_wal)
+{
+	routing_table table;
+	{
+		rtm_store store(dir);
+		store.open(table);
+		for (uint32_t i = 0; i < 10; ++i) {
+			table.create_entry(numbered_entry(i, 32));
+			store.append(RTM_CREATE, numbered_entry(i, 32));
+		}
+	}
+	const auto wal_size = std::filesystem::file_size(dir + "/rtm.wal");
+
+	// A record cut off by a crash:
+	std::filesystem::resize_file(dir + "/rtm.wal", wal_size - 3);
+	table.delete_entry(numbered_entry(9, 32));
+
+	routing_table restored;
+	{
+		rtm_store store(dir);
+		store.open(restored);
+		EXPECT_EQ(store.num_replayed(), 9);
+		EXPECT_EQ(restored, table);
+
+		// Appended behind the last complete record:
+		table.create_entry(numbered_entry(42, 32));
+		store.append(RTM_CREATE, numbered_entry(42, 32));
+	}
+
+	routing_table reopened;
+	rtm_store store(dir);
+	store.open(reopened);
+	EXPECT_EQ(store.num_replayed(), 10);
+	EXPECT_EQ(reopened, table);
+}
+
+TEST_F(rtm_store_test, stale_wal)
+{
+	routing_table table;
+	rtm_store store(dir);
+
+	store.open(table);
+	table.create_entry(numbered_entry(1, 32));
+	store.append(RTM_CREATE, numbered_entry(1, 32));
+	store.commit();
+	const auto old_wal = dir + "/rtm.wal.old";
+	std::filesystem::copy_file(dir + "/rtm.wal", old_wal);
+	store.snapshot(table);
+	store.close();
+
+	// Crashed before the log was reset: the old log is not replayed again
+	std::filesystem::rename(old_wal, dir + "/rtm.wal");
+	routing_table restored;
+	store.open(restored);
+	EXPECT_EQ(store.num_replayed(), 0);
+	EXPECT_EQ(restored, table);
+}
+
+TEST_F(rtm_store_test, corrupt_snapshot)
+{
+	routing_table table;
+	{
+		rtm_store store(dir);
+		store.open(table);
+		table.create_entry(numbered_entry(1, 32));
+		store.append(RTM_CREATE, numbered_entry(1, 32));
+		store.snapshot(table);
+	}
+
+	{
+		std::fstream file(dir + "/rtm.snapshot",
+				  std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(-1, std::ios::end);
+		file.put('\xff');
+	}
+
+	routing_table restored;
+	rtm_store store(dir);
+	EXPECT_THROW(store.open(restored), std::runtime_error);
+}
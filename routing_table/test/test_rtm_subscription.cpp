@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Routing Table Manager (RTM) Subscriptions Unit-Tests
+ */
+
+#include <gtest/gtest.h>
+#include <rtm_subscription.hpp>
+#include <test_helpers.hpp>
+
+
+using namespace RTM;
+
+
+static subscription_filter make_filter(const std::string& str)
+{
+	subscription_filter filter;
+
+	EXPECT_TRUE(subscription_filter::from_string(str, filter)) << str;
+
+	return filter;
+}
+
+TEST(subscription_filter, from_string)
+{
+	subscription_filter filter;
+
+	EXPECT_TRUE(subscription_filter::from_string("10.1.0.0/16", filter));
+	EXPECT_EQ(filter.prefix[0], 10);
+	EXPECT_EQ(filter.prefix[1], 1);
+	EXPECT_EQ(filter.prefix_len, 16);
+	EXPECT_TRUE(filter.oif.empty());
+
+	EXPECT_TRUE(subscription_filter::from_string("10.1.0.0/16,eth0", filter));
+	EXPECT_EQ(filter.prefix_len, 16);
+	EXPECT_EQ(filter.oif, "eth0");
+
+	EXPECT_TRUE(subscription_filter::from_string(",eth1", filter));
+	EXPECT_EQ(filter.prefix_len, 0);
+	EXPECT_EQ(filter.oif, "eth1");
+
+	EXPECT_FALSE(subscription_filter::from_string("10.1.0.0", filter));
+	EXPECT_FALSE(subscription_filter::from_string("10.1.0.0/33", filter));
+	EXPECT_FALSE(subscription_filter::from_string("10.1.0/16", filter));
+	EXPECT_FALSE(subscription_filter::from_string("10.1.0.0/16,", filter));
+	EXPECT_FALSE(subscription_filter::from_string("", filter));
+}
+
+TEST(subscription_filter, matches)
+{
+	const auto filter = make_filter("10.1.0.0/16");
+
+	EXPECT_TRUE(filter.matches(make_entry("10.1.2.0", 24, "eth0")));
+	EXPECT_TRUE(filter.matches(make_entry("10.1.0.0", 16, "eth0")));
+	EXPECT_FALSE(filter.matches(make_entry("10.2.2.0", 24, "eth0")));
+	// The route is larger than the filter range:
+	EXPECT_FALSE(filter.matches(make_entry("10.0.0.0", 8, "eth0")));
+
+	const auto oif_filter = make_filter("10.1.0.0/16,eth1");
+	EXPECT_FALSE(oif_filter.matches(make_entry("10.1.2.0", 24, "eth0")));
+	EXPECT_TRUE(oif_filter.matches(make_entry("10.1.2.0", 24, "eth1")));
+
+	// Filter lists:
+	const std::vector<subscription_filter> filters = {filter, make_filter(",eth1")};
+	EXPECT_TRUE(subscription_filter::matches({}, make_entry("10.2.2.0", 24, "eth0")));
+	EXPECT_TRUE(subscription_filter::matches(filters, make_entry("10.1.2.0", 24, "eth0")));
+	EXPECT_TRUE(subscription_filter::matches(filters, make_entry("10.2.2.0", 24, "eth1")));
+	EXPECT_FALSE(subscription_filter::matches(filters, make_entry("10.2.2.0", 24, "eth0")));
+}
+
+TEST(subscription_filter, serialize_deserialize)
+{
+	const std::vector<subscription_filter> filters = {
+		make_filter("10.1.0.0/16"),
+		make_filter(",eth1"),
+		make_filter("192.168.0.0/24,foo_eth0"),
+	};
+	std::vector<subscription_filter> filters_deserialized;
+	std::vector<uint8_t> buffer;
+
+	const auto bytes_written = subscription_filter::serialize(filters, buffer);
+	EXPECT_EQ(bytes_written, buffer.size());
+
+	const auto bytes_read = subscription_filter::deserialize(buffer,
+								 filters_deserialized);
+	EXPECT_EQ(bytes_read, bytes_written);
+	EXPECT_EQ(filters, filters_deserialized);
+
+	// Truncated buffer:
+	buffer.pop_back();
+	EXPECT_EQ(subscription_filter::deserialize(buffer, filters_deserialized), 0);
+}
+
+TEST(subscription_index, match)
+{
+	subscription_index index;
+	std::vector<uint32_t> subscribers;
+
+	index.subscribe(1, {});
+	index.subscribe(2, {make_filter("10.0.0.0/8")});
+	index.subscribe(3, {make_filter("10.1.0.0/16"), make_filter(",eth1")});
+	index.subscribe(4, {make_filter("10.1.0.0/16,eth0")});
+	EXPECT_EQ(index.size(), 4);
+
+	index.match(make_entry("10.1.2.0", 24, "eth0"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 2, 3, 4}));
+
+	index.match(make_entry("10.1.2.0", 24, "eth1"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 2, 3}));
+
+	index.match(make_entry("10.2.2.0", 24, "eth0"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 2}));
+
+	index.match(make_entry("172.16.0.0", 12, "eth1"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 3}));
+
+	// The route is larger than the ranges of subscribers 2, 3 and 4:
+	index.match(make_entry("10.0.0.0", 7, "eth0"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1}));
+
+	index.unsubscribe(3);
+	index.match(make_entry("10.1.2.0", 24, "eth1"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 2}));
+	EXPECT_EQ(index.size(), 3);
+
+	// Replace filters:
+	index.subscribe(2, {make_filter(",eth1")});
+	index.match(make_entry("10.1.2.0", 24, "eth0"), subscribers);
+	EXPECT_EQ(subscribers, (std::vector<uint32_t>{1, 4}));
+}
+
+TEST(subscription_index, match_equals_filters)
+{
+	subscription_index index;
+	std::vector<uint32_t> subscribers;
+	std::vector<std::vector<subscription_filter>> filters;
+
+	// Subscriber i is interested in i.0.0.0/8 and in routes out of eth<i>
+	for (uint32_t i = 0; i < 64; ++i) {
+		filters.push_back({make_filter(std::to_string(i) + ".0.0.0/8"),
+				   make_filter(",eth" + std::to_string(i % 4))});
+		index.subscribe(i, filters.back());
+	}
+
+	for (uint32_t i = 0; i < 100'000; ++i) {
+		const auto entry = make_entry(make_key(i % 80, i >> 8, i, 0), 8 + i % 25,
+					      "eth" + std::to_string(i % 5));
+		index.match(entry, subscribers);
+
+		std::vector<uint32_t> expected;
+		for (uint32_t s = 0; s < filters.size(); ++s) {
+			if (index.matches(s, entry)) {
+				expected.push_back(s);
+			}
+		}
+		ASSERT_EQ(subscribers, expected) << "entry " << i;
+	}
+}
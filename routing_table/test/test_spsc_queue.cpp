@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2025 Alexander Kozhinov <ak.alexander.kozhinov@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ * @brief Lock-free SPSC Queue Unit-Tests
+ */
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <spsc_queue.hpp>
+
+
+using namespace RTM;
+
+
+TEST(spsc_queue, push_pop)
+{
+	spsc_queue<int, 4> queue;
+	int item = 0;
+
+	EXPECT_FALSE(queue.pop(item));
+
+	// Across several segments:
+	for (int i = 0; i < 10; ++i) {
+		queue.push(i);
+	}
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_TRUE(queue.pop(item));
+		EXPECT_EQ(item, i);
+	}
+	EXPECT_FALSE(queue.pop(item));
+
+	queue.push(42);
+	EXPECT_TRUE(queue.pop(item));
+	EXPECT_EQ(item, 42);
+}
+
+TEST(spsc_queue, releases_items)
+{
+	auto shared = std::make_shared<int>(1);
+	spsc_queue<std::shared_ptr<int>, 4> queue;
+	std::shared_ptr<int> item;
+
+	queue.push(shared);
+	queue.push(shared);
+	EXPECT_EQ(shared.use_count(), 3);
+
+	EXPECT_TRUE(queue.pop(item));
+	item.reset();
+	EXPECT_EQ(shared.use_count(), 2);
+}
+
+TEST(spsc_queue, threads)
+{
+	spsc_queue<uint64_t, 64> queue;
+	constexpr uint64_t NUM_ITEMS = 1000000;
+
+	std::thread producer([&]() {
+		for (uint64_t i = 0; i < NUM_ITEMS; ++i) {
+			queue.push(i);
+		}
+	});
+
+	uint64_t expected = 0;
+	uint64_t item;
+	while (expected < NUM_ITEMS) {
+		if (queue.pop(item)) {
+			ASSERT_EQ(item, expected);
+			expected++;
+		}
+	}
+	producer.join();
+	EXPECT_FALSE(queue.pop(item));
+}